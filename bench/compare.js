@@ -0,0 +1,51 @@
+const fs = require('fs');
+
+// Compare two JSON reports of bench/run.js index by index.
+// Usage: node bench/compare.js <baseline.json> <current.json>
+const METRICS = [
+  ['build s', (r) => r.build.totalMs / 1000, 'lower'],
+  ['QPS', (r) => r.search.qps, 'higher'],
+  ['async QPS', (r) => r.search.asyncQps, 'higher'],
+  ['p50 ms', (r) => r.latencyMs.searchInto.p50, 'lower'],
+  ['p99 ms', (r) => r.latencyMs.searchInto.p99, 'lower'],
+  ['marshal us/q', (r) => r.marshalling.arrayOverheadPerQueryUs, 'lower'],
+  ['recall', (r) => r.recall.atK, 'higher'],
+  ['MB', (r) => r.memory.serializedBytes / 1048576, 'lower'],
+];
+
+function format(value) {
+  return Math.abs(value) >= 100 ? value.toFixed(0) : value.toPrecision(3);
+}
+
+function main() {
+  const [baselineFile, currentFile] = process.argv.slice(2);
+  if (!baselineFile || !currentFile) {
+    console.error('Usage: node bench/compare.js <baseline.json> <current.json>');
+    process.exit(1);
+  }
+  const baseline = JSON.parse(fs.readFileSync(baselineFile, 'utf8'));
+  const current = JSON.parse(fs.readFileSync(currentFile, 'utf8'));
+  if (baseline.dataset.name !== current.dataset.name) {
+    console.error(`Warning: comparing different datasets (${baseline.dataset.name} vs ${current.dataset.name}).`);
+  }
+
+  const rows = [];
+  for (const result of current.results) {
+    const before = baseline.results.find((r) => r.index === result.index);
+    if (!before) {
+      continue;
+    }
+    const row = { index: result.index };
+    for (const [name, get, better] of METRICS) {
+      const a = get(before);
+      const b = get(result);
+      const change = a === 0 ? 0 : ((b - a) / a) * 100;
+      const regressed = better === 'higher' ? change < 0 : change > 0;
+      row[name] = `${format(b)} (${change >= 0 ? '+' : ''}${change.toFixed(1)}%${Math.abs(change) >= 5 && regressed ? ' !' : ''})`;
+    }
+    rows.push(row);
+  }
+  console.table(rows);
+}
+
+main();
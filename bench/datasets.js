@@ -0,0 +1,140 @@
+const fs = require('fs');
+const path = require('path');
+const { IndexFlatL2, IndexFlatIP } = require('..');
+
+// Small seedable PRNG (mulberry32), so every run benchmarks the same data.
+function createRandom(seed) {
+  let state = seed >>> 0;
+  return () => {
+    state = (state + 0x6D2B79F5) >>> 0;
+    let t = state;
+    t = Math.imul(t ^ (t >>> 15), t | 1);
+    t ^= t + Math.imul(t ^ (t >>> 7), t | 61);
+    return ((t ^ (t >>> 14)) >>> 0) / 4294967296;
+  };
+}
+
+function createGaussian(random) {
+  return () => {
+    const u = 1 - random();
+    const v = random();
+    return Math.sqrt(-2 * Math.log(u)) * Math.cos(2 * Math.PI * v);
+  };
+}
+
+// Gaussian mixture: uniform random cluster centers with unit-variance points around them, which
+// gives IVF and HNSW some structure to exploit unlike uniform noise.
+function generateVectors(n, d, { clusters, seed }) {
+  const random = createRandom(seed);
+  const gaussian = createGaussian(random);
+  const centers = new Float32Array(clusters * d);
+  for (let i = 0; i < centers.length; i++) {
+    centers[i] = random() * 20 - 10;
+  }
+
+  const x = new Float32Array(n * d);
+  for (let i = 0; i < n; i++) {
+    const c = Math.floor(random() * clusters);
+    for (let j = 0; j < d; j++) {
+      x[i * d + j] = centers[c * d + j] + gaussian();
+    }
+  }
+  return x;
+}
+
+function synthetic({ n, nq, d, clusters = 100, seed = 1234 }) {
+  // queries share the base centers but not the points
+  const all = generateVectors(n + nq, d, { clusters, seed });
+  return {
+    name: `synthetic-${n}x${d}`,
+    d,
+    base: all.subarray(0, n * d),
+    query: all.subarray(n * d),
+  };
+}
+
+// .fvecs/.ivecs (SIFT/GIST format): each vector is an int32 dimension followed by its components.
+function readVecs(file, ArrayType) {
+  const buf = fs.readFileSync(file);
+  const view = new DataView(buf.buffer, buf.byteOffset, buf.byteLength);
+  const d = view.getInt32(0, true);
+  const n = buf.byteLength / (4 * (d + 1));
+  if (!Number.isInteger(n)) {
+    throw new Error(`${file} is not a valid vecs file.`);
+  }
+
+  const words = buf.byteOffset % 4 === 0
+    ? new ArrayType(buf.buffer, buf.byteOffset, buf.byteLength / 4)
+    : new ArrayType(buf.buffer.slice(buf.byteOffset, buf.byteOffset + buf.byteLength));
+  const out = new ArrayType(n * d);
+  for (let i = 0; i < n; i++) {
+    out.set(words.subarray(i * (d + 1) + 1, (i + 1) * (d + 1)), i * d);
+  }
+  return { n, d, data: out };
+}
+
+function writeVecs(file, data, d) {
+  const n = data.length / d;
+  const buf = Buffer.alloc(n * (d + 1) * 4);
+  for (let i = 0; i < n; i++) {
+    const offset = i * (d + 1) * 4;
+    buf.writeInt32LE(d, offset);
+    Buffer.from(data.buffer, data.byteOffset + i * d * 4, d * 4).copy(buf, offset + 4);
+  }
+  fs.writeFileSync(file, buf);
+}
+
+function readFvecs(file) {
+  return readVecs(file, Float32Array);
+}
+
+function readIvecs(file) {
+  return readVecs(file, Int32Array);
+}
+
+// Reads `<dir>/<name>_base.fvecs`, `_query.fvecs` and, when present, `_groundtruth.ivecs`,
+// the layout of the SIFT1M/GIST1M downloads.
+function fromDirectory(dir, name) {
+  const prefix = path.join(dir, name);
+  const base = readFvecs(`${prefix}_base.fvecs`);
+  const query = readFvecs(`${prefix}_query.fvecs`);
+  if (base.d !== query.d) {
+    throw new Error(`Base and query dimensions differ (${base.d} != ${query.d}).`);
+  }
+
+  const dataset = { name, d: base.d, base: base.data, query: query.data };
+  if (fs.existsSync(`${prefix}_groundtruth.ivecs`)) {
+    const gt = readIvecs(`${prefix}_groundtruth.ivecs`);
+    dataset.groundTruth = { k: gt.d, labels: BigInt64Array.from(gt.data, BigInt) };
+  }
+  return dataset;
+}
+
+function toDirectory(dataset, dir) {
+  fs.mkdirSync(dir, { recursive: true });
+  const prefix = path.join(dir, dataset.name);
+  writeVecs(`${prefix}_base.fvecs`, dataset.base, dataset.d);
+  writeVecs(`${prefix}_query.fvecs`, dataset.query, dataset.d);
+  if (dataset.groundTruth) {
+    writeVecs(`${prefix}_groundtruth.ivecs`, Int32Array.from(dataset.groundTruth.labels, Number), dataset.groundTruth.k);
+  }
+}
+
+// Exact k nearest neighbors of every query with a flat index of the benchmarked metric.
+function computeGroundTruth(dataset, k, metric = 'l2') {
+  const index = metric === 'ip' ? new IndexFlatIP(dataset.d) : new IndexFlatL2(dataset.d);
+  index.add(dataset.base);
+  const { labels } = index.searchTyped(dataset.query, k);
+  index.dispose();
+  return { k, labels };
+}
+
+module.exports = {
+  synthetic,
+  readFvecs,
+  readIvecs,
+  writeVecs,
+  fromDirectory,
+  toDirectory,
+  computeGroundTruth,
+};
@@ -0,0 +1,100 @@
+function now() {
+  return process.hrtime.bigint();
+}
+
+function elapsedMs(start) {
+  return Number(process.hrtime.bigint() - start) / 1e6;
+}
+
+// Time fn over `runs` repetitions after `warmup` untimed ones; returns each run's duration in ms.
+function timeRuns(fn, { runs = 5, warmup = 1 } = {}) {
+  for (let i = 0; i < warmup; i++) {
+    fn();
+  }
+  const times = [];
+  for (let i = 0; i < runs; i++) {
+    const start = now();
+    fn();
+    times.push(elapsedMs(start));
+  }
+  return times;
+}
+
+function percentile(sorted, p) {
+  if (sorted.length === 0) {
+    return 0;
+  }
+  const rank = Math.min(sorted.length - 1, Math.max(0, Math.ceil((p / 100) * sorted.length) - 1));
+  return sorted[rank];
+}
+
+function summarize(values) {
+  const sorted = Float64Array.from(values).sort();
+  const sum = sorted.reduce((a, b) => a + b, 0);
+  return {
+    count: sorted.length,
+    mean: sorted.length ? sum / sorted.length : 0,
+    min: sorted.length ? sorted[0] : 0,
+    p50: percentile(sorted, 50),
+    p95: percentile(sorted, 95),
+    p99: percentile(sorted, 99),
+    max: sorted.length ? sorted[sorted.length - 1] : 0,
+  };
+}
+
+function median(values) {
+  return summarize(values).p50;
+}
+
+// recall@k: fraction of the true k nearest neighbors found among the k results of each query.
+// Ground truth rows may hold more than k neighbors (e.g. 100 in SIFT1M), only the first k count.
+function recallAtK(labels, groundTruth, nq, k) {
+  let found = 0;
+  for (let i = 0; i < nq; i++) {
+    const expected = new Set();
+    for (let j = 0; j < k; j++) {
+      expected.add(groundTruth.labels[i * groundTruth.k + j]);
+    }
+    for (let j = 0; j < k; j++) {
+      if (expected.has(labels[i * k + j])) {
+        found++;
+      }
+    }
+  }
+  return found / (nq * k);
+}
+
+// 1-recall@k: fraction of queries whose true nearest neighbor is among the k results.
+function nearestRecallAtK(labels, groundTruth, nq, k) {
+  let found = 0;
+  for (let i = 0; i < nq; i++) {
+    const nearest = groundTruth.labels[i * groundTruth.k];
+    for (let j = 0; j < k; j++) {
+      if (labels[i * k + j] === nearest) {
+        found++;
+        break;
+      }
+    }
+  }
+  return found / nq;
+}
+
+function memorySnapshot() {
+  if (global.gc) {
+    global.gc();
+  }
+  const { rss, heapUsed, external, arrayBuffers } = process.memoryUsage();
+  return { rss, heapUsed, external, arrayBuffers };
+}
+
+module.exports = {
+  now,
+  elapsedMs,
+  timeRuns,
+  percentile,
+  summarize,
+  median,
+  recallAtK,
+  nearestRecallAtK,
+  memorySnapshot,
+};
@@ -0,0 +1,334 @@
+const fs = require('fs');
+const os = require('os');
+const {
+  Index, IndexFlatL2, IndexFlatIP, IndexHNSW, IndexIVFFlat, MetricType, setNumThreads, getNumThreads,
+} = require('..');
+const datasets = require('./datasets');
+const {
+  now, elapsedMs, timeRuns, summarize, median, recallAtK, nearestRecallAtK, memorySnapshot,
+} = require('./metrics');
+const { version } = require('../package.json');
+
+const USAGE = `Usage: node --expose-gc bench/run.js [options]
+
+Dataset (synthetic gaussian clusters unless --dataset is given):
+  --n <count>              base vectors (default 100000)
+  --nq <count>             query vectors (default 1000)
+  --d <dims>               dimension (default 128)
+  --clusters <count>       synthetic clusters (default 100)
+  --seed <number>          synthetic seed (default 1234)
+  --dataset <name>         read <data-dir>/<name>_{base,query}.fvecs and _groundtruth.ivecs (e.g. sift)
+  --data-dir <dir>         directory of fvecs datasets (default bench/data)
+  --write-dataset <dir>    save the dataset and its ground truth as fvecs/ivecs and exit
+  --metric <l2|ip>         metric of the indexes and ground truth (default l2)
+
+Indexes (repeatable, default IndexFlatL2/IP, IndexHNSW, IndexIVFFlat, factory:IVF{nlist},SQ8):
+  --index <name>           IndexFlatL2, IndexFlatIP, IndexHNSW, IndexIVFFlat or factory:<description>,
+                           where {nlist} in a description is replaced by --nlist
+  --nlist <count>          IVF lists (default 4 * sqrt(n))
+  --nprobe <count>         IVF lists probed per query (default 16)
+  --m <count>              HNSW neighbors per node (default 32)
+  --ef-search <count>      HNSW search depth (default 64)
+
+Search:
+  --k <count>              neighbors per query (default 10)
+  --runs <count>           timed repetitions of each batch search (default 5)
+  --latency-queries <n>    single queries timed for latency percentiles (default 1000)
+  --concurrency <n>        concurrent searchAsync calls (default 16)
+  --batching               enable searchAsync micro-batching
+  --threads <count>        OpenMP threads (default OpenMP default)
+
+Output:
+  --out <file>             write results as JSON, see bench/compare.js
+`;
+
+function parseArgs(argv) {
+  const args = {
+    n: 100000,
+    nq: 1000,
+    d: 128,
+    clusters: 100,
+    seed: 1234,
+    dataset: null,
+    dataDir: 'bench/data',
+    writeDataset: null,
+    metric: 'l2',
+    index: [],
+    nlist: 0,
+    nprobe: 16,
+    m: 32,
+    efSearch: 64,
+    k: 10,
+    runs: 5,
+    latencyQueries: 1000,
+    concurrency: 16,
+    batching: false,
+    threads: 0,
+    out: null,
+  };
+
+  for (let i = 0; i < argv.length; i++) {
+    let [key, value] = argv[i].replace(/^--/, '').split('=');
+    if (key === 'help') {
+      console.log(USAGE);
+      process.exit(0);
+    }
+    key = key.replace(/-([a-z])/g, (_, c) => c.toUpperCase());
+    if (!(key in args)) {
+      throw new Error(`Unknown option ${argv[i]}.\n\n${USAGE}`);
+    }
+    if (typeof args[key] === 'boolean') {
+      args[key] = true;
+      continue;
+    }
+    if (value === undefined) {
+      value = argv[++i];
+    }
+    if (Array.isArray(args[key])) {
+      args[key].push(value);
+    } else {
+      args[key] = typeof args[key] === 'number' ? Number(value) : value;
+    }
+  }
+
+  return args;
+}
+
+function loadDataset(args) {
+  const dataset = args.dataset
+    ? datasets.fromDirectory(args.dataDir, args.dataset)
+    : datasets.synthetic(args);
+  if (!dataset.groundTruth || dataset.groundTruth.k < args.k) {
+    dataset.groundTruth = datasets.computeGroundTruth(dataset, args.k, args.metric);
+  }
+  return dataset;
+}
+
+function indexConfig(name, args, d, n) {
+  const nlist = args.nlist || Math.max(1, Math.round(4 * Math.sqrt(n)));
+  const ip = args.metric === 'ip';
+  const metric = ip ? MetricType.METRIC_INNER_PRODUCT : MetricType.METRIC_L2;
+  // options that don't apply to an index type are ignored by search
+  const searchOptions = { nprobe: args.nprobe, efSearch: args.efSearch };
+
+  if (name.startsWith('factory:')) {
+    const description = name.slice('factory:'.length).replace('{nlist}', nlist);
+    return { name: `factory:${description}`, create: () => ({ index: Index.fromFactory(d, description, metric) }), searchOptions };
+  }
+  switch (name) {
+    case 'IndexFlatL2':
+      return { name, create: () => ({ index: new IndexFlatL2(d) }) };
+    case 'IndexFlatIP':
+      return { name, create: () => ({ index: new IndexFlatIP(d) }) };
+    case 'IndexHNSW':
+      return { name, create: () => ({ index: new IndexHNSW(d, args.m, metric) }), searchOptions };
+    case 'IndexIVFFlat':
+      return {
+        name,
+        create: () => {
+          // the IVF index uses the quantizer in place, keep it referenced for as long as the index
+          const quantizer = ip ? new IndexFlatIP(d) : new IndexFlatL2(d);
+          return { index: new IndexIVFFlat(quantizer, d, nlist, metric), quantizer };
+        },
+        searchOptions,
+      };
+    default:
+      throw new Error(`Unknown index ${name}.`);
+  }
+}
+
+async function measureAsync(index, query, d, k, options, { concurrency, count }) {
+  const nq = query.length / d;
+  const latencies = [];
+  let next = 0;
+  const worker = async () => {
+    while (next < count) {
+      const i = next++ % nq;
+      const start = now();
+      await index.searchAsync(query.subarray(i * d, (i + 1) * d), k, options);
+      latencies.push(elapsedMs(start));
+    }
+  };
+
+  const start = now();
+  await Promise.all(Array.from({ length: concurrency }, worker));
+  return { qps: count / (elapsedMs(start) / 1000), latencyMs: summarize(latencies) };
+}
+
+async function benchmark(config, dataset, args) {
+  const { d, base, query, groundTruth } = dataset;
+  const n = base.length / d;
+  const nq = query.length / d;
+  const k = args.k;
+  const options = config.searchOptions;
+
+  const memoryBefore = memorySnapshot();
+  let start = now();
+  const { index, quantizer } = config.create();
+  let trainMs = 0;
+  if (!index.isTrained) {
+    const trainN = Math.min(n, 100000);
+    index.train(base.subarray(0, trainN * d));
+    trainMs = elapsedMs(start);
+  }
+  start = now();
+  index.add(base);
+  const addMs = elapsedMs(start);
+  const memoryAfter = memorySnapshot();
+  const serializedBytes = index.toBuffer().length;
+
+  // batch throughput through the leanest path: typed input, results written in place
+  const distances = new Float32Array(nq * k);
+  const labels = new BigInt64Array(nq * k);
+  const nativeTimes = timeRuns(() => index.searchInto(query, k, distances, labels, options), { runs: args.runs });
+  const recall = recallAtK(labels, groundTruth, nq, k);
+  const nearestRecall = nearestRecallAtK(labels, groundTruth, nq, k);
+
+  // same batch with typed array results, then with plain JS arrays in and out
+  const typedTimes = timeRuns(() => index.searchTyped(query, k, options), { runs: args.runs });
+  const queryArray = Array.from(query);
+  const arrayTimes = timeRuns(() => index.search(queryArray, k, options), { runs: args.runs });
+  const nativeMs = median(nativeTimes);
+  const typedMs = median(typedTimes);
+  const arrayMs = median(arrayTimes);
+
+  // single query latencies
+  const latencyQueries = Math.min(args.latencyQueries, nq);
+  const intoLatencies = [];
+  const arrayLatencies = [];
+  const D1 = new Float32Array(k);
+  const I1 = new BigInt64Array(k);
+  for (let i = 0; i < latencyQueries; i++) {
+    const q = query.subarray(i * d, (i + 1) * d);
+    let t = now();
+    index.searchInto(q, k, D1, I1, options);
+    intoLatencies.push(elapsedMs(t));
+    const qArray = queryArray.slice(i * d, (i + 1) * d);
+    t = now();
+    index.search(qArray, k, options);
+    arrayLatencies.push(elapsedMs(t));
+  }
+
+  if (args.batching) {
+    index.setBatching({ maxBatch: 64, maxWaitMicros: 500 });
+  }
+  // batching only coalesces calls without per-call options
+  const asyncOptions = args.batching ? undefined : options;
+  const asyncResult = await measureAsync(index, query, d, k, asyncOptions, { concurrency: args.concurrency, count: latencyQueries });
+
+  const result = {
+    index: config.name,
+    ntotal: index.ntotal,
+    build: {
+      trainMs,
+      addMs,
+      totalMs: trainMs + addMs,
+      addVectorsPerSecond: n / (addMs / 1000),
+    },
+    memory: {
+      rssBytes: memoryAfter.rss - memoryBefore.rss,
+      serializedBytes,
+    },
+    search: {
+      k,
+      nq,
+      qps: nq / (nativeMs / 1000),
+      batchMs: summarize(nativeTimes),
+      asyncQps: asyncResult.qps,
+      asyncConcurrency: args.concurrency,
+      asyncBatching: args.batching,
+    },
+    latencyMs: {
+      searchInto: summarize(intoLatencies),
+      search: summarize(arrayLatencies),
+      searchAsync: asyncResult.latencyMs,
+    },
+    // searchInto is the binding's minimal path, close to native faiss time; the other variants add
+    // the cost of converting inputs and results between JS and native memory
+    marshalling: {
+      nativeMs,
+      typedMs,
+      arrayMs,
+      typedOverheadMs: typedMs - nativeMs,
+      arrayOverheadMs: arrayMs - nativeMs,
+      arrayOverheadPerQueryUs: ((arrayMs - nativeMs) * 1000) / nq,
+    },
+    recall: {
+      atK: recall,
+      nearestAtK: nearestRecall,
+    },
+  };
+
+  index.dispose();
+  if (quantizer) {
+    quantizer.dispose();
+  }
+  return result;
+}
+
+function printResults(results) {
+  console.table(results.map((r) => ({
+    index: r.index,
+    'build s': +(r.build.totalMs / 1000).toFixed(2),
+    'MB': +(r.memory.serializedBytes / 1048576).toFixed(1),
+    'QPS': Math.round(r.search.qps),
+    'async QPS': Math.round(r.search.asyncQps),
+    'p50 ms': +r.latencyMs.searchInto.p50.toFixed(3),
+    'p95 ms': +r.latencyMs.searchInto.p95.toFixed(3),
+    'p99 ms': +r.latencyMs.searchInto.p99.toFixed(3),
+    'marshal us/q': +r.marshalling.arrayOverheadPerQueryUs.toFixed(1),
+    [`recall@${r.search.k}`]: +r.recall.atK.toFixed(4),
+  })));
+}
+
+async function main() {
+  const args = parseArgs(process.argv.slice(2));
+  if (args.threads > 0) {
+    setNumThreads(args.threads);
+  }
+
+  const dataset = loadDataset(args);
+  if (args.writeDataset) {
+    datasets.toDirectory(dataset, args.writeDataset);
+    console.log(`Wrote ${dataset.name} to ${args.writeDataset}`);
+    return;
+  }
+
+  const n = dataset.base.length / dataset.d;
+  const names = args.index.length ? args.index : [
+    args.metric === 'ip' ? 'IndexFlatIP' : 'IndexFlatL2',
+    'IndexHNSW',
+    'IndexIVFFlat',
+    'factory:IVF{nlist},SQ8',
+  ];
+
+  const results = [];
+  for (const name of names) {
+    const config = indexConfig(name, args, dataset.d, n);
+    console.error(`Benchmarking ${config.name} on ${dataset.name}...`);
+    results.push(await benchmark(config, dataset, args));
+  }
+  printResults(results);
+
+  if (args.out) {
+    const report = {
+      version,
+      date: new Date().toISOString(),
+      node: process.version,
+      platform: `${os.platform()}-${os.arch()}`,
+      cpus: os.cpus().length,
+      cpuModel: os.cpus()[0] && os.cpus()[0].model,
+      threads: getNumThreads(),
+      args,
+      dataset: { name: dataset.name, n, nq: dataset.query.length / dataset.d, d: dataset.d },
+      results,
+    };
+    fs.writeFileSync(args.out, JSON.stringify(report, null, 2));
+    console.error(`Wrote ${args.out}`);
+  }
+}
+
+main().catch((err) => {
+  console.error(err.message);
+  process.exit(1);
+});
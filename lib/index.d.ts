@@ -3,9 +3,304 @@ export interface SearchResult {
     /** The disances of the nearest negihbors found, size n*k. */
     distances: number[],
     /** The labels of the nearest neighbors found, size n*k. */
-    labels: BigInt[]
+    labels: BigInt[],
+    /** Work done by the search, with the `withStats` option. */
+    stats?: SearchStats
 }
 
+/** Search result object backed by typed arrays. */
+export interface TypedSearchResult {
+    /** The distances of the nearest neighbors found, size n*k. */
+    distances: Float32Array,
+    /** The labels of the nearest neighbors found, size n*k. */
+    labels: BigInt64Array,
+    /** Work done by the search, with the `withStats` option. */
+    stats?: SearchStats
+}
+
+/** Counters of faiss IVF searches, see faiss::IndexIVFStats. */
+export interface IVFSearchStats {
+    /** Number of queries. */
+    nq: number,
+    /** Number of inverted lists visited. */
+    nlist: number,
+    /** Number of distances computed. */
+    ndis: number,
+    /** Number of result heap updates. */
+    nheapUpdates: number,
+    /** Time spent assigning queries to lists, in milliseconds. */
+    quantizationTime: number,
+    /** Time spent scanning inverted lists, excluding quantizationTime, in milliseconds. */
+    searchTime: number
+}
+
+/** Counters of faiss HNSW searches, see faiss::HNSWStats. */
+export interface HNSWSearchStats {
+    /** faiss internal counters of the graph walk. */
+    n1: number,
+    n2: number,
+    n3: number,
+    /** Number of distances computed. */
+    ndis: number,
+    /** Number of results reordered. */
+    nreorder: number
+}
+
+/**
+ * Work done by one search. IVF and HNSW counters are present for indexes of
+ * that kind, including ones wrapped in an IDMap.
+ */
+export interface SearchStats {
+    /** Native search time, in milliseconds. */
+    timeMs: number,
+    ivf?: IVFSearchStats,
+    hnsw?: HNSWSearchStats
+}
+
+/** Range search result object backed by typed arrays. */
+export interface RangeSearchResult {
+    /**
+     * Offsets of the results of each query, size n+1: the results of query i are
+     * at positions lims[i] (inclusive) to lims[i+1] (exclusive).
+     */
+    lims: BigUint64Array,
+    /** The distances of the neighbors found within the radius. */
+    distances: Float32Array,
+    /** The labels of the neighbors found within the radius. */
+    labels: BigInt64Array
+}
+
+/**
+ * Restricts a search to a subset of ids: an allow-list of ids, an id range
+ * (`max` excluded), or a bitmap where bit (id % 8) of byte (id / 8) is set for
+ * the ids to keep. Excluded ids are skipped during the search itself.
+ */
+export type SearchFilter = IdArray | Uint8Array | { min: number, max: number };
+
+/**
+ * Per-call search options. Unlike setting `nprobe` or `efSearch` on the index,
+ * they don't affect concurrent searches. Options that don't apply to the index
+ * type are ignored, except `filter`.
+ */
+export interface SearchOptions {
+    /**
+     * Only return results among these ids. Supported by IVF (but not fast-scan),
+     * HNSW and flat indexes, possibly wrapped by `toIDMap2`; searches of other
+     * indexes with a filter throw.
+     */
+    filter?: SearchFilter,
+    /** IVF: number of inverted lists to probe, instead of the index `nprobe`. */
+    nprobe?: number,
+    /** IVF: maximum number of codes to visit per query, 0 for no limit. */
+    maxCodes?: number,
+    /** HNSW: size of the dynamic candidate list, instead of the index `efSearch`. */
+    efSearch?: number,
+    /** HNSW: stop the search when candidates get too far from the query (default true). */
+    checkRelativeDistance?: boolean,
+    /** Maximum number of OpenMP threads used by this search (default `getNumThreads()`). */
+    threads?: number,
+    /**
+     * Return the work done by this search in the `stats` field of the result
+     * (search, searchTyped and searchAsync). Counters of IVF indexes that aren't
+     * wrapped are collected for the call alone; others are read from faiss'
+     * global counters and include any search running concurrently, on this index
+     * or any other.
+     */
+    withStats?: boolean
+}
+
+/** Options of the async add and train methods. */
+export interface AsyncOptions {
+    /** Maximum number of OpenMP threads used by this call (default `getNumThreads()`). */
+    threads?: number
+}
+
+/** Micro-batching options for `searchAsync`, see `Index.setBatching`. */
+export interface BatchingOptions {
+    /** Maximum number of query vectors combined into one search (default 64, <= 1 disables batching). */
+    maxBatch?: number,
+    /** Maximum time the first queued query waits for others to join its batch (default 1000). */
+    maxWaitMicros?: number
+}
+
+/** Counters of the `searchAsync` micro-batching scheduler. */
+export interface BatchingStats {
+    /** Whether batching is enabled. */
+    enabled: boolean,
+    maxBatch?: number,
+    maxWaitMicros?: number,
+    /** Number of faiss searches issued. */
+    batches?: number,
+    /** Number of `searchAsync` calls served. */
+    queries?: number,
+    /** Number of query vectors searched. */
+    vectors?: number,
+    /** Largest number of query vectors searched at once. */
+    maxBatchSize?: number,
+    /** Average number of query vectors per faiss search. */
+    averageBatchSize?: number
+}
+
+/**
+ * Latency histogram with log-linear buckets, four per power of two
+ * microseconds. Percentiles are the upper bound of the bucket they fall in.
+ */
+export interface LatencyHistogram {
+    count: number,
+    sumMs: number,
+    p50: number,
+    p90: number,
+    p99: number,
+    /** Number of calls per bucket, see `IndexMetrics.bucketBoundsMs`. */
+    buckets: Float64Array
+}
+
+/** Counters and latencies of one kind of operation, sync and async calls alike. */
+export interface OperationMetrics {
+    /** Number of calls that reached faiss. */
+    calls: number,
+    /** Number of vectors searched, added or trained on by successful calls. */
+    vectors: number,
+    /** Number of calls that failed in faiss. */
+    errors: number,
+    /** Time spent in faiss. */
+    native: LatencyHistogram,
+    /**
+     * Time spent converting arguments and results on the JS thread. Waiting for
+     * the index lock or a worker thread counts in neither histogram.
+     */
+    marshalling: LatencyHistogram
+}
+
+/** Metrics of an index since its creation, see `getMetrics`. */
+export interface IndexMetrics {
+    /** search, searchTyped, searchInto, rangeSearch and searchAsync calls. */
+    search: OperationMetrics,
+    /** add, addWithIds and their async variants. */
+    add: OperationMetrics,
+    /** train and trainAsync. */
+    train: OperationMetrics,
+    /** Exclusive upper bound of each histogram bucket, in milliseconds. */
+    bucketBoundsMs: Float64Array
+}
+
+/** Options for `Index.read`. */
+export interface ReadOptions {
+    /**
+     * Memory-map the inverted lists of IVF indexes instead of reading them into RAM,
+     * so they are paged in lazily and shared through the page cache between processes.
+     */
+    mmap?: boolean,
+    /** Open on-disk inverted lists read-only. */
+    readOnly?: boolean,
+    /** Resolve on-disk inverted list data files relative to the index file's directory. */
+    onDiskSameDir?: boolean
+}
+
+/** Options for `Index.writeStream`. */
+export interface WriteStreamOptions {
+    /** Size of the chunks written to the stream in bytes (default 1 MiB). */
+    chunkSize?: number
+}
+
+/** Options for `Index.readStream`. */
+export interface ReadStreamOptions {
+    /** Pause the stream while more than this many bytes are queued for deserialization (default 8 MiB). */
+    highWaterMark?: number
+}
+
+/** Amount of memory-mapped inverted list data paged in by `Index.warmup`. */
+export interface WarmupProgress {
+    /** Number of inverted lists touched. */
+    lists: number,
+    /** Number of bytes of codes and ids touched. */
+    bytes: number
+}
+
+/** Options for `Index.warmup`. */
+export interface WarmupOptions {
+    /** Maximum number of inverted lists to touch, largest lists first (default all). */
+    maxLists?: number,
+    /** Stop after touching this many bytes (default no limit). Both limits must be non-negative. */
+    maxBytes?: number,
+    /** Called on the JS thread as lists are paged in. */
+    onProgress?: (progress: WarmupProgress) => void
+}
+
+/** Progress of `IndexIVFFlat.mergeOnDiskAsync`. */
+export interface MergeOnDiskProgress {
+    /** Number of inverted lists copied so far. */
+    lists: number,
+    /** Number of inverted lists of the output. */
+    totalLists: number,
+    /** Number of entries copied so far. */
+    entries: number
+}
+
+/** Result of `IndexIVFFlat.mergeOnDiskAsync`. */
+export interface MergeOnDiskResult extends MergeOnDiskProgress {
+    /** Total number of vectors of the output index. */
+    ntotal: number
+}
+
+/** Options for `IndexIVFFlat.mergeOnDiskAsync`. */
+export interface MergeOnDiskOptions {
+    /**
+     * Append the inputs to the existing output index and its data file instead of rewriting them.
+     * Lists without new entries are left untouched (default false).
+     */
+    append?: boolean,
+    /** OpenMP threads copying inverted lists in parallel (default setNumThreads). */
+    threads?: number,
+    /** Called on the JS thread as inverted lists are copied. */
+    onProgress?: (progress: MergeOnDiskProgress) => void
+}
+
+/**
+ * Flat matrix of vectors, size n * d. Float32Array, Buffer and ArrayBuffer
+ * memory is passed to synchronous calls as-is without copying; plain arrays are
+ * converted. Async calls copy typed inputs, which may then be reused or transferred
+ * right away. A Buffer must start at a multiple of 4 bytes of its ArrayBuffer.
+ */
+export type VectorArray = number[] | Float32Array | Buffer | ArrayBuffer;
+
+/** Vector identifiers; BigInt64Array memory is passed to synchronous calls without copying. */
+export type IdArray = (number|BigInt)[] | BigInt64Array;
+
+/**
+ * Flat matrix of packed binary vectors, n * d / 8 bytes. Uint8Array and Buffer
+ * memory is passed to faiss as-is; plain arrays of bytes are converted, and
+ * throw if an element isn't an integer in 0-255.
+ */
+export type BinaryVectorArray = number[] | Uint8Array;
+
+/** Results of a binary index search, nq * k entries each, -1 labels for missing results. */
+export interface BinarySearchResult {
+    /** Hamming distances. */
+    distances: Int32Array,
+    labels: BigInt64Array
+}
+
+/**
+ * Set the maximum number of OpenMP threads used by faiss calls in this process,
+ * on the main thread and on worker threads alike.
+ * @param {number} n Number of threads, 0 to restore the OpenMP default.
+ */
+export function setNumThreads(n: number): void;
+/**
+ * @return {number} The maximum number of OpenMP threads used by faiss calls.
+ */
+export function getNumThreads(): number;
+/**
+ * @return Counters of all IVF and HNSW searches in this process since the
+ * last `resetSearchStats()`.
+ */
+export function getSearchStats(): { ivf: IVFSearchStats, hnsw: HNSWSearchStats };
+/**
+ * Reset the counters returned by `getSearchStats()`.
+ */
+export function resetSearchStats(): void;
+
 // See faiss/MetricType.h
 export enum MetricType {
     METRIC_INNER_PRODUCT = 0, ///< maximum inner product search
@@ -29,18 +324,49 @@ export enum IndexType {
   IndexFlatL2 = 11,
   IndexFlatIP = 12,
   IndexHNSW = 20,
+  IndexHNSWSQ = 21,
+  IndexHNSWPQ = 22,
   IndexIVF = 30,
   IndexIVFFlat = 31,
+  IndexIVFPQ = 32,
+  IndexIVFScalarQuantizer = 33,
+  IndexIVFPQFastScan = 34,
+  IndexPQ = 40,
+  IndexPQFastScan = 41,
+  IndexRefine = 50,
+  IndexShards = 70,
+  IndexReplicas = 71,
+  IndexBinary = 60,
+  IndexBinaryFlat = 61,
+  IndexBinaryHNSW = 62,
+  IndexBinaryIVF = 63,
+}
+
+// See faiss/impl/ScalarQuantizer.h
+export enum QuantizerType {
+    QT_8bit = 0,         ///< 8 bits per component
+    QT_4bit = 1,         ///< 4 bits per component
+    QT_8bit_uniform = 2, ///< same, shared range for all dimensions
+    QT_4bit_uniform = 3,
+    QT_fp16 = 4,
+    QT_8bit_direct = 5,  ///< fast indexing of uint8s
+    QT_6bit = 6,         ///< 6 bits per component
 }
 
 /**
  * Index.
  * Index that stores the full vectors and performs exhaustive search.
+ * The synchronous methods run on the JS thread: while an async add, train,
+ * merge or write holds the index (or a shard, replica or quantizer of it), they
+ * wait for it to finish and block the event loop meanwhile.
  * @param {number} d The dimensionality of index.
  */
 export class Index {
     constructor(d: number);
     /**
+     * The most specific type of the faiss index, e.g. IndexIVFPQ for an index read
+     * with `fromBuffer`. Flat indexes report IndexFlatL2 or IndexFlatIP by metric;
+     * other subclasses report their family (IndexFlat, IndexHNSW, IndexIVF), or Index.
      * @return {IndexType} The type of index.
      */
     get indexType(): IndexType;
@@ -68,37 +394,150 @@ export class Index {
     /** 
      * Add n vectors of dimension d to the index.
      * Vectors are implicitly assigned labels ntotal .. ntotal + n - 1
-     * @param {number[]} x Input matrix, size n * d
+     * Blocks the event loop until running async work on the index completes.
+     * @param {VectorArray} x Input matrix, size n * d
      */
-    add(x: number[]): void;
+    add(x: VectorArray): void;
+    /** 
+     * Add n vectors of dimension d to the index on a worker thread.
+     * @param {VectorArray} x Input matrix, size n * d
+     * @param {AsyncOptions} options Per-call options.
+     * @return {Promise<void>} Resolves once the vectors have been added.
+     */
+    addAsync(x: VectorArray, options?: AsyncOptions): Promise<void>;
     /** 
      * Add n vectors of dimension d to the index using the provided labels.
-     * @param {number[]} x Input matrix, size n * d
-     * @param {(number|BigInt)[]} y Vector identifiers
+     * Blocks the event loop until running async work on the index completes.
+     * @param {VectorArray} x Input matrix, size n * d
+     * @param {IdArray} y Vector identifiers
      */
-    addWithIds(x: number[], y: (number|BigInt)[]): void;
+    addWithIds(x: VectorArray, y: IdArray): void;
     /** 
      * Add n vectors of dimension d to the index with ID's.
-     * @param {number[]} x Input matrix, size n * d
+     * Blocks the event loop until running async work on the index completes.
+     * @param {VectorArray} x Input matrix, size n * d
      * @param {BigInt[]} ids Vector identifiers
      */
-    addWithIds(x: number[], ids: BigInt[]): void;
+    addWithIds(x: VectorArray, ids: BigInt[]): void;
+    /** 
+     * Add n vectors of dimension d to the index using the provided labels, on a worker thread.
+     * @param {VectorArray} x Input matrix, size n * d
+     * @param {IdArray} ids Vector identifiers
+     * @param {AsyncOptions} options Per-call options.
+     * @return {Promise<void>} Resolves once the vectors have been added.
+     */
+    addWithIdsAsync(x: VectorArray, ids: IdArray, options?: AsyncOptions): Promise<void>;
     /** 
      * Train n vectors of dimension d to the index.
      * Vectors are implicitly assigned labels ntotal .. ntotal + n - 1
-     * @param {number[]} x Input matrix, size n * d
+     * Blocks the event loop until running async work on the index completes.
+     * @param {VectorArray} x Input matrix, size n * d
      */
-    train(x: number[]): void;
+    train(x: VectorArray): void;
+    /** 
+     * Train n vectors of dimension d to the index on a worker thread.
+     * @param {VectorArray} x Input matrix, size n * d
+     * @param {AsyncOptions} options Per-call options.
+     * @return {Promise<void>} Resolves once training completes.
+     */
+    trainAsync(x: VectorArray, options?: AsyncOptions): Promise<void>;
     /** 
      * Query n vectors of dimension d to the index.
      * return at most k vectors. If there are not enough results for a
      * query, the result array is padded with -1s.
+     * Runs concurrently with `searchAsync` calls, but blocks the event loop
+     * while an async add, train or merge holds the index.
      *
-     * @param {number[]} x Input vectors to search, size n * d.
+     * @param {VectorArray} x Input vectors to search, size n * d.
      * @param {number} k The number of nearest neighbors to search for.
+     * @param {SearchOptions} options Per-call search options.
      * @return {SearchResult} Output of the search result.
      */
-    search(x: number[], k: number): SearchResult;
+    search(x: VectorArray, k: number, options?: SearchOptions): SearchResult;
+    /** 
+     * Same as `search`, but results are returned as typed arrays backed by the
+     * native result buffers, avoiding one JS object per result.
+     *
+     * @param {VectorArray} x Input vectors to search, size n * d.
+     * @param {number} k The number of nearest neighbors to search for.
+     * @param {SearchOptions} options Per-call search options.
+     * @return {TypedSearchResult} Output of the search result.
+     */
+    searchTyped(x: VectorArray, k?: number, options?: SearchOptions): TypedSearchResult;
+    /** 
+     * Same as `search`, but faiss writes results directly into the given arrays
+     * so that repeated searches allocate nothing.
+     *
+     * @param {VectorArray} x Input vectors to search, size n * d.
+     * @param {number} k The number of nearest neighbors to search for.
+     * @param {Float32Array} distances Output distances, at least n * k long.
+     * @param {BigInt64Array} labels Output labels, at least n * k long.
+     * @param {SearchOptions} options Per-call search options.
+     * @return {number} The number of results written, n * k.
+     */
+    searchInto(x: VectorArray, k: number, distances: Float32Array, labels: BigInt64Array, options?: SearchOptions): number;
+    /** 
+     * Find all neighbors closer than radius (L2) or with an inner product above
+     * radius (inner product). Will throw if not supported by the index type.
+     * Like `search`, blocks the event loop while async writes hold the index.
+     *
+     * @param {VectorArray} x Input vectors to search, size n * d.
+     * @param {number} radius The search radius.
+     * @param {SearchOptions} options Per-call search options.
+     * @return {RangeSearchResult} Output of the range search.
+     */
+    rangeSearch(x: VectorArray, radius: number, options?: SearchOptions): RangeSearchResult;
+    /** 
+     * Query n vectors of dimension d to the index on a worker thread,
+     * without blocking the event loop. Searches run concurrently with each
+     * other, while adds, removals and resets wait for them and run exclusively.
+     * Searches with options are not micro-batched.
+     *
+     * @param {VectorArray} x Input vectors to search, size n * d.
+     * @param {number} k The number of nearest neighbors to search for.
+     * @param {SearchOptions} options Per-call search options.
+     * @return {Promise<SearchResult>} Output of the search result.
+     */
+    searchAsync(x: VectorArray, k: number, options?: SearchOptions): Promise<SearchResult>;
+    /**
+     * Enable micro-batching of `searchAsync`: concurrent queries with the same k are
+     * queued natively and served by a single faiss search of the combined vectors.
+     * Reconfiguring resets the counters of `getBatchingStats`.
+     * @param {BatchingOptions} options Batching options.
+     */
+    setBatching(options: BatchingOptions): void;
+    /**
+     * @return {BatchingStats} Counters of the micro-batching scheduler.
+     */
+    getBatchingStats(): BatchingStats;
+    /**
+     * Counters and latency histograms maintained natively by the index, cheap
+     * enough to export on every scrape, e.g. as Prometheus histograms.
+     * @return {IndexMetrics} A snapshot of the metrics of this index.
+     */
+    getMetrics(): IndexMetrics;
+    /**
+     * Page in the inverted lists of an index read with `{ mmap: true }` on a
+     * background thread, so the first searches don't pay for the page faults.
+     * Not available on Windows.
+     * @param {WarmupOptions} options Warmup budget and progress callback.
+     * @return {Promise<WarmupProgress>} Amount of data paged in.
+     */
+    warmup(options?: WarmupOptions): Promise<WarmupProgress>;
+    /**
+     * Give the kernel an access pattern hint for the memory-mapped inverted lists
+     * of an index read with `{ mmap: true }`. Not available on Windows.
+     * @param {string} advice madvise(2) hint.
+     */
+    setMadvise(advice: 'normal' | 'random' | 'sequential' | 'willneed' | 'dontneed'): void;
+    /**
+     * Store the inverted lists of an IVF index (e.g. IndexIVFFlat, or IVF,PQ and IVF,SQ from a factory) in
+     * an on-disk data file, so that vectors added afterwards are written to the file rather than kept in
+     * memory. Vectors already in the index are copied to the file. The index written by `write` refers to
+     * the data file and can be served with `read(path, { mmap: true })`. Not available on Windows.
+     * @param {string} dataPath Path of the data file, created or truncated.
+     */
+    setOnDiskInvertedLists(dataPath: string): void;
     /** 
      * Reconstruct desired vector from index. Will throw if not supported
      * by the index type.
@@ -124,22 +563,72 @@ export class Index {
      * Write index to buffer.
      */
     toBuffer(): Buffer;
+    /**
+     * Serialize the index to a writable stream in chunks, on a background thread.
+     * Each chunk is only produced once the stream accepted the previous one (or emitted
+     * 'drain'), so the serialized index is never held in memory as a whole. The stream
+     * is not ended. The index cannot be modified until the promise settles, nor can the
+     * shards, replicas or refine sources it uses, or the indexes using it.
+     * @param {NodeJS.WritableStream} stream Destination stream.
+     * @param {WriteStreamOptions} options Streaming options.
+     * @return {Promise<number>} Number of bytes written.
+     */
+    writeStream(stream: NodeJS.WritableStream, options?: WriteStreamOptions): Promise<number>;
     /** 
      * Create an IDMap'd index from source index.
      */
     toIDMap2(): Index;
+    /**
+     * Wrap this empty index in a re-ranking stage: searches fetch k * kFactor
+     * candidates from this index and return the k nearest by exact distance to
+     * full vectors stored alongside. This index is kept alive and locked with the
+     * returned one, and can't be disposed before it. The returned index doesn't
+     * support the `filter` search option.
+     * @param {number} kFactor Candidates fetched per result (defaults to 1).
+     * @return {Index} The wrapping index.
+     */
+    toRefineFlat(kFactor?: number): Index;
+    /**
+     * Like toRefineFlat, but re-rank with the distances of another index, e.g. a
+     * finer quantizer. Both indexes must hold the same vectors (usually none); they
+     * are kept alive and locked with the returned one, like this index. The returned
+     * index doesn't support the `filter` search option.
+     * @param {Index} refineIndex Index computing the final distances.
+     * @param {number} kFactor Candidates fetched per result (defaults to 1).
+     * @return {Index} The wrapping index.
+     */
+    toRefine(refineIndex: Index, kFactor?: number): Index;
+    /**
+     * Candidates fetched per result by an index made by toRefineFlat or toRefine,
+     * undefined for other indexes.
+     */
+    get kFactor(): number | undefined;
+    /**
+     * Candidates fetched per result, at least 1. Throws for indexes not made by
+     * toRefineFlat or toRefine.
+     * @param {number} value The value to set.
+     */
+    set kFactor(value: number | undefined);
     /** 
      * Read index from a file.
      * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
      * @return {Index} The index read.
      */
-    static read(fname: string): Index;
+    static read(fname: string, options?: ReadOptions): Index;
     /** 
      * Read index from buffer.
      * @param {Buffer} src Buffer to create index from.
      * @return {Index} The index read.
      */
     static fromBuffer(src: Buffer): Index;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<Index>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<Index>;
     /** 
      * Construct an index from factory descriptor.
      * @param {number} dims Buffer to create index from.
@@ -158,13 +647,16 @@ export class Index {
      * @param {BigInt[]} ids IDs to read.
      * @return {number} number of IDs removed.
      */
-    removeIds(ids: BigInt[]): number;
+    removeIds(ids: IdArray): number;
     /**
      * Reset the index, resulting in a ntotal of 0.
      */
     reset(): void;
     /**
-     * Free all resources associated with the index. Further calls to the index will throw.
+     * Free all resources associated with the index, after waiting for in-flight async
+     * work to complete. Async work queued meanwhile rejects. Further calls to the index,
+     * async ones included, throw "Index has been disposed.".
+     * Throws while the index is used by another one, e.g. as a shard or IVF quantizer, until that one is disposed.
      */
     dispose(): void;
 }
@@ -209,15 +701,23 @@ export class IndexFlatL2 extends IndexFlat {
     /** 
      * Read index from a file.
      * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
      * @return {IndexFlatL2} The index read.
      */
-    static read(fname: string): IndexFlatL2;
+    static read(fname: string, options?: ReadOptions): IndexFlatL2;
     /** 
      * Read index from buffer.
      * @param {Buffer} src Buffer to create index from.
      * @return {IndexFlatL2} The index read.
      */
     static fromBuffer(src: Buffer): IndexFlatL2;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexFlatL2>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexFlatL2>;
     /**
      * Merge the current index with another IndexFlatL2 instance.
      * @param {IndexFlatL2} otherIndex The other IndexFlatL2 instance to merge from.
@@ -234,15 +734,23 @@ export class IndexFlatIP extends IndexFlat {
     /** 
      * Read index from a file.
      * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
      * @return {IndexFlatIP} The index read.
      */
-    static read(fname: string): IndexFlatIP;
+    static read(fname: string, options?: ReadOptions): IndexFlatIP;
     /** 
      * Read index from buffer.
      * @param {Buffer} src Buffer to create index from.
      * @return {IndexFlatIP} The index read.
      */
     static fromBuffer(src: Buffer): IndexFlatIP;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexFlatIP>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexFlatIP>;
     /**
      * Merge the current index with another IndexFlatIP instance.
      * @param {IndexFlatIP} otherIndex The other IndexFlatIP instance to merge from.
@@ -262,15 +770,23 @@ export class IndexHNSW extends Index {
     /** 
      * Read index from a file.
      * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
      * @return {IndexHNSW} The index read.
      */
-    static read(fname: string): IndexHNSW;
+    static read(fname: string, options?: ReadOptions): IndexHNSW;
     /** 
      * Read index from buffer.
      * @param {Buffer} src Buffer to create index from.
      * @return {IndexHNSW} The index read.
      */
     static fromBuffer(src: Buffer): IndexHNSW;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexHNSW>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexHNSW>;
     /**
      * Merge the current index with another IndexHNSW instance.
      * @param {IndexHNSW} otherIndex The other IndexHNSW instance to merge from.
@@ -296,10 +812,132 @@ export class IndexHNSW extends Index {
     set efSearch(value: number);
 }
 
+/**
+ * IndexHNSWSQ Index.
+ * HNSW graph over vectors compressed by scalar quantization; train before adding.
+ * @param {number} d The dimensionality of index.
+ * @param {QuantizerType} qtype Quantizer type (defaults to QT_8bit).
+ * @param {number} m The number of neighbors used in the graph (defaults to 32).
+ * @param {number} metric Metric type (defaults to L2).
+ */
+export class IndexHNSWSQ extends Index {
+    IndexHNSWSQ(d: number, qtype?: QuantizerType, m?: number, metric?: MetricType);
+    /** 
+     * Read index from a file.
+     * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
+     * @return {IndexHNSWSQ} The index read.
+     */
+    static read(fname: string, options?: ReadOptions): IndexHNSWSQ;
+    /** 
+     * Read index from buffer.
+     * @param {Buffer} src Buffer to create index from.
+     * @return {IndexHNSWSQ} The index read.
+     */
+    static fromBuffer(src: Buffer): IndexHNSWSQ;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexHNSWSQ>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexHNSWSQ>;
+    /**
+     * The depth of exploration at add time.
+     */
+    get efConstruction(): number;
+    /**
+     * The depth of exploration at add time.
+     * @param {number} value The value to set.
+     */
+    set efConstruction(value: number);
+    /**
+     * The depth of exploration of the search.
+     */
+    get efSearch(): number;
+    /**
+     * The depth of exploration of the search.
+     * @param {number} value The value to set.
+     */
+    set efSearch(value: number);
+    /**
+     * Bytes per stored vector, excluding the graph links.
+     */
+    get codeSize(): number;
+    /**
+     * Quantizer type of the stored vectors.
+     */
+    get qtype(): QuantizerType;
+}
+
+/**
+ * IndexHNSWPQ Index.
+ * HNSW graph over vectors compressed by product quantization; train before adding.
+ * Only the L2 metric is supported.
+ * @param {number} d The dimensionality of index.
+ * @param {number} pqM Number of PQ sub-quantizers, must divide d.
+ * @param {number} m The number of neighbors used in the graph (defaults to 32).
+ * @param {number} nbits Bits per sub-quantizer index (defaults to 8).
+ */
+export class IndexHNSWPQ extends Index {
+    IndexHNSWPQ(d: number, pqM: number, m?: number, nbits?: number);
+    /** 
+     * Read index from a file.
+     * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
+     * @return {IndexHNSWPQ} The index read.
+     */
+    static read(fname: string, options?: ReadOptions): IndexHNSWPQ;
+    /** 
+     * Read index from buffer.
+     * @param {Buffer} src Buffer to create index from.
+     * @return {IndexHNSWPQ} The index read.
+     */
+    static fromBuffer(src: Buffer): IndexHNSWPQ;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexHNSWPQ>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexHNSWPQ>;
+    /**
+     * The depth of exploration at add time.
+     */
+    get efConstruction(): number;
+    /**
+     * The depth of exploration at add time.
+     * @param {number} value The value to set.
+     */
+    set efConstruction(value: number);
+    /**
+     * The depth of exploration of the search.
+     */
+    get efSearch(): number;
+    /**
+     * The depth of exploration of the search.
+     * @param {number} value The value to set.
+     */
+    set efSearch(value: number);
+    /**
+     * Bytes per stored vector, excluding the graph links.
+     */
+    get codeSize(): number;
+    /**
+     * Number of PQ sub-quantizers.
+     */
+    get M(): number;
+    /**
+     * Bits per sub-quantizer index.
+     */
+    get nbits(): number;
+}
+
 /**
  * IndexIVFFlat Index.
  * Inverted file with stored vectors.
- * @param {Index} quantizer.
+ * @param {Index} quantizer Coarse quantizer, used in place: it is kept alive and locked
+ * with this index, and can't be disposed before it.
  * @param {number} d The dimensionality of index.
  * @param {number} nlist Number of clusters.
  * @param {number} metric Metric type (defaults to L2).
@@ -309,15 +947,23 @@ export class IndexIVFFlat extends Index {
     /** 
      * Read index from a file.
      * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
      * @return {IndexIVFFlat} The index read.
      */
-    static read(fname: string): IndexIVFFlat;
+    static read(fname: string, options?: ReadOptions): IndexIVFFlat;
     /** 
      * Read index from buffer.
      * @param {Buffer} src Buffer to create index from.
      * @return {IndexIVFFlat} The index read.
      */
     static fromBuffer(src: Buffer): IndexIVFFlat;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexIVFFlat>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexIVFFlat>;
     /** 
      * Merge trained & untrained IVF indexes on disk.
      * @param {(string|IndexIVFFlat)[]} inputIdxOrPaths IVF indexes (or paths) to merge, with the first being trained.
@@ -325,6 +971,16 @@ export class IndexIVFFlat extends Index {
      * @param {string} outputDataPath Path of final merged data file.
      */
     static mergeOnDisk(mergePaths: string[], outputIndexPath: string, outputDataPath: string): void;
+    /**
+     * Merge IVF indexes on disk on a background thread. Unlike `mergeOnDisk`, the inputs are not modified.
+     * @param {(string|IndexIVFFlat)[]} inputIdxOrPaths IVF indexes (or paths) to merge. Without `append`, the first
+     * one provides the trained quantizer; with `append` all of them are added to the output.
+     * @param {string} outputIndexPath Path of final merged index file.
+     * @param {string} outputDataPath Path of final merged data file, which must be the data file of the output index when appending.
+     * @param {MergeOnDiskOptions} options Merge options.
+     * @return {Promise<MergeOnDiskResult>} Entries copied and size of the output index.
+     */
+    static mergeOnDiskAsync(inputIdxOrPaths: (string | IndexIVFFlat)[], outputIndexPath: string, outputDataPath: string, options?: MergeOnDiskOptions): Promise<MergeOnDiskResult>;
     /**
      * Merge the current index with another IndexIVFFlat instance.
      * @param {IndexIVFFlat} otherIndex The other IndexIVFFlat instance to merge from.
@@ -343,4 +999,525 @@ export class IndexIVFFlat extends Index {
      * Vector identifiers, size ntotal.
      */
     get ids(): BigInt[];
-}
\ No newline at end of file
+}
+
+/**
+ * IndexIVFPQ Index.
+ * Inverted file with vectors compressed by product quantization.
+ * @param {Index} quantizer Coarse quantizer, used in place: it is kept alive and locked
+ * with this index, and can't be disposed before it.
+ * @param {number} d The dimensionality of index.
+ * @param {number} nlist Number of clusters.
+ * @param {number} M Number of sub-quantizers, must divide d.
+ * @param {number} nbits Bits per sub-quantizer index (defaults to 8).
+ * @param {number} metric Metric type (defaults to L2).
+ */
+export class IndexIVFPQ extends Index {
+    IndexIVFPQ(quantizer: Index, d: number, nlist: number, M: number, nbits?: number, metric?: MetricType);
+    /** 
+     * Read index from a file.
+     * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
+     * @return {IndexIVFPQ} The index read.
+     */
+    static read(fname: string, options?: ReadOptions): IndexIVFPQ;
+    /** 
+     * Read index from buffer.
+     * @param {Buffer} src Buffer to create index from.
+     * @return {IndexIVFPQ} The index read.
+     */
+    static fromBuffer(src: Buffer): IndexIVFPQ;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexIVFPQ>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexIVFPQ>;
+    /**
+     * Merge the current index with another IndexIVFPQ instance.
+     * @param {IndexIVFPQ} otherIndex The other IndexIVFPQ instance to merge from.
+     */
+    mergeFrom(otherIndex: IndexIVFPQ): void;
+    /**
+     * Cells to search.
+     */
+    get nprobe(): number;
+    /**
+     * Cells to search.
+     * @param {number} value The value to set.
+     */
+    set nprobe(value: number);
+    /**
+     * Bytes per stored vector.
+     */
+    get codeSize(): number;
+    /**
+     * Whether vectors are encoded relative to their list centroid.
+     */
+    get byResidual(): boolean;
+    /**
+     * Whether vectors are encoded relative to their list centroid, only settable before training.
+     * @param {boolean} value The value to set.
+     */
+    set byResidual(value: boolean);
+    /**
+     * Number of sub-quantizers.
+     */
+    get M(): number;
+    /**
+     * Bits per sub-quantizer index.
+     */
+    get nbits(): number;
+    /**
+     * Precomputed distance tables of residual encoding: -1 disabled, 0 decided by
+     * table size, 1 always, 2 for a MultiIndexQuantizer.
+     */
+    get usePrecomputedTable(): number;
+    /**
+     * Precomputed distance tables of residual encoding, rebuilt if the index is trained.
+     * @param {number} value The value to set.
+     */
+    set usePrecomputedTable(value: number);
+}
+
+/**
+ * IndexIVFScalarQuantizer Index.
+ * Inverted file with vectors compressed by scalar quantization.
+ * @param {Index} quantizer Coarse quantizer, used in place: it is kept alive and locked
+ * with this index, and can't be disposed before it.
+ * @param {number} d The dimensionality of index.
+ * @param {number} nlist Number of clusters.
+ * @param {QuantizerType} qtype Quantizer type (defaults to QT_8bit).
+ * @param {number} metric Metric type (defaults to L2).
+ * @param {boolean} byResidual Encode vectors relative to their centroid (defaults to true).
+ */
+export class IndexIVFScalarQuantizer extends Index {
+    IndexIVFScalarQuantizer(quantizer: Index, d: number, nlist: number, qtype?: QuantizerType, metric?: MetricType, byResidual?: boolean);
+    /** 
+     * Read index from a file.
+     * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
+     * @return {IndexIVFScalarQuantizer} The index read.
+     */
+    static read(fname: string, options?: ReadOptions): IndexIVFScalarQuantizer;
+    /** 
+     * Read index from buffer.
+     * @param {Buffer} src Buffer to create index from.
+     * @return {IndexIVFScalarQuantizer} The index read.
+     */
+    static fromBuffer(src: Buffer): IndexIVFScalarQuantizer;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexIVFScalarQuantizer>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexIVFScalarQuantizer>;
+    /**
+     * Merge the current index with another IndexIVFScalarQuantizer instance.
+     * @param {IndexIVFScalarQuantizer} otherIndex The other IndexIVFScalarQuantizer instance to merge from.
+     */
+    mergeFrom(otherIndex: IndexIVFScalarQuantizer): void;
+    /**
+     * Cells to search.
+     */
+    get nprobe(): number;
+    /**
+     * Cells to search.
+     * @param {number} value The value to set.
+     */
+    set nprobe(value: number);
+    /**
+     * Bytes per stored vector.
+     */
+    get codeSize(): number;
+    /**
+     * Whether vectors are encoded relative to their list centroid.
+     */
+    get byResidual(): boolean;
+    /**
+     * Whether vectors are encoded relative to their list centroid, only settable before training.
+     * @param {boolean} value The value to set.
+     */
+    set byResidual(value: boolean);
+    /**
+     * Quantizer type.
+     */
+    get qtype(): QuantizerType;
+}
+
+/**
+ * IndexPQFastScan Index.
+ * Product quantization with 4-bit codes scanned by SIMD lookup-table kernels.
+ * faiss doesn't support search parameters for these kernels, so the `filter`,
+ * `nprobe` and `maxCodes` search options are rejected.
+ * @param {number} d The dimensionality of index.
+ * @param {number} M Number of sub-quantizers, must divide d.
+ * @param {number} nbits Bits per sub-quantizer index (only 4 is supported).
+ * @param {number} metric Metric type (defaults to L2).
+ * @param {number} bbs Block size, a multiple of 32 (defaults to 32).
+ */
+export class IndexPQFastScan extends Index {
+    IndexPQFastScan(d: number, M: number, nbits?: number, metric?: MetricType, bbs?: number);
+    /** 
+     * Read index from a file.
+     * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
+     * @return {IndexPQFastScan} The index read.
+     */
+    static read(fname: string, options?: ReadOptions): IndexPQFastScan;
+    /** 
+     * Read index from buffer.
+     * @param {Buffer} src Buffer to create index from.
+     * @return {IndexPQFastScan} The index read.
+     */
+    static fromBuffer(src: Buffer): IndexPQFastScan;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexPQFastScan>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexPQFastScan>;
+    /**
+     * Number of sub-quantizers.
+     */
+    get M(): number;
+    /**
+     * Bits per sub-quantizer index.
+     */
+    get nbits(): number;
+    /**
+     * Block size of the fast-scan kernels, in vectors.
+     */
+    get bbs(): number;
+    /**
+     * Fast-scan implementation, 0 to let faiss choose.
+     */
+    get implem(): number;
+    /**
+     * Fast-scan implementation, 0 to let faiss choose.
+     * @param {number} value The value to set.
+     */
+    set implem(value: number);
+    /**
+     * Wrap this empty index in a re-ranking stage: searches fetch k * kFactor
+     * candidates from this index and return the k nearest by exact distance to
+     * full vectors stored alongside. This index is kept alive and locked with the
+     * returned one, and can't be disposed before it. The returned index doesn't
+     * support the `filter` search option.
+     * @param {number} kFactor Candidates fetched per result (defaults to 1).
+     * @return {IndexPQFastScan} The wrapping index.
+     */
+    toRefineFlat(kFactor?: number): IndexPQFastScan;
+}
+
+/**
+ * IndexIVFPQFastScan Index.
+ * Inverted file with 4-bit product quantization codes scanned by SIMD kernels.
+ * faiss doesn't support search parameters for these kernels, so the `filter`,
+ * `nprobe` and `maxCodes` search options are rejected.
+ * @param {Index} quantizer Coarse quantizer, used in place: it is kept alive and locked
+ * with this index, and can't be disposed before it.
+ * @param {number} d The dimensionality of index.
+ * @param {number} nlist Number of clusters.
+ * @param {number} M Number of sub-quantizers, must divide d.
+ * @param {number} nbits Bits per sub-quantizer index (only 4 is supported).
+ * @param {number} metric Metric type (defaults to L2).
+ * @param {number} bbs Block size, a multiple of 32 (defaults to 32).
+ */
+export class IndexIVFPQFastScan extends Index {
+    IndexIVFPQFastScan(quantizer: Index, d: number, nlist: number, M: number, nbits?: number, metric?: MetricType, bbs?: number);
+    /** 
+     * Read index from a file.
+     * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
+     * @return {IndexIVFPQFastScan} The index read.
+     */
+    static read(fname: string, options?: ReadOptions): IndexIVFPQFastScan;
+    /** 
+     * Read index from buffer.
+     * @param {Buffer} src Buffer to create index from.
+     * @return {IndexIVFPQFastScan} The index read.
+     */
+    static fromBuffer(src: Buffer): IndexIVFPQFastScan;
+    /**
+     * Read index from a readable stream, deserializing it on a background thread.
+     * @param {NodeJS.ReadableStream} stream Stream of Buffer chunks, e.g. from `writeStream`.
+     * @param {ReadStreamOptions} options Streaming options.
+     * @return {Promise<IndexIVFPQFastScan>} The index read.
+     */
+    static readStream(stream: NodeJS.ReadableStream, options?: ReadStreamOptions): Promise<IndexIVFPQFastScan>;
+    /**
+     * Number of sub-quantizers.
+     */
+    get M(): number;
+    /**
+     * Bits per sub-quantizer index.
+     */
+    get nbits(): number;
+    /**
+     * Block size of the fast-scan kernels, in vectors.
+     */
+    get bbs(): number;
+    /**
+     * Fast-scan implementation, 0 to let faiss choose.
+     */
+    get implem(): number;
+    /**
+     * Fast-scan implementation, 0 to let faiss choose.
+     * @param {number} value The value to set.
+     */
+    set implem(value: number);
+    /**
+     * Wrap this empty index in a re-ranking stage: searches fetch k * kFactor
+     * candidates from this index and return the k nearest by exact distance to
+     * full vectors stored alongside. This index is kept alive and locked with the
+     * returned one, and can't be disposed before it. The returned index doesn't
+     * support the `filter` search option.
+     * @param {number} kFactor Candidates fetched per result (defaults to 1).
+     * @return {IndexIVFPQFastScan} The wrapping index.
+     */
+    toRefineFlat(kFactor?: number): IndexIVFPQFastScan;
+    /**
+     * Cells to search.
+     */
+    get nprobe(): number;
+    /**
+     * Cells to search.
+     * @param {number} value The value to set.
+     */
+    set nprobe(value: number);
+}
+
+/**
+ * IndexShards Index.
+ * Searches several indexes of the same dimension and merges their results.
+ * Shards added or removed from directly are locked against concurrent searches of
+ * this index, but their vectors are not counted in its ntotal. Searches don't
+ * support the `filter` option, which faiss can't forward to the shards.
+ * @param {number} d The dimensionality of index.
+ * @param {boolean} threaded Search the shards in parallel threads (defaults to true).
+ * @param {boolean} successiveIds Offset the labels of each shard by the vectors of
+ * the shards before it, rather than returning shard labels as-is (defaults to true).
+ */
+export class IndexShards extends Index {
+    constructor(d: number, threaded?: boolean, successiveIds?: boolean);
+    /**
+     * Add a shard. Vectors added to this index are then split across the shards.
+     * Not allowed once this index is itself a shard.
+     * @param {Index|string} shard An index, kept alive and locked with this one, or the path of an index file.
+     * @param {ReadOptions} options IO options when reading a file, e.g. `{ mmap: true }`.
+     */
+    addShard(shard: Index | string, options?: ReadOptions): void;
+    /**
+     * @return {number} The number of shards.
+     */
+    get nshards(): number;
+}
+
+/**
+ * IndexReplicas Index.
+ * Splits each batch of queries across copies of an index, searched in parallel
+ * threads. Single queries only use the first replica, so combine with
+ * `setBatching` for concurrent single-query traffic. Searches don't support the
+ * `filter` option, which faiss can't forward to the replicas.
+ * @param {number} d The dimensionality of index.
+ * @param {boolean} threaded Search the replicas in parallel threads (defaults to true).
+ */
+export class IndexReplicas extends Index {
+    constructor(d: number, threaded?: boolean);
+    /**
+     * Add a replica holding the same vectors as the others. Vectors added to this
+     * index are then added to every replica.
+     * @param {Index|string} replica An index, kept alive and locked with this one (it
+     * can't be disposed before this one), or the path of an index file. Reading an on-disk IVF index with `{ mmap: true }` lets the
+     * replicas share its inverted lists through the page cache instead of copies.
+     * @param {ReadOptions} options IO options when reading a file.
+     */
+    addReplica(replica: Index | string, options?: ReadOptions): void;
+    /**
+     * @return {number} The number of replicas.
+     */
+    get nreplicas(): number;
+}
+
+/**
+ * IndexBinary Index.
+ * Index of packed binary vectors compared by Hamming distance.
+ * Binary indexes have a narrower API than `Index`: searches take no options and
+ * always return typed arrays (`BinarySearchResult`, not `SearchResult`), and there
+ * are no metrics, batching, addAsync, writeStream or merge methods. They can't be
+ * used as shards, replicas or refine indexes of float indexes. Synchronous adds
+ * and training block the event loop until in-flight `searchAsync` calls complete.
+ * @param {number} d The dimensionality of index in bits, a multiple of 8.
+ */
+export class IndexBinary {
+    constructor(d: number);
+    /**
+     * @return {IndexType} The type of index.
+     */
+    get indexType(): IndexType;
+    /**
+     * @return {number} The number of vectors currently indexed.
+     */
+    get ntotal(): number;
+    /**
+     * @return {number} The dimensionality of vectors in bits.
+     */
+    get dims(): number;
+    /**
+     * @return {number} Bytes per vector, dims / 8.
+     */
+    get codeSize(): number;
+    /**
+     * @return {boolean} Whether the index is trained.
+     */
+    get isTrained(): boolean;
+    /**
+     * Add n vectors to the index, labelled ntotal .. ntotal + n - 1.
+     * @param {BinaryVectorArray} x Input matrix, n * d / 8 bytes.
+     */
+    add(x: BinaryVectorArray): void;
+    /**
+     * Add n vectors with the given labels, for indexes that support it (e.g. IndexBinaryIVF).
+     * @param {BinaryVectorArray} x Input matrix, n * d / 8 bytes.
+     * @param {IdArray} labels Labels of the vectors, size n.
+     */
+    addWithIds(x: BinaryVectorArray, labels: IdArray): void;
+    /**
+     * Train the index on a representative set of vectors.
+     * @param {BinaryVectorArray} x Training vectors, n * d / 8 bytes.
+     */
+    train(x: BinaryVectorArray): void;
+    /**
+     * Query n vectors for their k nearest neighbors.
+     * @param {BinaryVectorArray} x Query vectors, n * d / 8 bytes.
+     * @param {number} k Neighbors per query (defaults to and is capped at ntotal).
+     * @return {BinarySearchResult} Hamming distances and labels.
+     */
+    search(x: BinaryVectorArray, k?: number): BinarySearchResult;
+    /**
+     * Query n vectors for their k nearest neighbors on a worker thread.
+     * @param {BinaryVectorArray} x Query vectors, n * d / 8 bytes.
+     * @param {number} k Neighbors per query (defaults to and is capped at ntotal).
+     * @return {Promise<BinarySearchResult>} Hamming distances and labels.
+     */
+    searchAsync(x: BinaryVectorArray, k?: number): Promise<BinarySearchResult>;
+    /**
+     * @param {number|BigInt} key Label of a stored vector.
+     * @return {Uint8Array} The packed vector.
+     */
+    reconstruct(key: number | BigInt): Uint8Array;
+    /**
+     * Remove vectors by label.
+     * @param {IdArray} ids Labels to remove.
+     * @return {number} Number of vectors removed.
+     */
+    removeIds(ids: IdArray): number;
+    /**
+     * Remove all vectors.
+     */
+    reset(): void;
+    /**
+     * Free the index memory, after waiting for in-flight searchAsync calls to complete.
+     * Searches queued meanwhile reject, and further calls to the index throw.
+     * Throws if the index is the quantizer of an IVF index that isn't disposed.
+     */
+    dispose(): void;
+    /**
+     * Write index to a file.
+     * @param {string} fname File path to write.
+     */
+    write(fname: string): void;
+    /**
+     * Serialize the index to a buffer.
+     * @return {Buffer} The serialized index.
+     */
+    toBuffer(): Buffer;
+    /**
+     * Read index from a file.
+     * @param {string} fname File path to read.
+     * @param {ReadOptions} options IO options (defaults to reading the whole index into memory).
+     * @return {IndexBinary} The index read.
+     */
+    static read(fname: string, options?: ReadOptions): IndexBinary;
+    /**
+     * Read index from buffer.
+     * @param {Buffer} src Buffer to create index from.
+     * @return {IndexBinary} The index read.
+     */
+    static fromBuffer(src: Buffer): IndexBinary;
+    /**
+     * Construct a binary index from a factory description, e.g. "BFlat", "BHNSW32" or "BIVF1024".
+     * @param {number} d The dimensionality of index in bits.
+     * @param {string} description Factory description.
+     * @return {IndexBinary} The index.
+     */
+    static fromFactory(d: number, description: string): IndexBinary;
+}
+
+/**
+ * IndexBinaryFlat Index.
+ * Exhaustive Hamming distance search.
+ * @param {number} d The dimensionality of index in bits, a multiple of 8.
+ */
+export class IndexBinaryFlat extends IndexBinary {
+    constructor(d: number);
+    static read(fname: string, options?: ReadOptions): IndexBinaryFlat;
+    static fromBuffer(src: Buffer): IndexBinaryFlat;
+}
+
+/**
+ * IndexBinaryHNSW Index.
+ * HNSW graph over binary vectors.
+ * @param {number} d The dimensionality of index in bits, a multiple of 8.
+ * @param {number} m The number of neighbors used in the graph (defaults to 32).
+ */
+export class IndexBinaryHNSW extends IndexBinary {
+    constructor(d: number, m?: number);
+    static read(fname: string, options?: ReadOptions): IndexBinaryHNSW;
+    static fromBuffer(src: Buffer): IndexBinaryHNSW;
+    /**
+     * The depth of exploration at add time.
+     */
+    get efConstruction(): number;
+    /**
+     * The depth of exploration at add time.
+     * @param {number} value The value to set.
+     */
+    set efConstruction(value: number);
+    /**
+     * The depth of exploration of the search.
+     */
+    get efSearch(): number;
+    /**
+     * The depth of exploration of the search.
+     * @param {number} value The value to set.
+     */
+    set efSearch(value: number);
+}
+
+/**
+ * IndexBinaryIVF Index.
+ * Inverted file of binary vectors.
+ * @param {IndexBinaryFlat} quantizer Coarse quantizer, used in place: it is kept alive and
+ * locked with this index, and can't be disposed before it.
+ * @param {number} d The dimensionality of index in bits, a multiple of 8.
+ * @param {number} nlist Number of clusters.
+ */
+export class IndexBinaryIVF extends IndexBinary {
+    constructor(quantizer: IndexBinary, d: number, nlist: number);
+    static read(fname: string, options?: ReadOptions): IndexBinaryIVF;
+    static fromBuffer(src: Buffer): IndexBinaryIVF;
+    /**
+     * Cells to search.
+     */
+    get nprobe(): number;
+    /**
+     * Cells to search.
+     * @param {number} value The value to set.
+     */
+    set nprobe(value: number);
+}
@@ -27,10 +27,36 @@ var IndexType;
   IndexType[IndexType["IndexFlatL2"] = 11] = "IndexFlatL2";
   IndexType[IndexType["IndexFlatIP"] = 12] = "IndexFlatIP";
   IndexType[IndexType["IndexHNSW"] = 20] = "IndexHNSW";
+  IndexType[IndexType["IndexHNSWSQ"] = 21] = "IndexHNSWSQ";
+  IndexType[IndexType["IndexHNSWPQ"] = 22] = "IndexHNSWPQ";
   IndexType[IndexType["IndexIVF"] = 30] = "IndexIVF";
   IndexType[IndexType["IndexIVFFlat"] = 31] = "IndexIVFFlat";
+  IndexType[IndexType["IndexIVFPQ"] = 32] = "IndexIVFPQ";
+  IndexType[IndexType["IndexIVFScalarQuantizer"] = 33] = "IndexIVFScalarQuantizer";
+  IndexType[IndexType["IndexIVFPQFastScan"] = 34] = "IndexIVFPQFastScan";
+  IndexType[IndexType["IndexPQ"] = 40] = "IndexPQ";
+  IndexType[IndexType["IndexPQFastScan"] = 41] = "IndexPQFastScan";
+  IndexType[IndexType["IndexRefine"] = 50] = "IndexRefine";
+  IndexType[IndexType["IndexShards"] = 70] = "IndexShards";
+  IndexType[IndexType["IndexReplicas"] = 71] = "IndexReplicas";
+  IndexType[IndexType["IndexBinary"] = 60] = "IndexBinary";
+  IndexType[IndexType["IndexBinaryFlat"] = 61] = "IndexBinaryFlat";
+  IndexType[IndexType["IndexBinaryHNSW"] = 62] = "IndexBinaryHNSW";
+  IndexType[IndexType["IndexBinaryIVF"] = 63] = "IndexBinaryIVF";
 })(IndexType || (faiss.IndexType = IndexType = {}));
 
+faiss.QuantizerType = void 0;
+var QuantizerType;
+(function (QuantizerType) {
+  QuantizerType[QuantizerType["QT_8bit"] = 0] = "QT_8bit";
+  QuantizerType[QuantizerType["QT_4bit"] = 1] = "QT_4bit";
+  QuantizerType[QuantizerType["QT_8bit_uniform"] = 2] = "QT_8bit_uniform";
+  QuantizerType[QuantizerType["QT_4bit_uniform"] = 3] = "QT_4bit_uniform";
+  QuantizerType[QuantizerType["QT_fp16"] = 4] = "QT_fp16";
+  QuantizerType[QuantizerType["QT_8bit_direct"] = 5] = "QT_8bit_direct";
+  QuantizerType[QuantizerType["QT_6bit"] = 6] = "QT_6bit";
+})(QuantizerType || (faiss.QuantizerType = QuantizerType = {}));
+
 function wireupGetterSetters(propName, indexes, getter, setter) {
   for (let Index of indexes) {
     if (!(propName in Index.prototype)) { // prevents redefinition in jest
@@ -50,7 +76,11 @@ function wireupGetterSetters(propName, indexes, getter, setter) {
   }
 }
 
-const allIndexes = [faiss.Index, faiss.IndexFlatL2, faiss.IndexFlatIP, faiss.IndexHNSW, faiss.IndexIVFFlat];
+const allIndexes = [
+  faiss.Index, faiss.IndexFlatL2, faiss.IndexFlatIP, faiss.IndexHNSW, faiss.IndexHNSWSQ, faiss.IndexHNSWPQ,
+  faiss.IndexIVFFlat, faiss.IndexIVFPQ, faiss.IndexIVFScalarQuantizer, faiss.IndexPQFastScan, faiss.IndexIVFPQFastScan,
+  faiss.IndexShards, faiss.IndexReplicas,
+];
 
 // all indexes
 wireupGetterSetters('ntotal', allIndexes, 'getNTotal');
@@ -60,16 +90,49 @@ wireupGetterSetters('metricType', allIndexes, 'getMetricType');
 wireupGetterSetters('metricArg', allIndexes, 'getMetricArg');
 wireupGetterSetters('ids', allIndexes, 'getIds');
 wireupGetterSetters('indexType', allIndexes, 'getIndexType');
+wireupGetterSetters('kFactor', allIndexes, 'getKFactor', 'setKFactor');
 
 // Flat
 wireupGetterSetters('codeSize', [faiss.IndexFlatL2, faiss.IndexFlatIP], 'getCodeSize');
 wireupGetterSetters('codes', [faiss.IndexFlatL2, faiss.IndexFlatIP], 'getCodesUInt8');
 
 // HNSW
-wireupGetterSetters('efConstruction', [faiss.IndexHNSW], 'getEfConstruction', 'setEfConstruction');
-wireupGetterSetters('efSearch', [faiss.IndexHNSW], 'getEfSearch', 'setEfSearch');
+const hnswIndexes = [faiss.IndexHNSW, faiss.IndexHNSWSQ, faiss.IndexHNSWPQ];
+wireupGetterSetters('efConstruction', hnswIndexes, 'getEfConstruction', 'setEfConstruction');
+wireupGetterSetters('efSearch', hnswIndexes, 'getEfSearch', 'setEfSearch');
+wireupGetterSetters('codeSize', [faiss.IndexHNSWSQ, faiss.IndexHNSWPQ], 'getCodeSize');
 
 // IVF
-wireupGetterSetters('nprobe', [faiss.IndexIVFFlat], 'getNProbe', 'setNProbe');
+wireupGetterSetters('nprobe', [faiss.IndexIVFFlat, faiss.IndexIVFPQ, faiss.IndexIVFScalarQuantizer, faiss.IndexIVFPQFastScan], 'getNProbe', 'setNProbe');
+wireupGetterSetters('codeSize', [faiss.IndexIVFPQ, faiss.IndexIVFScalarQuantizer], 'getCodeSize');
+wireupGetterSetters('byResidual', [faiss.IndexIVFPQ, faiss.IndexIVFScalarQuantizer], 'getByResidual', 'setByResidual');
+
+// PQ
+const pqIndexes = [faiss.IndexIVFPQ, faiss.IndexPQFastScan, faiss.IndexIVFPQFastScan, faiss.IndexHNSWPQ];
+wireupGetterSetters('M', pqIndexes, 'getM');
+wireupGetterSetters('nbits', pqIndexes, 'getNBits');
+wireupGetterSetters('usePrecomputedTable', [faiss.IndexIVFPQ], 'getUsePrecomputedTable', 'setUsePrecomputedTable');
+
+// ScalarQuantizer
+wireupGetterSetters('qtype', [faiss.IndexIVFScalarQuantizer, faiss.IndexHNSWSQ], 'getQType');
+
+// Fast-scan
+wireupGetterSetters('bbs', [faiss.IndexPQFastScan, faiss.IndexIVFPQFastScan], 'getBbs');
+wireupGetterSetters('implem', [faiss.IndexPQFastScan, faiss.IndexIVFPQFastScan], 'getImplem', 'setImplem');
+
+// Shards & replicas
+wireupGetterSetters('nshards', [faiss.IndexShards], 'getNShards');
+wireupGetterSetters('nreplicas', [faiss.IndexReplicas], 'getNReplicas');
+
+// Binary
+const binaryIndexes = [faiss.IndexBinary, faiss.IndexBinaryFlat, faiss.IndexBinaryHNSW, faiss.IndexBinaryIVF];
+wireupGetterSetters('ntotal', binaryIndexes, 'getNTotal');
+wireupGetterSetters('dims', binaryIndexes, 'getDimension');
+wireupGetterSetters('codeSize', binaryIndexes, 'getCodeSize');
+wireupGetterSetters('isTrained', binaryIndexes, 'getIsTrained');
+wireupGetterSetters('indexType', binaryIndexes, 'getIndexType');
+wireupGetterSetters('efConstruction', [faiss.IndexBinaryHNSW], 'getEfConstruction', 'setEfConstruction');
+wireupGetterSetters('efSearch', [faiss.IndexBinaryHNSW], 'getEfSearch', 'setEfSearch');
+wireupGetterSetters('nprobe', [faiss.IndexBinaryIVF], 'getNProbe', 'setNProbe');
 
 module.exports = faiss;
\ No newline at end of file
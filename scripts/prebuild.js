@@ -22,14 +22,15 @@ function methodToString(methodType, className, methodObj) {
   return `${prefix}      ${methodType}("${methodName}", &${className}::${methodName}),\n${postfix}`;
 }
 
-function getStringFromIndex({ className, faissClass, indexType, instanceMethods = [], staticMethods = [] }) {
+// `group` holds the methods shared by its indexes and the C++ base class they derive from.
+function getStringFromIndex({ className, faissClass, indexType, instanceMethods = [], staticMethods = [] }, group) {
   if (!className) throw new Error('className required index prop');
 
   faissClass ||= className;
   indexType ||= className;
 
-  const finalInstanceMethods = DATA.instanceMethods.concat(instanceMethods);
-  const finalStaticMethods = DATA.staticMethods.concat(staticMethods);
+  const finalInstanceMethods = group.instanceMethods.concat(instanceMethods);
+  const finalStaticMethods = group.staticMethods.concat(staticMethods);
 
   const instanceMethodsStr = finalInstanceMethods
     .map((method, idx) => methodToString('InstanceMethod', className, method))
@@ -40,10 +41,10 @@ function getStringFromIndex({ className, faissClass, indexType, instanceMethods
     .join('')
     ;
 
-  const str = `class ${className} : public IndexBase<${className}, faiss::${faissClass}, IndexType::${indexType}>
+  const str = `class ${className} : public ${group.baseClass}<${className}, faiss::${faissClass}, IndexType::${indexType}>
 {
 public:
-  using IndexBase::IndexBase;
+  using ${group.baseClass}::${group.baseClass};
 
   static constexpr const char *CLASS_NAME = "${className}";
 
@@ -54,8 +55,7 @@ public:
 ${instanceMethodsStr}${staticMethodsStr}    });
     // clang-format on
 
-    constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
+    setConstructor(func);
 
     exports.Set(CLASS_NAME, func);
     return exports;
@@ -69,10 +69,17 @@ function writeExportsToFile() {
   const filePath = path.join(PATH, '_auto_.cc');
   console.log(`Writing ${filePath}`);
 
-  const indexStrings = DATA.indexes.map(idx => getStringFromIndex(idx));
-
-  const classNames = DATA.indexes.map(({ className }) => className);
-  const exportsStr = classNames.map(className => `${className}::Init(env, exports);`).join('\n  ');
+  const groups = [
+    { ...DATA, baseClass: 'IndexBase' },
+    { ...DATA.binary, baseClass: 'BinaryIndexBase' },
+  ];
+  const indexes = groups.flatMap(group => group.indexes.map(idx => ({ idx, group })));
+  const indexStrings = indexes.map(({ idx, group }) => getStringFromIndex(idx, group));
+
+  const classNames = indexes.map(({ idx }) => idx.className);
+  const exportsStr = classNames.map(className => `${className}::Init(env, exports);`)
+    .concat(DATA.functions.map(name => `exports.Set("${name}", Napi::Function::New(env, ${name}, "${name}"));`))
+    .join('\n  ');
 
   const str = `/** AUTO-GENERATED, DO NOT EDIT. SEE scripts/prebuild.js & indexes.json **/
 #include <napi.h>
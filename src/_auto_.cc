@@ -21,9 +21,28 @@ public:
       InstanceMethod("getMetricArg", &Index::getMetricArg),
       InstanceMethod("getIds", &Index::getIds),
       InstanceMethod("add", &Index::add),
+      InstanceMethod("addAsync", &Index::addAsync),
       InstanceMethod("addWithIds", &Index::addWithIds),
+      InstanceMethod("addWithIdsAsync", &Index::addWithIdsAsync),
       InstanceMethod("train", &Index::train),
+      InstanceMethod("trainAsync", &Index::trainAsync),
       InstanceMethod("search", &Index::search),
+      InstanceMethod("searchTyped", &Index::searchTyped),
+      InstanceMethod("searchInto", &Index::searchInto),
+      InstanceMethod("rangeSearch", &Index::rangeSearch),
+      InstanceMethod("searchAsync", &Index::searchAsync),
+      InstanceMethod("setBatching", &Index::setBatching),
+      InstanceMethod("getBatchingStats", &Index::getBatchingStats),
+      InstanceMethod("getMetrics", &Index::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &Index::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &Index::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &Index::setOnDiskInvertedLists),
+#endif // _MSC_VER
       InstanceMethod("reconstruct", &Index::reconstruct),
       InstanceMethod("reconstructBatch", &Index::reconstructBatch),
       InstanceMethod("reset", &Index::reset),
@@ -32,15 +51,20 @@ public:
       InstanceMethod("mergeFrom", &Index::mergeFrom),
       InstanceMethod("removeIds", &Index::removeIds),
       InstanceMethod("toBuffer", &Index::toBuffer),
+      InstanceMethod("writeStream", &Index::writeStream),
       InstanceMethod("toIDMap2", &Index::toIDMap2),
+      InstanceMethod("toRefineFlat", &Index::toRefineFlat),
+      InstanceMethod("toRefine", &Index::toRefine),
+      InstanceMethod("getKFactor", &Index::getKFactor),
+      InstanceMethod("setKFactor", &Index::setKFactor),
       StaticMethod("fromBuffer", &Index::fromBuffer),
+      StaticMethod("readStream", &Index::readStream),
       StaticMethod("read", &Index::read),
       StaticMethod("fromFactory", &Index::fromFactory),
     });
     // clang-format on
 
-    constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
+    setConstructor(func);
 
     exports.Set(CLASS_NAME, func);
     return exports;
@@ -66,9 +90,28 @@ public:
       InstanceMethod("getMetricArg", &IndexFlatL2::getMetricArg),
       InstanceMethod("getIds", &IndexFlatL2::getIds),
       InstanceMethod("add", &IndexFlatL2::add),
+      InstanceMethod("addAsync", &IndexFlatL2::addAsync),
       InstanceMethod("addWithIds", &IndexFlatL2::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexFlatL2::addWithIdsAsync),
       InstanceMethod("train", &IndexFlatL2::train),
+      InstanceMethod("trainAsync", &IndexFlatL2::trainAsync),
       InstanceMethod("search", &IndexFlatL2::search),
+      InstanceMethod("searchTyped", &IndexFlatL2::searchTyped),
+      InstanceMethod("searchInto", &IndexFlatL2::searchInto),
+      InstanceMethod("rangeSearch", &IndexFlatL2::rangeSearch),
+      InstanceMethod("searchAsync", &IndexFlatL2::searchAsync),
+      InstanceMethod("setBatching", &IndexFlatL2::setBatching),
+      InstanceMethod("getBatchingStats", &IndexFlatL2::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexFlatL2::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexFlatL2::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexFlatL2::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexFlatL2::setOnDiskInvertedLists),
+#endif // _MSC_VER
       InstanceMethod("reconstruct", &IndexFlatL2::reconstruct),
       InstanceMethod("reconstructBatch", &IndexFlatL2::reconstructBatch),
       InstanceMethod("reset", &IndexFlatL2::reset),
@@ -77,18 +120,23 @@ public:
       InstanceMethod("mergeFrom", &IndexFlatL2::mergeFrom),
       InstanceMethod("removeIds", &IndexFlatL2::removeIds),
       InstanceMethod("toBuffer", &IndexFlatL2::toBuffer),
+      InstanceMethod("writeStream", &IndexFlatL2::writeStream),
       InstanceMethod("toIDMap2", &IndexFlatL2::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexFlatL2::toRefineFlat),
+      InstanceMethod("toRefine", &IndexFlatL2::toRefine),
+      InstanceMethod("getKFactor", &IndexFlatL2::getKFactor),
+      InstanceMethod("setKFactor", &IndexFlatL2::setKFactor),
       InstanceMethod("getCodesByRange", &IndexFlatL2::getCodesByRange),
       InstanceMethod("setCodesByRange", &IndexFlatL2::setCodesByRange),
       InstanceMethod("getCodesUInt8", &IndexFlatL2::getCodesUInt8),
       InstanceMethod("getCodeSize", &IndexFlatL2::getCodeSize),
       StaticMethod("fromBuffer", &IndexFlatL2::fromBuffer),
+      StaticMethod("readStream", &IndexFlatL2::readStream),
       StaticMethod("read", &IndexFlatL2::read),
     });
     // clang-format on
 
-    constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
+    setConstructor(func);
 
     exports.Set(CLASS_NAME, func);
     return exports;
@@ -114,9 +162,28 @@ public:
       InstanceMethod("getMetricArg", &IndexFlatIP::getMetricArg),
       InstanceMethod("getIds", &IndexFlatIP::getIds),
       InstanceMethod("add", &IndexFlatIP::add),
+      InstanceMethod("addAsync", &IndexFlatIP::addAsync),
       InstanceMethod("addWithIds", &IndexFlatIP::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexFlatIP::addWithIdsAsync),
       InstanceMethod("train", &IndexFlatIP::train),
+      InstanceMethod("trainAsync", &IndexFlatIP::trainAsync),
       InstanceMethod("search", &IndexFlatIP::search),
+      InstanceMethod("searchTyped", &IndexFlatIP::searchTyped),
+      InstanceMethod("searchInto", &IndexFlatIP::searchInto),
+      InstanceMethod("rangeSearch", &IndexFlatIP::rangeSearch),
+      InstanceMethod("searchAsync", &IndexFlatIP::searchAsync),
+      InstanceMethod("setBatching", &IndexFlatIP::setBatching),
+      InstanceMethod("getBatchingStats", &IndexFlatIP::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexFlatIP::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexFlatIP::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexFlatIP::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexFlatIP::setOnDiskInvertedLists),
+#endif // _MSC_VER
       InstanceMethod("reconstruct", &IndexFlatIP::reconstruct),
       InstanceMethod("reconstructBatch", &IndexFlatIP::reconstructBatch),
       InstanceMethod("reset", &IndexFlatIP::reset),
@@ -125,18 +192,23 @@ public:
       InstanceMethod("mergeFrom", &IndexFlatIP::mergeFrom),
       InstanceMethod("removeIds", &IndexFlatIP::removeIds),
       InstanceMethod("toBuffer", &IndexFlatIP::toBuffer),
+      InstanceMethod("writeStream", &IndexFlatIP::writeStream),
       InstanceMethod("toIDMap2", &IndexFlatIP::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexFlatIP::toRefineFlat),
+      InstanceMethod("toRefine", &IndexFlatIP::toRefine),
+      InstanceMethod("getKFactor", &IndexFlatIP::getKFactor),
+      InstanceMethod("setKFactor", &IndexFlatIP::setKFactor),
       InstanceMethod("getCodesByRange", &IndexFlatIP::getCodesByRange),
       InstanceMethod("setCodesByRange", &IndexFlatIP::setCodesByRange),
       InstanceMethod("getCodesUInt8", &IndexFlatIP::getCodesUInt8),
       InstanceMethod("getCodeSize", &IndexFlatIP::getCodeSize),
       StaticMethod("fromBuffer", &IndexFlatIP::fromBuffer),
+      StaticMethod("readStream", &IndexFlatIP::readStream),
       StaticMethod("read", &IndexFlatIP::read),
     });
     // clang-format on
 
-    constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
+    setConstructor(func);
 
     exports.Set(CLASS_NAME, func);
     return exports;
@@ -162,9 +234,28 @@ public:
       InstanceMethod("getMetricArg", &IndexHNSW::getMetricArg),
       InstanceMethod("getIds", &IndexHNSW::getIds),
       InstanceMethod("add", &IndexHNSW::add),
+      InstanceMethod("addAsync", &IndexHNSW::addAsync),
       InstanceMethod("addWithIds", &IndexHNSW::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexHNSW::addWithIdsAsync),
       InstanceMethod("train", &IndexHNSW::train),
+      InstanceMethod("trainAsync", &IndexHNSW::trainAsync),
       InstanceMethod("search", &IndexHNSW::search),
+      InstanceMethod("searchTyped", &IndexHNSW::searchTyped),
+      InstanceMethod("searchInto", &IndexHNSW::searchInto),
+      InstanceMethod("rangeSearch", &IndexHNSW::rangeSearch),
+      InstanceMethod("searchAsync", &IndexHNSW::searchAsync),
+      InstanceMethod("setBatching", &IndexHNSW::setBatching),
+      InstanceMethod("getBatchingStats", &IndexHNSW::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexHNSW::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexHNSW::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexHNSW::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexHNSW::setOnDiskInvertedLists),
+#endif // _MSC_VER
       InstanceMethod("reconstruct", &IndexHNSW::reconstruct),
       InstanceMethod("reconstructBatch", &IndexHNSW::reconstructBatch),
       InstanceMethod("reset", &IndexHNSW::reset),
@@ -173,18 +264,172 @@ public:
       InstanceMethod("mergeFrom", &IndexHNSW::mergeFrom),
       InstanceMethod("removeIds", &IndexHNSW::removeIds),
       InstanceMethod("toBuffer", &IndexHNSW::toBuffer),
+      InstanceMethod("writeStream", &IndexHNSW::writeStream),
       InstanceMethod("toIDMap2", &IndexHNSW::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexHNSW::toRefineFlat),
+      InstanceMethod("toRefine", &IndexHNSW::toRefine),
+      InstanceMethod("getKFactor", &IndexHNSW::getKFactor),
+      InstanceMethod("setKFactor", &IndexHNSW::setKFactor),
       InstanceMethod("getEfConstruction", &IndexHNSW::getEfConstruction),
       InstanceMethod("setEfConstruction", &IndexHNSW::setEfConstruction),
       InstanceMethod("getEfSearch", &IndexHNSW::getEfSearch),
       InstanceMethod("setEfSearch", &IndexHNSW::setEfSearch),
       StaticMethod("fromBuffer", &IndexHNSW::fromBuffer),
+      StaticMethod("readStream", &IndexHNSW::readStream),
       StaticMethod("read", &IndexHNSW::read),
     });
     // clang-format on
 
-    constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexHNSWSQ : public IndexBase<IndexHNSWSQ, faiss::IndexHNSWSQ, IndexType::IndexHNSWSQ>
+{
+public:
+  using IndexBase::IndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexHNSWSQ";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexHNSWSQ::getIndexType),
+      InstanceMethod("getDimension", &IndexHNSWSQ::getDimension),
+      InstanceMethod("getNTotal", &IndexHNSWSQ::getNTotal),
+      InstanceMethod("getIsTrained", &IndexHNSWSQ::getIsTrained),
+      InstanceMethod("getMetricType", &IndexHNSWSQ::getMetricType),
+      InstanceMethod("getMetricArg", &IndexHNSWSQ::getMetricArg),
+      InstanceMethod("getIds", &IndexHNSWSQ::getIds),
+      InstanceMethod("add", &IndexHNSWSQ::add),
+      InstanceMethod("addAsync", &IndexHNSWSQ::addAsync),
+      InstanceMethod("addWithIds", &IndexHNSWSQ::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexHNSWSQ::addWithIdsAsync),
+      InstanceMethod("train", &IndexHNSWSQ::train),
+      InstanceMethod("trainAsync", &IndexHNSWSQ::trainAsync),
+      InstanceMethod("search", &IndexHNSWSQ::search),
+      InstanceMethod("searchTyped", &IndexHNSWSQ::searchTyped),
+      InstanceMethod("searchInto", &IndexHNSWSQ::searchInto),
+      InstanceMethod("rangeSearch", &IndexHNSWSQ::rangeSearch),
+      InstanceMethod("searchAsync", &IndexHNSWSQ::searchAsync),
+      InstanceMethod("setBatching", &IndexHNSWSQ::setBatching),
+      InstanceMethod("getBatchingStats", &IndexHNSWSQ::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexHNSWSQ::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexHNSWSQ::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexHNSWSQ::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexHNSWSQ::setOnDiskInvertedLists),
+#endif // _MSC_VER
+      InstanceMethod("reconstruct", &IndexHNSWSQ::reconstruct),
+      InstanceMethod("reconstructBatch", &IndexHNSWSQ::reconstructBatch),
+      InstanceMethod("reset", &IndexHNSWSQ::reset),
+      InstanceMethod("dispose", &IndexHNSWSQ::dispose),
+      InstanceMethod("write", &IndexHNSWSQ::write),
+      InstanceMethod("mergeFrom", &IndexHNSWSQ::mergeFrom),
+      InstanceMethod("removeIds", &IndexHNSWSQ::removeIds),
+      InstanceMethod("toBuffer", &IndexHNSWSQ::toBuffer),
+      InstanceMethod("writeStream", &IndexHNSWSQ::writeStream),
+      InstanceMethod("toIDMap2", &IndexHNSWSQ::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexHNSWSQ::toRefineFlat),
+      InstanceMethod("toRefine", &IndexHNSWSQ::toRefine),
+      InstanceMethod("getKFactor", &IndexHNSWSQ::getKFactor),
+      InstanceMethod("setKFactor", &IndexHNSWSQ::setKFactor),
+      InstanceMethod("getEfConstruction", &IndexHNSWSQ::getEfConstruction),
+      InstanceMethod("setEfConstruction", &IndexHNSWSQ::setEfConstruction),
+      InstanceMethod("getEfSearch", &IndexHNSWSQ::getEfSearch),
+      InstanceMethod("setEfSearch", &IndexHNSWSQ::setEfSearch),
+      InstanceMethod("getCodeSize", &IndexHNSWSQ::getCodeSize),
+      InstanceMethod("getQType", &IndexHNSWSQ::getQType),
+      StaticMethod("fromBuffer", &IndexHNSWSQ::fromBuffer),
+      StaticMethod("readStream", &IndexHNSWSQ::readStream),
+      StaticMethod("read", &IndexHNSWSQ::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexHNSWPQ : public IndexBase<IndexHNSWPQ, faiss::IndexHNSWPQ, IndexType::IndexHNSWPQ>
+{
+public:
+  using IndexBase::IndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexHNSWPQ";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexHNSWPQ::getIndexType),
+      InstanceMethod("getDimension", &IndexHNSWPQ::getDimension),
+      InstanceMethod("getNTotal", &IndexHNSWPQ::getNTotal),
+      InstanceMethod("getIsTrained", &IndexHNSWPQ::getIsTrained),
+      InstanceMethod("getMetricType", &IndexHNSWPQ::getMetricType),
+      InstanceMethod("getMetricArg", &IndexHNSWPQ::getMetricArg),
+      InstanceMethod("getIds", &IndexHNSWPQ::getIds),
+      InstanceMethod("add", &IndexHNSWPQ::add),
+      InstanceMethod("addAsync", &IndexHNSWPQ::addAsync),
+      InstanceMethod("addWithIds", &IndexHNSWPQ::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexHNSWPQ::addWithIdsAsync),
+      InstanceMethod("train", &IndexHNSWPQ::train),
+      InstanceMethod("trainAsync", &IndexHNSWPQ::trainAsync),
+      InstanceMethod("search", &IndexHNSWPQ::search),
+      InstanceMethod("searchTyped", &IndexHNSWPQ::searchTyped),
+      InstanceMethod("searchInto", &IndexHNSWPQ::searchInto),
+      InstanceMethod("rangeSearch", &IndexHNSWPQ::rangeSearch),
+      InstanceMethod("searchAsync", &IndexHNSWPQ::searchAsync),
+      InstanceMethod("setBatching", &IndexHNSWPQ::setBatching),
+      InstanceMethod("getBatchingStats", &IndexHNSWPQ::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexHNSWPQ::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexHNSWPQ::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexHNSWPQ::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexHNSWPQ::setOnDiskInvertedLists),
+#endif // _MSC_VER
+      InstanceMethod("reconstruct", &IndexHNSWPQ::reconstruct),
+      InstanceMethod("reconstructBatch", &IndexHNSWPQ::reconstructBatch),
+      InstanceMethod("reset", &IndexHNSWPQ::reset),
+      InstanceMethod("dispose", &IndexHNSWPQ::dispose),
+      InstanceMethod("write", &IndexHNSWPQ::write),
+      InstanceMethod("mergeFrom", &IndexHNSWPQ::mergeFrom),
+      InstanceMethod("removeIds", &IndexHNSWPQ::removeIds),
+      InstanceMethod("toBuffer", &IndexHNSWPQ::toBuffer),
+      InstanceMethod("writeStream", &IndexHNSWPQ::writeStream),
+      InstanceMethod("toIDMap2", &IndexHNSWPQ::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexHNSWPQ::toRefineFlat),
+      InstanceMethod("toRefine", &IndexHNSWPQ::toRefine),
+      InstanceMethod("getKFactor", &IndexHNSWPQ::getKFactor),
+      InstanceMethod("setKFactor", &IndexHNSWPQ::setKFactor),
+      InstanceMethod("getEfConstruction", &IndexHNSWPQ::getEfConstruction),
+      InstanceMethod("setEfConstruction", &IndexHNSWPQ::setEfConstruction),
+      InstanceMethod("getEfSearch", &IndexHNSWPQ::getEfSearch),
+      InstanceMethod("setEfSearch", &IndexHNSWPQ::setEfSearch),
+      InstanceMethod("getCodeSize", &IndexHNSWPQ::getCodeSize),
+      InstanceMethod("getM", &IndexHNSWPQ::getM),
+      InstanceMethod("getNBits", &IndexHNSWPQ::getNBits),
+      StaticMethod("fromBuffer", &IndexHNSWPQ::fromBuffer),
+      StaticMethod("readStream", &IndexHNSWPQ::readStream),
+      StaticMethod("read", &IndexHNSWPQ::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
 
     exports.Set(CLASS_NAME, func);
     return exports;
@@ -210,9 +455,28 @@ public:
       InstanceMethod("getMetricArg", &IndexIVFFlat::getMetricArg),
       InstanceMethod("getIds", &IndexIVFFlat::getIds),
       InstanceMethod("add", &IndexIVFFlat::add),
+      InstanceMethod("addAsync", &IndexIVFFlat::addAsync),
       InstanceMethod("addWithIds", &IndexIVFFlat::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexIVFFlat::addWithIdsAsync),
       InstanceMethod("train", &IndexIVFFlat::train),
+      InstanceMethod("trainAsync", &IndexIVFFlat::trainAsync),
       InstanceMethod("search", &IndexIVFFlat::search),
+      InstanceMethod("searchTyped", &IndexIVFFlat::searchTyped),
+      InstanceMethod("searchInto", &IndexIVFFlat::searchInto),
+      InstanceMethod("rangeSearch", &IndexIVFFlat::rangeSearch),
+      InstanceMethod("searchAsync", &IndexIVFFlat::searchAsync),
+      InstanceMethod("setBatching", &IndexIVFFlat::setBatching),
+      InstanceMethod("getBatchingStats", &IndexIVFFlat::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexIVFFlat::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexIVFFlat::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexIVFFlat::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexIVFFlat::setOnDiskInvertedLists),
+#endif // _MSC_VER
       InstanceMethod("reconstruct", &IndexIVFFlat::reconstruct),
       InstanceMethod("reconstructBatch", &IndexIVFFlat::reconstructBatch),
       InstanceMethod("reset", &IndexIVFFlat::reset),
@@ -221,19 +485,629 @@ public:
       InstanceMethod("mergeFrom", &IndexIVFFlat::mergeFrom),
       InstanceMethod("removeIds", &IndexIVFFlat::removeIds),
       InstanceMethod("toBuffer", &IndexIVFFlat::toBuffer),
+      InstanceMethod("writeStream", &IndexIVFFlat::writeStream),
       InstanceMethod("toIDMap2", &IndexIVFFlat::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexIVFFlat::toRefineFlat),
+      InstanceMethod("toRefine", &IndexIVFFlat::toRefine),
+      InstanceMethod("getKFactor", &IndexIVFFlat::getKFactor),
+      InstanceMethod("setKFactor", &IndexIVFFlat::setKFactor),
       InstanceMethod("getNProbe", &IndexIVFFlat::getNProbe),
       InstanceMethod("setNProbe", &IndexIVFFlat::setNProbe),
       StaticMethod("fromBuffer", &IndexIVFFlat::fromBuffer),
+      StaticMethod("readStream", &IndexIVFFlat::readStream),
       StaticMethod("read", &IndexIVFFlat::read),
 #ifndef _MSC_VER
       StaticMethod("mergeOnDisk", &IndexIVFFlat::mergeOnDisk),
 #endif // _MSC_VER
+#ifndef _MSC_VER
+      StaticMethod("mergeOnDiskAsync", &IndexIVFFlat::mergeOnDiskAsync),
+#endif // _MSC_VER
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexIVFPQ : public IndexBase<IndexIVFPQ, faiss::IndexIVFPQ, IndexType::IndexIVFPQ>
+{
+public:
+  using IndexBase::IndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexIVFPQ";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexIVFPQ::getIndexType),
+      InstanceMethod("getDimension", &IndexIVFPQ::getDimension),
+      InstanceMethod("getNTotal", &IndexIVFPQ::getNTotal),
+      InstanceMethod("getIsTrained", &IndexIVFPQ::getIsTrained),
+      InstanceMethod("getMetricType", &IndexIVFPQ::getMetricType),
+      InstanceMethod("getMetricArg", &IndexIVFPQ::getMetricArg),
+      InstanceMethod("getIds", &IndexIVFPQ::getIds),
+      InstanceMethod("add", &IndexIVFPQ::add),
+      InstanceMethod("addAsync", &IndexIVFPQ::addAsync),
+      InstanceMethod("addWithIds", &IndexIVFPQ::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexIVFPQ::addWithIdsAsync),
+      InstanceMethod("train", &IndexIVFPQ::train),
+      InstanceMethod("trainAsync", &IndexIVFPQ::trainAsync),
+      InstanceMethod("search", &IndexIVFPQ::search),
+      InstanceMethod("searchTyped", &IndexIVFPQ::searchTyped),
+      InstanceMethod("searchInto", &IndexIVFPQ::searchInto),
+      InstanceMethod("rangeSearch", &IndexIVFPQ::rangeSearch),
+      InstanceMethod("searchAsync", &IndexIVFPQ::searchAsync),
+      InstanceMethod("setBatching", &IndexIVFPQ::setBatching),
+      InstanceMethod("getBatchingStats", &IndexIVFPQ::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexIVFPQ::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexIVFPQ::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexIVFPQ::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexIVFPQ::setOnDiskInvertedLists),
+#endif // _MSC_VER
+      InstanceMethod("reconstruct", &IndexIVFPQ::reconstruct),
+      InstanceMethod("reconstructBatch", &IndexIVFPQ::reconstructBatch),
+      InstanceMethod("reset", &IndexIVFPQ::reset),
+      InstanceMethod("dispose", &IndexIVFPQ::dispose),
+      InstanceMethod("write", &IndexIVFPQ::write),
+      InstanceMethod("mergeFrom", &IndexIVFPQ::mergeFrom),
+      InstanceMethod("removeIds", &IndexIVFPQ::removeIds),
+      InstanceMethod("toBuffer", &IndexIVFPQ::toBuffer),
+      InstanceMethod("writeStream", &IndexIVFPQ::writeStream),
+      InstanceMethod("toIDMap2", &IndexIVFPQ::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexIVFPQ::toRefineFlat),
+      InstanceMethod("toRefine", &IndexIVFPQ::toRefine),
+      InstanceMethod("getKFactor", &IndexIVFPQ::getKFactor),
+      InstanceMethod("setKFactor", &IndexIVFPQ::setKFactor),
+      InstanceMethod("getNProbe", &IndexIVFPQ::getNProbe),
+      InstanceMethod("setNProbe", &IndexIVFPQ::setNProbe),
+      InstanceMethod("getCodeSize", &IndexIVFPQ::getCodeSize),
+      InstanceMethod("getM", &IndexIVFPQ::getM),
+      InstanceMethod("getNBits", &IndexIVFPQ::getNBits),
+      InstanceMethod("getByResidual", &IndexIVFPQ::getByResidual),
+      InstanceMethod("setByResidual", &IndexIVFPQ::setByResidual),
+      InstanceMethod("getUsePrecomputedTable", &IndexIVFPQ::getUsePrecomputedTable),
+      InstanceMethod("setUsePrecomputedTable", &IndexIVFPQ::setUsePrecomputedTable),
+      StaticMethod("fromBuffer", &IndexIVFPQ::fromBuffer),
+      StaticMethod("readStream", &IndexIVFPQ::readStream),
+      StaticMethod("read", &IndexIVFPQ::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexIVFScalarQuantizer : public IndexBase<IndexIVFScalarQuantizer, faiss::IndexIVFScalarQuantizer, IndexType::IndexIVFScalarQuantizer>
+{
+public:
+  using IndexBase::IndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexIVFScalarQuantizer";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexIVFScalarQuantizer::getIndexType),
+      InstanceMethod("getDimension", &IndexIVFScalarQuantizer::getDimension),
+      InstanceMethod("getNTotal", &IndexIVFScalarQuantizer::getNTotal),
+      InstanceMethod("getIsTrained", &IndexIVFScalarQuantizer::getIsTrained),
+      InstanceMethod("getMetricType", &IndexIVFScalarQuantizer::getMetricType),
+      InstanceMethod("getMetricArg", &IndexIVFScalarQuantizer::getMetricArg),
+      InstanceMethod("getIds", &IndexIVFScalarQuantizer::getIds),
+      InstanceMethod("add", &IndexIVFScalarQuantizer::add),
+      InstanceMethod("addAsync", &IndexIVFScalarQuantizer::addAsync),
+      InstanceMethod("addWithIds", &IndexIVFScalarQuantizer::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexIVFScalarQuantizer::addWithIdsAsync),
+      InstanceMethod("train", &IndexIVFScalarQuantizer::train),
+      InstanceMethod("trainAsync", &IndexIVFScalarQuantizer::trainAsync),
+      InstanceMethod("search", &IndexIVFScalarQuantizer::search),
+      InstanceMethod("searchTyped", &IndexIVFScalarQuantizer::searchTyped),
+      InstanceMethod("searchInto", &IndexIVFScalarQuantizer::searchInto),
+      InstanceMethod("rangeSearch", &IndexIVFScalarQuantizer::rangeSearch),
+      InstanceMethod("searchAsync", &IndexIVFScalarQuantizer::searchAsync),
+      InstanceMethod("setBatching", &IndexIVFScalarQuantizer::setBatching),
+      InstanceMethod("getBatchingStats", &IndexIVFScalarQuantizer::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexIVFScalarQuantizer::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexIVFScalarQuantizer::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexIVFScalarQuantizer::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexIVFScalarQuantizer::setOnDiskInvertedLists),
+#endif // _MSC_VER
+      InstanceMethod("reconstruct", &IndexIVFScalarQuantizer::reconstruct),
+      InstanceMethod("reconstructBatch", &IndexIVFScalarQuantizer::reconstructBatch),
+      InstanceMethod("reset", &IndexIVFScalarQuantizer::reset),
+      InstanceMethod("dispose", &IndexIVFScalarQuantizer::dispose),
+      InstanceMethod("write", &IndexIVFScalarQuantizer::write),
+      InstanceMethod("mergeFrom", &IndexIVFScalarQuantizer::mergeFrom),
+      InstanceMethod("removeIds", &IndexIVFScalarQuantizer::removeIds),
+      InstanceMethod("toBuffer", &IndexIVFScalarQuantizer::toBuffer),
+      InstanceMethod("writeStream", &IndexIVFScalarQuantizer::writeStream),
+      InstanceMethod("toIDMap2", &IndexIVFScalarQuantizer::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexIVFScalarQuantizer::toRefineFlat),
+      InstanceMethod("toRefine", &IndexIVFScalarQuantizer::toRefine),
+      InstanceMethod("getKFactor", &IndexIVFScalarQuantizer::getKFactor),
+      InstanceMethod("setKFactor", &IndexIVFScalarQuantizer::setKFactor),
+      InstanceMethod("getNProbe", &IndexIVFScalarQuantizer::getNProbe),
+      InstanceMethod("setNProbe", &IndexIVFScalarQuantizer::setNProbe),
+      InstanceMethod("getCodeSize", &IndexIVFScalarQuantizer::getCodeSize),
+      InstanceMethod("getQType", &IndexIVFScalarQuantizer::getQType),
+      InstanceMethod("getByResidual", &IndexIVFScalarQuantizer::getByResidual),
+      InstanceMethod("setByResidual", &IndexIVFScalarQuantizer::setByResidual),
+      StaticMethod("fromBuffer", &IndexIVFScalarQuantizer::fromBuffer),
+      StaticMethod("readStream", &IndexIVFScalarQuantizer::readStream),
+      StaticMethod("read", &IndexIVFScalarQuantizer::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexPQFastScan : public IndexBase<IndexPQFastScan, faiss::IndexPQFastScan, IndexType::IndexPQFastScan>
+{
+public:
+  using IndexBase::IndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexPQFastScan";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexPQFastScan::getIndexType),
+      InstanceMethod("getDimension", &IndexPQFastScan::getDimension),
+      InstanceMethod("getNTotal", &IndexPQFastScan::getNTotal),
+      InstanceMethod("getIsTrained", &IndexPQFastScan::getIsTrained),
+      InstanceMethod("getMetricType", &IndexPQFastScan::getMetricType),
+      InstanceMethod("getMetricArg", &IndexPQFastScan::getMetricArg),
+      InstanceMethod("getIds", &IndexPQFastScan::getIds),
+      InstanceMethod("add", &IndexPQFastScan::add),
+      InstanceMethod("addAsync", &IndexPQFastScan::addAsync),
+      InstanceMethod("addWithIds", &IndexPQFastScan::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexPQFastScan::addWithIdsAsync),
+      InstanceMethod("train", &IndexPQFastScan::train),
+      InstanceMethod("trainAsync", &IndexPQFastScan::trainAsync),
+      InstanceMethod("search", &IndexPQFastScan::search),
+      InstanceMethod("searchTyped", &IndexPQFastScan::searchTyped),
+      InstanceMethod("searchInto", &IndexPQFastScan::searchInto),
+      InstanceMethod("rangeSearch", &IndexPQFastScan::rangeSearch),
+      InstanceMethod("searchAsync", &IndexPQFastScan::searchAsync),
+      InstanceMethod("setBatching", &IndexPQFastScan::setBatching),
+      InstanceMethod("getBatchingStats", &IndexPQFastScan::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexPQFastScan::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexPQFastScan::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexPQFastScan::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexPQFastScan::setOnDiskInvertedLists),
+#endif // _MSC_VER
+      InstanceMethod("reconstruct", &IndexPQFastScan::reconstruct),
+      InstanceMethod("reconstructBatch", &IndexPQFastScan::reconstructBatch),
+      InstanceMethod("reset", &IndexPQFastScan::reset),
+      InstanceMethod("dispose", &IndexPQFastScan::dispose),
+      InstanceMethod("write", &IndexPQFastScan::write),
+      InstanceMethod("mergeFrom", &IndexPQFastScan::mergeFrom),
+      InstanceMethod("removeIds", &IndexPQFastScan::removeIds),
+      InstanceMethod("toBuffer", &IndexPQFastScan::toBuffer),
+      InstanceMethod("writeStream", &IndexPQFastScan::writeStream),
+      InstanceMethod("toIDMap2", &IndexPQFastScan::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexPQFastScan::toRefineFlat),
+      InstanceMethod("toRefine", &IndexPQFastScan::toRefine),
+      InstanceMethod("getKFactor", &IndexPQFastScan::getKFactor),
+      InstanceMethod("setKFactor", &IndexPQFastScan::setKFactor),
+      InstanceMethod("getM", &IndexPQFastScan::getM),
+      InstanceMethod("getNBits", &IndexPQFastScan::getNBits),
+      InstanceMethod("getBbs", &IndexPQFastScan::getBbs),
+      InstanceMethod("getImplem", &IndexPQFastScan::getImplem),
+      InstanceMethod("setImplem", &IndexPQFastScan::setImplem),
+      StaticMethod("fromBuffer", &IndexPQFastScan::fromBuffer),
+      StaticMethod("readStream", &IndexPQFastScan::readStream),
+      StaticMethod("read", &IndexPQFastScan::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexIVFPQFastScan : public IndexBase<IndexIVFPQFastScan, faiss::IndexIVFPQFastScan, IndexType::IndexIVFPQFastScan>
+{
+public:
+  using IndexBase::IndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexIVFPQFastScan";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexIVFPQFastScan::getIndexType),
+      InstanceMethod("getDimension", &IndexIVFPQFastScan::getDimension),
+      InstanceMethod("getNTotal", &IndexIVFPQFastScan::getNTotal),
+      InstanceMethod("getIsTrained", &IndexIVFPQFastScan::getIsTrained),
+      InstanceMethod("getMetricType", &IndexIVFPQFastScan::getMetricType),
+      InstanceMethod("getMetricArg", &IndexIVFPQFastScan::getMetricArg),
+      InstanceMethod("getIds", &IndexIVFPQFastScan::getIds),
+      InstanceMethod("add", &IndexIVFPQFastScan::add),
+      InstanceMethod("addAsync", &IndexIVFPQFastScan::addAsync),
+      InstanceMethod("addWithIds", &IndexIVFPQFastScan::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexIVFPQFastScan::addWithIdsAsync),
+      InstanceMethod("train", &IndexIVFPQFastScan::train),
+      InstanceMethod("trainAsync", &IndexIVFPQFastScan::trainAsync),
+      InstanceMethod("search", &IndexIVFPQFastScan::search),
+      InstanceMethod("searchTyped", &IndexIVFPQFastScan::searchTyped),
+      InstanceMethod("searchInto", &IndexIVFPQFastScan::searchInto),
+      InstanceMethod("rangeSearch", &IndexIVFPQFastScan::rangeSearch),
+      InstanceMethod("searchAsync", &IndexIVFPQFastScan::searchAsync),
+      InstanceMethod("setBatching", &IndexIVFPQFastScan::setBatching),
+      InstanceMethod("getBatchingStats", &IndexIVFPQFastScan::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexIVFPQFastScan::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexIVFPQFastScan::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexIVFPQFastScan::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexIVFPQFastScan::setOnDiskInvertedLists),
+#endif // _MSC_VER
+      InstanceMethod("reconstruct", &IndexIVFPQFastScan::reconstruct),
+      InstanceMethod("reconstructBatch", &IndexIVFPQFastScan::reconstructBatch),
+      InstanceMethod("reset", &IndexIVFPQFastScan::reset),
+      InstanceMethod("dispose", &IndexIVFPQFastScan::dispose),
+      InstanceMethod("write", &IndexIVFPQFastScan::write),
+      InstanceMethod("mergeFrom", &IndexIVFPQFastScan::mergeFrom),
+      InstanceMethod("removeIds", &IndexIVFPQFastScan::removeIds),
+      InstanceMethod("toBuffer", &IndexIVFPQFastScan::toBuffer),
+      InstanceMethod("writeStream", &IndexIVFPQFastScan::writeStream),
+      InstanceMethod("toIDMap2", &IndexIVFPQFastScan::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexIVFPQFastScan::toRefineFlat),
+      InstanceMethod("toRefine", &IndexIVFPQFastScan::toRefine),
+      InstanceMethod("getKFactor", &IndexIVFPQFastScan::getKFactor),
+      InstanceMethod("setKFactor", &IndexIVFPQFastScan::setKFactor),
+      InstanceMethod("getNProbe", &IndexIVFPQFastScan::getNProbe),
+      InstanceMethod("setNProbe", &IndexIVFPQFastScan::setNProbe),
+      InstanceMethod("getM", &IndexIVFPQFastScan::getM),
+      InstanceMethod("getNBits", &IndexIVFPQFastScan::getNBits),
+      InstanceMethod("getBbs", &IndexIVFPQFastScan::getBbs),
+      InstanceMethod("getImplem", &IndexIVFPQFastScan::getImplem),
+      InstanceMethod("setImplem", &IndexIVFPQFastScan::setImplem),
+      StaticMethod("fromBuffer", &IndexIVFPQFastScan::fromBuffer),
+      StaticMethod("readStream", &IndexIVFPQFastScan::readStream),
+      StaticMethod("read", &IndexIVFPQFastScan::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexShards : public IndexBase<IndexShards, faiss::IndexShards, IndexType::IndexShards>
+{
+public:
+  using IndexBase::IndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexShards";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexShards::getIndexType),
+      InstanceMethod("getDimension", &IndexShards::getDimension),
+      InstanceMethod("getNTotal", &IndexShards::getNTotal),
+      InstanceMethod("getIsTrained", &IndexShards::getIsTrained),
+      InstanceMethod("getMetricType", &IndexShards::getMetricType),
+      InstanceMethod("getMetricArg", &IndexShards::getMetricArg),
+      InstanceMethod("getIds", &IndexShards::getIds),
+      InstanceMethod("add", &IndexShards::add),
+      InstanceMethod("addAsync", &IndexShards::addAsync),
+      InstanceMethod("addWithIds", &IndexShards::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexShards::addWithIdsAsync),
+      InstanceMethod("train", &IndexShards::train),
+      InstanceMethod("trainAsync", &IndexShards::trainAsync),
+      InstanceMethod("search", &IndexShards::search),
+      InstanceMethod("searchTyped", &IndexShards::searchTyped),
+      InstanceMethod("searchInto", &IndexShards::searchInto),
+      InstanceMethod("rangeSearch", &IndexShards::rangeSearch),
+      InstanceMethod("searchAsync", &IndexShards::searchAsync),
+      InstanceMethod("setBatching", &IndexShards::setBatching),
+      InstanceMethod("getBatchingStats", &IndexShards::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexShards::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexShards::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexShards::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexShards::setOnDiskInvertedLists),
+#endif // _MSC_VER
+      InstanceMethod("reconstruct", &IndexShards::reconstruct),
+      InstanceMethod("reconstructBatch", &IndexShards::reconstructBatch),
+      InstanceMethod("reset", &IndexShards::reset),
+      InstanceMethod("dispose", &IndexShards::dispose),
+      InstanceMethod("write", &IndexShards::write),
+      InstanceMethod("mergeFrom", &IndexShards::mergeFrom),
+      InstanceMethod("removeIds", &IndexShards::removeIds),
+      InstanceMethod("toBuffer", &IndexShards::toBuffer),
+      InstanceMethod("writeStream", &IndexShards::writeStream),
+      InstanceMethod("toIDMap2", &IndexShards::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexShards::toRefineFlat),
+      InstanceMethod("toRefine", &IndexShards::toRefine),
+      InstanceMethod("getKFactor", &IndexShards::getKFactor),
+      InstanceMethod("setKFactor", &IndexShards::setKFactor),
+      InstanceMethod("addShard", &IndexShards::addShard),
+      InstanceMethod("getNShards", &IndexShards::getNShards),
+      StaticMethod("fromBuffer", &IndexShards::fromBuffer),
+      StaticMethod("readStream", &IndexShards::readStream),
+      StaticMethod("read", &IndexShards::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexReplicas : public IndexBase<IndexReplicas, faiss::IndexReplicas, IndexType::IndexReplicas>
+{
+public:
+  using IndexBase::IndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexReplicas";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexReplicas::getIndexType),
+      InstanceMethod("getDimension", &IndexReplicas::getDimension),
+      InstanceMethod("getNTotal", &IndexReplicas::getNTotal),
+      InstanceMethod("getIsTrained", &IndexReplicas::getIsTrained),
+      InstanceMethod("getMetricType", &IndexReplicas::getMetricType),
+      InstanceMethod("getMetricArg", &IndexReplicas::getMetricArg),
+      InstanceMethod("getIds", &IndexReplicas::getIds),
+      InstanceMethod("add", &IndexReplicas::add),
+      InstanceMethod("addAsync", &IndexReplicas::addAsync),
+      InstanceMethod("addWithIds", &IndexReplicas::addWithIds),
+      InstanceMethod("addWithIdsAsync", &IndexReplicas::addWithIdsAsync),
+      InstanceMethod("train", &IndexReplicas::train),
+      InstanceMethod("trainAsync", &IndexReplicas::trainAsync),
+      InstanceMethod("search", &IndexReplicas::search),
+      InstanceMethod("searchTyped", &IndexReplicas::searchTyped),
+      InstanceMethod("searchInto", &IndexReplicas::searchInto),
+      InstanceMethod("rangeSearch", &IndexReplicas::rangeSearch),
+      InstanceMethod("searchAsync", &IndexReplicas::searchAsync),
+      InstanceMethod("setBatching", &IndexReplicas::setBatching),
+      InstanceMethod("getBatchingStats", &IndexReplicas::getBatchingStats),
+      InstanceMethod("getMetrics", &IndexReplicas::getMetrics),
+#ifndef _MSC_VER
+      InstanceMethod("warmup", &IndexReplicas::warmup),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setMadvise", &IndexReplicas::setMadvise),
+#endif // _MSC_VER
+#ifndef _MSC_VER
+      InstanceMethod("setOnDiskInvertedLists", &IndexReplicas::setOnDiskInvertedLists),
+#endif // _MSC_VER
+      InstanceMethod("reconstruct", &IndexReplicas::reconstruct),
+      InstanceMethod("reconstructBatch", &IndexReplicas::reconstructBatch),
+      InstanceMethod("reset", &IndexReplicas::reset),
+      InstanceMethod("dispose", &IndexReplicas::dispose),
+      InstanceMethod("write", &IndexReplicas::write),
+      InstanceMethod("mergeFrom", &IndexReplicas::mergeFrom),
+      InstanceMethod("removeIds", &IndexReplicas::removeIds),
+      InstanceMethod("toBuffer", &IndexReplicas::toBuffer),
+      InstanceMethod("writeStream", &IndexReplicas::writeStream),
+      InstanceMethod("toIDMap2", &IndexReplicas::toIDMap2),
+      InstanceMethod("toRefineFlat", &IndexReplicas::toRefineFlat),
+      InstanceMethod("toRefine", &IndexReplicas::toRefine),
+      InstanceMethod("getKFactor", &IndexReplicas::getKFactor),
+      InstanceMethod("setKFactor", &IndexReplicas::setKFactor),
+      InstanceMethod("addReplica", &IndexReplicas::addReplica),
+      InstanceMethod("getNReplicas", &IndexReplicas::getNReplicas),
+      StaticMethod("fromBuffer", &IndexReplicas::fromBuffer),
+      StaticMethod("readStream", &IndexReplicas::readStream),
+      StaticMethod("read", &IndexReplicas::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexBinary : public BinaryIndexBase<IndexBinary, faiss::IndexBinaryFlat, IndexType::IndexBinary>
+{
+public:
+  using BinaryIndexBase::BinaryIndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexBinary";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexBinary::getIndexType),
+      InstanceMethod("getDimension", &IndexBinary::getDimension),
+      InstanceMethod("getCodeSize", &IndexBinary::getCodeSize),
+      InstanceMethod("getNTotal", &IndexBinary::getNTotal),
+      InstanceMethod("getIsTrained", &IndexBinary::getIsTrained),
+      InstanceMethod("add", &IndexBinary::add),
+      InstanceMethod("addWithIds", &IndexBinary::addWithIds),
+      InstanceMethod("train", &IndexBinary::train),
+      InstanceMethod("search", &IndexBinary::search),
+      InstanceMethod("searchAsync", &IndexBinary::searchAsync),
+      InstanceMethod("reconstruct", &IndexBinary::reconstruct),
+      InstanceMethod("removeIds", &IndexBinary::removeIds),
+      InstanceMethod("reset", &IndexBinary::reset),
+      InstanceMethod("dispose", &IndexBinary::dispose),
+      InstanceMethod("write", &IndexBinary::write),
+      InstanceMethod("toBuffer", &IndexBinary::toBuffer),
+      StaticMethod("fromBuffer", &IndexBinary::fromBuffer),
+      StaticMethod("read", &IndexBinary::read),
+      StaticMethod("fromFactory", &IndexBinary::fromFactory),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexBinaryFlat : public BinaryIndexBase<IndexBinaryFlat, faiss::IndexBinaryFlat, IndexType::IndexBinaryFlat>
+{
+public:
+  using BinaryIndexBase::BinaryIndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexBinaryFlat";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexBinaryFlat::getIndexType),
+      InstanceMethod("getDimension", &IndexBinaryFlat::getDimension),
+      InstanceMethod("getCodeSize", &IndexBinaryFlat::getCodeSize),
+      InstanceMethod("getNTotal", &IndexBinaryFlat::getNTotal),
+      InstanceMethod("getIsTrained", &IndexBinaryFlat::getIsTrained),
+      InstanceMethod("add", &IndexBinaryFlat::add),
+      InstanceMethod("addWithIds", &IndexBinaryFlat::addWithIds),
+      InstanceMethod("train", &IndexBinaryFlat::train),
+      InstanceMethod("search", &IndexBinaryFlat::search),
+      InstanceMethod("searchAsync", &IndexBinaryFlat::searchAsync),
+      InstanceMethod("reconstruct", &IndexBinaryFlat::reconstruct),
+      InstanceMethod("removeIds", &IndexBinaryFlat::removeIds),
+      InstanceMethod("reset", &IndexBinaryFlat::reset),
+      InstanceMethod("dispose", &IndexBinaryFlat::dispose),
+      InstanceMethod("write", &IndexBinaryFlat::write),
+      InstanceMethod("toBuffer", &IndexBinaryFlat::toBuffer),
+      StaticMethod("fromBuffer", &IndexBinaryFlat::fromBuffer),
+      StaticMethod("read", &IndexBinaryFlat::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexBinaryHNSW : public BinaryIndexBase<IndexBinaryHNSW, faiss::IndexBinaryHNSW, IndexType::IndexBinaryHNSW>
+{
+public:
+  using BinaryIndexBase::BinaryIndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexBinaryHNSW";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexBinaryHNSW::getIndexType),
+      InstanceMethod("getDimension", &IndexBinaryHNSW::getDimension),
+      InstanceMethod("getCodeSize", &IndexBinaryHNSW::getCodeSize),
+      InstanceMethod("getNTotal", &IndexBinaryHNSW::getNTotal),
+      InstanceMethod("getIsTrained", &IndexBinaryHNSW::getIsTrained),
+      InstanceMethod("add", &IndexBinaryHNSW::add),
+      InstanceMethod("addWithIds", &IndexBinaryHNSW::addWithIds),
+      InstanceMethod("train", &IndexBinaryHNSW::train),
+      InstanceMethod("search", &IndexBinaryHNSW::search),
+      InstanceMethod("searchAsync", &IndexBinaryHNSW::searchAsync),
+      InstanceMethod("reconstruct", &IndexBinaryHNSW::reconstruct),
+      InstanceMethod("removeIds", &IndexBinaryHNSW::removeIds),
+      InstanceMethod("reset", &IndexBinaryHNSW::reset),
+      InstanceMethod("dispose", &IndexBinaryHNSW::dispose),
+      InstanceMethod("write", &IndexBinaryHNSW::write),
+      InstanceMethod("toBuffer", &IndexBinaryHNSW::toBuffer),
+      InstanceMethod("getEfConstruction", &IndexBinaryHNSW::getEfConstruction),
+      InstanceMethod("setEfConstruction", &IndexBinaryHNSW::setEfConstruction),
+      InstanceMethod("getEfSearch", &IndexBinaryHNSW::getEfSearch),
+      InstanceMethod("setEfSearch", &IndexBinaryHNSW::setEfSearch),
+      StaticMethod("fromBuffer", &IndexBinaryHNSW::fromBuffer),
+      StaticMethod("read", &IndexBinaryHNSW::read),
+    });
+    // clang-format on
+
+    setConstructor(func);
+
+    exports.Set(CLASS_NAME, func);
+    return exports;
+  }
+};
+
+class IndexBinaryIVF : public BinaryIndexBase<IndexBinaryIVF, faiss::IndexBinaryIVF, IndexType::IndexBinaryIVF>
+{
+public:
+  using BinaryIndexBase::BinaryIndexBase;
+
+  static constexpr const char *CLASS_NAME = "IndexBinaryIVF";
+
+  static Napi::Object Init(Napi::Env env, Napi::Object exports)
+  {
+    // clang-format off
+    auto func = DefineClass(env, CLASS_NAME, {
+      InstanceMethod("getIndexType", &IndexBinaryIVF::getIndexType),
+      InstanceMethod("getDimension", &IndexBinaryIVF::getDimension),
+      InstanceMethod("getCodeSize", &IndexBinaryIVF::getCodeSize),
+      InstanceMethod("getNTotal", &IndexBinaryIVF::getNTotal),
+      InstanceMethod("getIsTrained", &IndexBinaryIVF::getIsTrained),
+      InstanceMethod("add", &IndexBinaryIVF::add),
+      InstanceMethod("addWithIds", &IndexBinaryIVF::addWithIds),
+      InstanceMethod("train", &IndexBinaryIVF::train),
+      InstanceMethod("search", &IndexBinaryIVF::search),
+      InstanceMethod("searchAsync", &IndexBinaryIVF::searchAsync),
+      InstanceMethod("reconstruct", &IndexBinaryIVF::reconstruct),
+      InstanceMethod("removeIds", &IndexBinaryIVF::removeIds),
+      InstanceMethod("reset", &IndexBinaryIVF::reset),
+      InstanceMethod("dispose", &IndexBinaryIVF::dispose),
+      InstanceMethod("write", &IndexBinaryIVF::write),
+      InstanceMethod("toBuffer", &IndexBinaryIVF::toBuffer),
+      InstanceMethod("getNProbe", &IndexBinaryIVF::getNProbe),
+      InstanceMethod("setNProbe", &IndexBinaryIVF::setNProbe),
+      StaticMethod("fromBuffer", &IndexBinaryIVF::fromBuffer),
+      StaticMethod("read", &IndexBinaryIVF::read),
     });
     // clang-format on
 
-    constructor = new Napi::FunctionReference();
-    *constructor = Napi::Persistent(func);
+    setConstructor(func);
 
     exports.Set(CLASS_NAME, func);
     return exports;
@@ -246,7 +1120,23 @@ Napi::Object Init(Napi::Env env, Napi::Object exports)
   IndexFlatL2::Init(env, exports);
   IndexFlatIP::Init(env, exports);
   IndexHNSW::Init(env, exports);
+  IndexHNSWSQ::Init(env, exports);
+  IndexHNSWPQ::Init(env, exports);
   IndexIVFFlat::Init(env, exports);
+  IndexIVFPQ::Init(env, exports);
+  IndexIVFScalarQuantizer::Init(env, exports);
+  IndexPQFastScan::Init(env, exports);
+  IndexIVFPQFastScan::Init(env, exports);
+  IndexShards::Init(env, exports);
+  IndexReplicas::Init(env, exports);
+  IndexBinary::Init(env, exports);
+  IndexBinaryFlat::Init(env, exports);
+  IndexBinaryHNSW::Init(env, exports);
+  IndexBinaryIVF::Init(env, exports);
+  exports.Set("setNumThreads", Napi::Function::New(env, setNumThreads, "setNumThreads"));
+  exports.Set("getNumThreads", Napi::Function::New(env, getNumThreads, "getNumThreads"));
+  exports.Set("getSearchStats", Napi::Function::New(env, getSearchStats, "getSearchStats"));
+  exports.Set("resetSearchStats", Napi::Function::New(env, resetSearchStats, "resetSearchStats"));
 
   return exports;
 }
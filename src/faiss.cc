@@ -1,9 +1,30 @@
 #include <napi.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
 #include <cstdio>
+#include <cstdint>
 #include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <random>
+#include <shared_mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <faiss/IndexBinaryFlat.h>
+#include <faiss/IndexBinaryHNSW.h>
+#include <faiss/IndexBinaryIVF.h>
 #include <faiss/IndexFlat.h>
 #include <faiss/index_io.h>
+#include <faiss/impl/AuxIndexStructures.h>
+#include <faiss/impl/FaissAssert.h>
 #include <faiss/impl/FaissException.h>
 #include <faiss/impl/io.h>
 #include <faiss/index_factory.h>
@@ -11,9 +32,21 @@
 #include <faiss/impl/IDSelector.h>
 #include <faiss/IndexHNSW.h>
 #include <faiss/IndexIVFFlat.h>
+#include <faiss/IndexIVFPQ.h>
+#include <faiss/IndexIVFPQFastScan.h>
+#include <faiss/IndexPQFastScan.h>
+#include <faiss/IndexRefine.h>
+#include <faiss/IndexReplicas.h>
+#include <faiss/IndexScalarQuantizer.h>
+#include <faiss/IndexShards.h>
 #include <faiss/IVFlib.h>
 #include <faiss/IndexIDMap.h>
 #include <faiss/invlists/OnDiskInvertedLists.h>
+#include <omp.h>
+#ifndef _MSC_VER
+#include <sys/mman.h>
+#include <unistd.h>
+#endif // _MSC_VER
 
 using namespace Napi;
 using idx_t = faiss::idx_t;
@@ -25,504 +58,5785 @@ enum class IndexType
   IndexFlatL2 = 11,
   IndexFlatIP = 12,
   IndexHNSW = 20,
+  IndexHNSWSQ = 21,
+  IndexHNSWPQ = 22,
   IndexIVF = 30,
   IndexIVFFlat = 31,
+  IndexIVFPQ = 32,
+  IndexIVFScalarQuantizer = 33,
+  IndexIVFPQFastScan = 34,
+  IndexPQ = 40,
+  IndexPQFastScan = 41,
+  IndexRefine = 50,
+  IndexShards = 70,
+  IndexReplicas = 71,
+  IndexBinary = 60,
+  IndexBinaryFlat = 61,
+  IndexBinaryHNSW = 62,
+  IndexBinaryIVF = 63,
 };
 
-template <class T, typename Y, IndexType IT>
-class IndexBase : public Napi::ObjectWrap<T>
+// Reader/writer lock guarding an index: searches share it while mutations are exclusive. Both sides
+// pass through a turnstile so that a waiting writer is not starved by a steady stream of searches.
+// The locks of indexes used in place by this one (shards, replicas, refine sources) can be linked:
+// they are then taken along with it, in the same mode, so that work through a parent index
+// excludes conflicting work on its parts. Their own links are flattened into the parent's list.
+class IndexMutex
 {
 public:
-  IndexBase(const Napi::CallbackInfo &info) : Napi::ObjectWrap<T>(info)
+  // One lock of a set taken by lockAll.
+  struct Part
   {
-    Napi::Env env = info.Env();
-
-    if constexpr (IT == IndexType::IndexHNSW)
-    { // HNSW constructor
-      if (info.Length() > 0 && info[0].IsNumber())
+    IndexMutex *mutex;
+    bool shared;
+  };
+
+  // Take a set of locks without holding any while blocking on one, as std::lock does: block on
+  // one, try the others, and start over from the first that fails. A part may be linked to several
+  // parents and sets may overlap in any order (e.g. two parents of one shard, or a merge of indexes
+  // sharing a quantizer), so no fixed order of the locks exists that all callers could follow.
+  static void lockAll(const std::vector<Part> &parts)
+  {
+    size_t first = 0;
+    while (true)
+    {
+      parts[first].mutex->lockSelf(parts[first].shared);
+      auto failed = parts.size();
+      for (size_t i = 0; i < parts.size() && failed == parts.size(); i++)
       {
-        auto d = info[0].As<Napi::Number>().Uint32Value();
-        auto m = 32;                                // faiss default
-        auto metric = faiss::MetricType::METRIC_L2; // faiss default
-        if (info.Length() > 1 && info[1].IsNumber())
+        if (i != first && !parts[i].mutex->tryLockSelf(parts[i].shared))
         {
-          m = info[1].As<Napi::Number>().Uint32Value();
-        }
-        if (info.Length() > 2 && info[2].IsNumber())
-        {
-          metric = static_cast<faiss::MetricType>(info[2].As<Napi::Number>().Uint32Value());
+          failed = i;
         }
-        index_ = std::unique_ptr<faiss::IndexHNSW>(new faiss::IndexHNSW(d, m, metric));
       }
-    }
-    else if constexpr (IT == IndexType::IndexIVFFlat)
-    { // IVFFlat constructor
-      if (info.Length() > 2 && info[0].IsObject() && info[1].IsNumber() && info[2].IsNumber())
+      if (failed == parts.size())
       {
-        Napi::Object quantizer = info[0].As<Napi::Object>();
-        T *quantizerInstance = Napi::ObjectWrap<T>::Unwrap(quantizer);
-
-        auto d = info[1].As<Napi::Number>().Uint32Value();
-        auto nlist = info[2].As<Napi::Number>().Uint32Value();
-        auto metric = faiss::MetricType::METRIC_L2; // faiss default
-        if (info.Length() > 3 && info[3].IsNumber())
+        return;
+      }
+      for (size_t i = 0; i < failed; i++)
+      {
+        if (i != first)
         {
-          metric = static_cast<faiss::MetricType>(info[3].As<Napi::Number>().Uint32Value());
+          parts[i].mutex->unlockSelf(parts[i].shared);
         }
-
-        index_ = std::unique_ptr<faiss::IndexIVFFlat>(new faiss::IndexIVFFlat(quantizerInstance->index_.get(), d, nlist, metric));
       }
+      parts[first].mutex->unlockSelf(parts[first].shared);
+      first = failed;
+      std::this_thread::yield();
     }
-    else if (info.Length() > 0 && info[0].IsNumber())
+  }
+
+  static void unlockAll(const std::vector<Part> &parts)
+  {
+    for (auto &part : parts)
     {
-      auto n = info[0].As<Napi::Number>().Uint32Value();
-      index_ = std::unique_ptr<Y>(new Y(n));
+      part.mutex->unlockSelf(part.shared);
     }
   }
 
-  static Napi::Value read(const Napi::CallbackInfo &info)
+  // This lock and the linked ones, to take in the given mode.
+  std::vector<Part> parts(bool shared)
   {
-    Napi::Env env = info.Env();
-
-    if (info.Length() != 1)
+    std::vector<Part> parts{{this, shared}};
+    for (auto linked : linked_)
     {
-      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
+      parts.push_back({linked, shared});
     }
-    if (!info[0].IsString())
+    return parts;
+  }
+
+  void lock()
+  {
+    if (linked_.empty())
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be a string.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      lockSelf(false);
+      return;
     }
+    lockAll(parts(false));
+  }
 
-    Napi::Object instance = T::constructor->New({});
-    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
-    std::string fname = info[0].As<Napi::String>().Utf8Value();
-
-    try
+  void unlock()
+  {
+    for (auto it = linked_.rbegin(); it != linked_.rend(); ++it)
     {
-      index->index_ = std::unique_ptr<faiss::Index>(dynamic_cast<faiss::Index *>(faiss::read_index(fname.c_str())));
+      (*it)->mutex_.unlock();
     }
-    catch (const faiss::FaissException &ex)
+    mutex_.unlock();
+  }
+
+  void lock_shared()
+  {
+    if (linked_.empty())
     {
-      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      lockSelf(true);
+      return;
     }
-
-    return instance;
+    lockAll(parts(true));
   }
 
-  static Napi::Value fromBuffer(const Napi::CallbackInfo &info)
+  void unlock_shared()
   {
-    Napi::Env env = info.Env();
+    for (auto it = linked_.rbegin(); it != linked_.rend(); ++it)
+    {
+      (*it)->mutex_.unlock_shared();
+    }
+    mutex_.unlock_shared();
+  }
 
-    if (info.Length() != 1)
+  // Does not queue behind a waiting writer, so it never blocks.
+  bool try_lock_shared()
+  {
+    if (!mutex_.try_lock_shared())
     {
-      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
+      return false;
     }
-    if (!info[0].IsBuffer())
+    for (size_t i = 0; i < linked_.size(); i++)
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be a buffer.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      if (!linked_[i]->mutex_.try_lock_shared())
+      {
+        while (i-- > 0)
+        {
+          linked_[i]->mutex_.unlock_shared();
+        }
+        mutex_.unlock_shared();
+        return false;
+      }
     }
+    return true;
+  }
 
-    Napi::Object instance = T::constructor->New({});
-    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+  // Whether locking this also locks `other`.
+  bool covers(const IndexMutex *other) const
+  {
+    return other == this || std::find(linked_.begin(), linked_.end(), other) != linked_.end();
+  }
 
-    auto buffer = Napi::Buffer<uint8_t>::Copy(env, info[0].As<Napi::Buffer<uint8_t>>().Data(), info[0].As<Napi::Buffer<uint8_t>>().Length());
-    faiss::VectorIOReader *reader = new faiss::VectorIOReader();
-    reader->data = std::vector<uint8_t>(buffer.Data(), buffer.Data() + buffer.Length());
+  // Whether locking this and `other` would take some lock twice.
+  bool overlaps(const IndexMutex *other) const
+  {
+    return covers(other) || std::any_of(other->linked_.begin(), other->linked_.end(), [&](const IndexMutex *mutex)
+                                        { return covers(mutex); });
+  }
 
-    try
-    {
-      index->index_ = std::unique_ptr<faiss::Index>(dynamic_cast<faiss::Index *>(faiss::read_index(reader)));
-    }
-    catch (const faiss::FaissException &ex)
+  // Link `other` and the locks linked to it, which must not overlap this. Both must be locked
+  // exclusively, and the lock of `other` released by its owner: the next unlock() releases it.
+  void link(IndexMutex *other)
+  {
+    linked_.push_back(other);
+    linked_.insert(linked_.end(), other->linked_.begin(), other->linked_.end());
+  }
+
+  // Count a writeStream holding this lock and the linked ones, see IndexBase::readLock. The links
+  // can't change meanwhile: that takes this lock exclusively, which fails on the JS thread.
+  void addStreams(int n)
+  {
+    streams_ += n;
+    for (auto linked : linked_)
     {
-      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      linked->streams_ += n;
     }
+  }
 
-    return instance;
+  // Whether a writeStream holds this lock or a linked one.
+  bool streaming() const
+  {
+    return streams_ > 0 || std::any_of(linked_.begin(), linked_.end(), [](const IndexMutex *mutex)
+                                       { return mutex->streams_ > 0; });
   }
 
-  static Napi::Value fromFactory(const Napi::CallbackInfo &info)
+  // Unlink every lock. Must be called with this locked exclusively: linked locks are released.
+  void unlinkAll()
   {
-    Napi::Env env = info.Env();
+    for (auto it = linked_.rbegin(); it != linked_.rend(); ++it)
+    {
+      (*it)->mutex_.unlock();
+    }
+    linked_.clear();
+  }
 
-    if (info.Length() < 2)
+private:
+  void lockSelf(bool shared)
+  {
+    std::lock_guard<std::mutex> turnstile(turnstile_);
+    if (shared)
     {
-      Napi::Error::New(env, "Expected 2 or 3 arguments, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
+      mutex_.lock_shared();
     }
-    if (!info[0].IsNumber())
+    else
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be a number.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      mutex_.lock();
     }
-    if (!info[1].IsString())
+  }
+
+  // Does not queue behind a waiting writer.
+  bool tryLockSelf(bool shared)
+  {
+    return shared ? mutex_.try_lock_shared() : mutex_.try_lock();
+  }
+
+  void unlockSelf(bool shared)
+  {
+    if (shared)
     {
-      Napi::TypeError::New(env, "Invalid the second argument type, must be a string.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      mutex_.unlock_shared();
+    }
+    else
+    {
+      mutex_.unlock();
     }
+  }
 
-    auto metric = faiss::MetricType::METRIC_L2;
-    if (info[2].IsNumber())
+  std::mutex turnstile_;
+  std::shared_mutex mutex_;
+  // only changed with mutex_ held exclusively, read with it held
+  std::vector<IndexMutex *> linked_;
+  std::atomic<int> streams_{0};
+};
+
+// A JS index used in place by another one: the reference keeps it alive, and `parents` counts
+// the indexes using it, which it can't be disposed under. Shared with the index, whose JS object
+// may be finalized first at exit.
+struct SubIndexRef
+{
+  SubIndexRef(Napi::ObjectReference &&ref, std::shared_ptr<std::atomic<int>> parents) : ref(std::move(ref)), parents(std::move(parents))
+  {
+    ++*this->parents;
+  }
+  SubIndexRef(const SubIndexRef &) = delete;
+  SubIndexRef(SubIndexRef &&) = default;
+  ~SubIndexRef()
+  {
+    if (parents)
     {
-      metric = static_cast<faiss::MetricType>(info[2].As<Napi::Number>().Uint32Value());
+      --*parents;
     }
+  }
 
-    Napi::Object instance = T::constructor->New({});
-    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+  Napi::ObjectReference ref;
+  std::shared_ptr<std::atomic<int>> parents;
+};
 
-    const uint32_t d = info[0].As<Napi::Number>().Uint32Value();
-    std::string description = info[1].As<Napi::String>().Utf8Value();
+// OpenMP thread count used by faiss calls, set with setNumThreads; 0 for the OpenMP default.
+static std::atomic<int> numThreads{0};
+static const int defaultNumThreads = omp_get_max_threads();
 
-    try
+// omp_set_num_threads only applies to the calling thread, so every faiss call made from a worker
+// thread runs inside this scope: it applies a per-call thread budget, or else the process-wide
+// setting, and restores the thread's previous value afterwards.
+class OmpThreadsScope
+{
+public:
+  explicit OmpThreadsScope(int threads = 0) : previous_(omp_get_max_threads())
+  {
+    if (threads <= 0)
     {
-      index->index_ = std::unique_ptr<faiss::Index>(dynamic_cast<faiss::Index *>(faiss::index_factory(d, description.c_str(), metric)));
+      threads = numThreads;
     }
-    catch (const faiss::FaissException &ex)
+    if (threads > 0)
     {
-      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      omp_set_num_threads(threads);
     }
+  }
 
-    return instance;
+  ~OmpThreadsScope()
+  {
+    omp_set_num_threads(previous_);
   }
 
-#ifndef _MSC_VER
-  static Napi::Value mergeOnDisk(const Napi::CallbackInfo &info)
+private:
+  int previous_;
+};
+
+static Napi::Value setNumThreads(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  if (info.Length() != 1)
   {
-    Napi::Env env = info.Env();
+    Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+        .ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
+  if (!info[0].IsNumber() || info[0].As<Napi::Number>().Int32Value() < 0)
+  {
+    Napi::TypeError::New(env, "Invalid the first argument type, must be a non-negative Number.").ThrowAsJavaScriptException();
+    return env.Undefined();
+  }
 
-    if (info.Length() != 3)
+  numThreads = info[0].As<Napi::Number>().Int32Value();
+  // synchronous calls run on the JS thread
+  omp_set_num_threads(numThreads > 0 ? numThreads.load() : defaultNumThreads);
+
+  return env.Undefined();
+}
+
+static Napi::Value getNumThreads(const Napi::CallbackInfo &info)
+{
+  int threads = numThreads;
+  return Napi::Number::New(info.Env(), threads > 0 ? threads : defaultNumThreads);
+}
+
+// Array argument passed from JS: either borrowed from typed array memory or copied from a plain Array.
+template <typename V>
+struct ArrayInput
+{
+  const V *data = nullptr;
+  size_t length = 0;
+  std::vector<V> owned;
+
+  // Copy borrowed memory for work that outlives the call. A reference would keep the buffer from
+  // being collected, but not from being detached or transferred while a worker reads it.
+  void own()
+  {
+    if (length > 0 && data != owned.data())
     {
-      Napi::Error::New(env, "Expected 3 arguments, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
+      owned.assign(data, data + length);
+      data = owned.data();
     }
-    if (!info[0].IsArray())
+  }
+};
+
+using FloatInput = ArrayInput<float>;
+using IdInput = ArrayInput<idx_t>;
+
+// Per-call options read from the trailing options object of the search methods.
+struct SearchOptions
+{
+  std::unique_ptr<faiss::IDSelector> sel;
+  ArrayInput<uint8_t> bitmap; // memory referenced by an IDSelectorBitmap
+  std::optional<size_t> nprobe;
+  std::optional<size_t> maxCodes;
+  std::optional<int> efSearch;
+  std::optional<bool> checkRelativeDistance;
+  int threads = 0;
+  bool withStats = false;
+
+  bool empty() const
+  {
+    return !hasSearchParameters() && threads == 0 && !withStats;
+  }
+
+  // Whether faiss SearchParameters are needed, which some indexes (e.g. fast-scan) don't support.
+  bool hasSearchParameters() const
+  {
+    return sel || nprobe || maxCodes || efSearch || checkRelativeDistance;
+  }
+};
+
+// Work done by one search, returned with the `withStats` search option.
+struct SearchStats
+{
+  double timeMs = 0;
+  std::optional<faiss::IndexIVFStats> ivf;
+  std::optional<faiss::HNSWStats> hnsw;
+};
+
+// faiss adds up indexIVF_stats and hnsw_stats in unsynchronized globals. Searches with `withStats`
+// that can't collect their own counters diff the globals around the call, read under this mutex.
+static std::mutex searchStatsMutex;
+
+static faiss::IndexIVFStats ivfStatsSince(const faiss::IndexIVFStats &before)
+{
+  faiss::IndexIVFStats stats = faiss::indexIVF_stats;
+  stats.nq -= before.nq;
+  stats.nlist -= before.nlist;
+  stats.ndis -= before.ndis;
+  stats.nheap_updates -= before.nheap_updates;
+  stats.quantization_time -= before.quantization_time;
+  stats.search_time -= before.search_time;
+  return stats;
+}
+
+static faiss::HNSWStats hnswStatsSince(const faiss::HNSWStats &before)
+{
+  faiss::HNSWStats stats = faiss::hnsw_stats;
+  stats.n1 -= before.n1;
+  stats.n2 -= before.n2;
+  stats.n3 -= before.n3;
+  stats.ndis -= before.ndis;
+  stats.nreorder -= before.nreorder;
+  return stats;
+}
+
+static Napi::Object toStatsObject(Napi::Env env, const faiss::IndexIVFStats &stats)
+{
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("nq", Napi::Number::New(env, stats.nq));
+  result.Set("nlist", Napi::Number::New(env, stats.nlist));
+  result.Set("ndis", Napi::Number::New(env, stats.ndis));
+  result.Set("nheapUpdates", Napi::Number::New(env, stats.nheap_updates));
+  result.Set("quantizationTime", Napi::Number::New(env, stats.quantization_time));
+  result.Set("searchTime", Napi::Number::New(env, stats.search_time));
+  return result;
+}
+
+static Napi::Object toStatsObject(Napi::Env env, const faiss::HNSWStats &stats)
+{
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("n1", Napi::Number::New(env, stats.n1));
+  result.Set("n2", Napi::Number::New(env, stats.n2));
+  result.Set("n3", Napi::Number::New(env, stats.n3));
+  result.Set("ndis", Napi::Number::New(env, stats.ndis));
+  result.Set("nreorder", Napi::Number::New(env, stats.nreorder));
+  return result;
+}
+
+static Napi::Object toStatsObject(Napi::Env env, const SearchStats &stats)
+{
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("timeMs", Napi::Number::New(env, stats.timeMs));
+  if (stats.ivf)
+  {
+    result.Set("ivf", toStatsObject(env, *stats.ivf));
+  }
+  if (stats.hnsw)
+  {
+    result.Set("hnsw", toStatsObject(env, *stats.hnsw));
+  }
+  return result;
+}
+
+static Napi::Value getSearchStats(const Napi::CallbackInfo &info)
+{
+  Napi::Env env = info.Env();
+
+  std::lock_guard<std::mutex> lock(searchStatsMutex);
+  Napi::Object result = Napi::Object::New(env);
+  result.Set("ivf", toStatsObject(env, faiss::indexIVF_stats));
+  result.Set("hnsw", toStatsObject(env, faiss::hnsw_stats));
+  return result;
+}
+
+static Napi::Value resetSearchStats(const Napi::CallbackInfo &info)
+{
+  std::lock_guard<std::mutex> lock(searchStatsMutex);
+  faiss::indexIVF_stats.reset();
+  faiss::hnsw_stats.reset();
+  return info.Env().Undefined();
+}
+
+using Clock = std::chrono::steady_clock;
+
+// Lock-free latency histogram with HDR-style log-linear buckets: four per power of two
+// microseconds, so a value is known within 25%, up to 2^41 us (about 25 days).
+class LatencyHistogram
+{
+public:
+  static constexpr size_t kSubBuckets = 4;
+  static constexpr size_t kBuckets = 40 * kSubBuckets;
+
+  void record(Clock::duration duration)
+  {
+    auto micros = std::chrono::duration_cast<std::chrono::microseconds>(duration).count();
+    uint64_t value = micros > 0 ? micros : 0;
+    counts_[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    sumMicros_.fetch_add(value, std::memory_order_relaxed);
+  }
+
+  // Exclusive upper bound of the values counted in a bucket, in microseconds.
+  static uint64_t upperBound(size_t bucket)
+  {
+    return lowerBound(bucket + 1);
+  }
+
+  Napi::Object snapshot(Napi::Env env) const
+  {
+    auto buckets = Napi::Float64Array::New(env, kBuckets);
+    uint64_t count = 0;
+    for (size_t i = 0; i < kBuckets; i++)
     {
-      Napi::TypeError::New(env, "Invalid first argument, must be an array.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      uint64_t n = counts_[i].load(std::memory_order_relaxed);
+      buckets[i] = static_cast<double>(n);
+      count += n;
     }
-    if (!info[1].IsString())
+
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("count", Napi::Number::New(env, static_cast<double>(count)));
+    result.Set("sumMs", Napi::Number::New(env, sumMicros_.load(std::memory_order_relaxed) / 1000.0));
+    for (auto [name, quantile] : {std::make_pair("p50", 0.5), std::make_pair("p90", 0.9), std::make_pair("p99", 0.99)})
     {
-      Napi::TypeError::New(env, "Invalid second argument, must be a string.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      result.Set(name, Napi::Number::New(env, percentileMs(buckets, count, quantile)));
     }
-    if (!info[2].IsString())
+    result.Set("buckets", buckets);
+    return result;
+  }
+
+private:
+  static uint64_t lowerBound(size_t bucket)
+  {
+    if (bucket < kSubBuckets)
     {
-      Napi::TypeError::New(env, "Invalid third argument, must be a string.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      return bucket;
     }
-    Napi::Array inputArr = info[0].As<Napi::Array>();
-    auto inputArrLength = inputArr.Length();
-    if (inputArrLength < 2)
+    size_t octave = bucket / kSubBuckets + 1;
+    return (kSubBuckets + bucket % kSubBuckets) << (octave - 2);
+  }
+
+  static size_t bucketOf(uint64_t micros)
+  {
+    if (micros < kSubBuckets)
     {
-      Napi::Error::New(env, "Invalid first argument, array must contain at least 2 entries to merge.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      return micros;
     }
-    std::string outIndexFname = info[1].As<Napi::String>().Utf8Value();
-    std::string outDataFname = info[2].As<Napi::String>().Utf8Value();
+    size_t octave = std::ilogb(static_cast<double>(micros));
+    size_t bucket = kSubBuckets * (octave - 1) + ((micros >> (octave - 2)) & (kSubBuckets - 1));
+    return std::min(bucket, kBuckets - 1);
+  }
 
-    idx_t ntotal = 0;
-    std::vector<const faiss::InvertedLists *> lists;
-    faiss::IndexIVF *trainedIndex = nullptr;
-    auto trainedIndexOwned = true;
-    for (size_t i = 0; i < inputArrLength; i++)
+  // Upper bound of the bucket holding the quantile, so estimates err on the slow side.
+  static double percentileMs(const Napi::Float64Array &buckets, uint64_t count, double quantile)
+  {
+    if (count == 0)
     {
-      Napi::Value val = inputArr[i];
-      faiss::IndexIVF *mergeIndex = nullptr;
-      auto mergeIndexOwned = true;
-      if (val.IsObject())
-      {
-        mergeIndex = faiss::ivflib::extract_index_ivf(Napi::ObjectWrap<T>::Unwrap(val.As<Napi::Object>())->index_.get());
+      return 0;
+    }
+    auto rank = static_cast<uint64_t>(std::ceil(quantile * count));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; i++)
+    {
+      seen += static_cast<uint64_t>(buckets[i]);
+      if (seen >= rank)
+      {
+        return upperBound(i) / 1000.0;
+      }
+    }
+    return upperBound(kBuckets - 1) / 1000.0;
+  }
+
+  std::atomic<uint64_t> counts_[kBuckets] = {};
+  std::atomic<uint64_t> sumMicros_{0};
+};
+
+// Splits the time of a call between marshalling on the JS thread and native compute. Time spent
+// waiting, for the index lock or for a worker thread, counts as neither.
+class CallTimer
+{
+public:
+  void marshalled()
+  {
+    auto now = Clock::now();
+    marshalling_ += now - mark_;
+    mark_ = now;
+  }
+
+  void computed()
+  {
+    auto now = Clock::now();
+    native_ += now - mark_;
+    mark_ = now;
+  }
+
+  void waited()
+  {
+    mark_ = Clock::now();
+  }
+
+  // Native time of a search shared by batched calls.
+  void addNative(Clock::duration duration)
+  {
+    native_ += duration;
+  }
+
+  Clock::duration marshalling() const
+  {
+    return marshalling_;
+  }
+
+  Clock::duration native() const
+  {
+    return native_;
+  }
+
+private:
+  Clock::time_point mark_ = Clock::now();
+  Clock::duration marshalling_{0};
+  Clock::duration native_{0};
+};
+
+// Counters and latencies of one kind of index operation, updated by every call with relaxed atomics.
+struct OperationMetrics
+{
+  std::atomic<uint64_t> calls{0};
+  std::atomic<uint64_t> vectors{0};
+  std::atomic<uint64_t> errors{0};
+  LatencyHistogram native;
+  LatencyHistogram marshalling;
+
+  void record(size_t n, const CallTimer &timer)
+  {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    vectors.fetch_add(n, std::memory_order_relaxed);
+    native.record(timer.native());
+    marshalling.record(timer.marshalling());
+  }
+
+  void recordError()
+  {
+    calls.fetch_add(1, std::memory_order_relaxed);
+    errors.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  Napi::Object snapshot(Napi::Env env) const
+  {
+    Napi::Object result = Napi::Object::New(env);
+    result.Set("calls", Napi::Number::New(env, static_cast<double>(calls.load(std::memory_order_relaxed))));
+    result.Set("vectors", Napi::Number::New(env, static_cast<double>(vectors.load(std::memory_order_relaxed))));
+    result.Set("errors", Napi::Number::New(env, static_cast<double>(errors.load(std::memory_order_relaxed))));
+    result.Set("native", native.snapshot(env));
+    result.Set("marshalling", marshalling.snapshot(env));
+    return result;
+  }
+};
+
+struct IndexMetrics
+{
+  OperationMetrics search;
+  OperationMetrics add;
+  OperationMetrics train;
+};
+
+// Map `{ mmap, readOnly, onDiskSameDir }` read options onto faiss IO flags.
+static bool readIOFlags(Napi::Env env, const Napi::Value &value, int &ioFlags)
+{
+  if (value.IsUndefined())
+  {
+    return true;
+  }
+  if (!value.IsObject())
+  {
+    Napi::TypeError::New(env, "Invalid the second argument type, must be an Object.").ThrowAsJavaScriptException();
+    return false;
+  }
+
+  Napi::Object options = value.As<Napi::Object>();
+  const std::pair<const char *, int> flags[] = {
+      {"mmap", faiss::IO_FLAG_MMAP},
+      {"readOnly", faiss::IO_FLAG_READ_ONLY},
+      {"onDiskSameDir", faiss::IO_FLAG_ONDISK_SAME_DIR},
+  };
+  for (const auto &flag : flags)
+  {
+    if (options.Has(flag.first) && options.Get(flag.first).ToBoolean().Value())
+    {
+      ioFlags |= flag.second;
+    }
+  }
+
+  return true;
+}
+
+static bool isIdInput(const Napi::Value &value)
+{
+  return value.IsArray() || (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_bigint64_array);
+}
+
+// Read identifiers from a BigInt64Array (used in place) or an Array of Number or BigInt (copied).
+// With `copy`, BigInt64Array memory is copied too, for work that outlives the call.
+static bool readIds(Napi::Env env, const Napi::Value &value, IdInput &out, bool copy = false)
+{
+  if (value.IsTypedArray())
+  {
+    auto arr = value.As<Napi::BigInt64Array>();
+    out.data = arr.Data();
+    out.length = arr.ElementLength();
+    if (copy)
+    {
+      out.own();
+    }
+    return true;
+  }
+
+  Napi::Array arr = value.As<Napi::Array>();
+  size_t length = arr.Length();
+  out.owned.resize(length);
+  for (size_t i = 0; i < length; i++)
+  {
+    Napi::Value val = arr[i];
+    if (val.IsNumber())
+    {
+      out.owned[i] = val.As<Napi::Number>().Int64Value();
+    }
+    else if (val.IsBigInt())
+    {
+      auto lossless = false;
+      out.owned[i] = val.As<Napi::BigInt>().Int64Value(&lossless);
+    }
+    else
+    {
+      Napi::Error::New(env, "Expected a Number or BigInt as array item. (at: " + std::to_string(i) + ")")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+  }
+  out.data = out.owned.data();
+  out.length = length;
+
+  return true;
+}
+
+template <typename V>
+static Napi::ArrayBuffer toExternalArrayBuffer(Napi::Env env, std::vector<V> &&data)
+{
+  if (data.empty())
+  {
+    return Napi::ArrayBuffer::New(env, 0);
+  }
+
+  auto owned = new std::vector<V>(std::move(data));
+  return Napi::ArrayBuffer::New(
+      env, owned->data(), owned->size() * sizeof(V),
+      [](Napi::Env, void *, std::vector<V> *hint)
+      { delete hint; },
+      owned);
+}
+
+template <typename V>
+static Napi::ArrayBuffer toExternalArrayBuffer(Napi::Env env, V *data, size_t length)
+{
+  if (length == 0)
+  {
+    delete[] data;
+    return Napi::ArrayBuffer::New(env, 0);
+  }
+
+  return Napi::ArrayBuffer::New(
+      env, data, length * sizeof(V),
+      [](Napi::Env, void *data)
+      { delete[] static_cast<V *>(data); });
+}
+
+// Deserializes directly from memory owned by the caller, e.g. a JS Buffer, without copying it first.
+struct MemoryIOReader : faiss::IOReader
+{
+  const uint8_t *data;
+  size_t length;
+  size_t rp = 0;
+
+  MemoryIOReader(const uint8_t *data, size_t length) : data(data), length(length) {}
+
+  size_t operator()(void *ptr, size_t size, size_t nitems) override
+  {
+    if (size == 0 || rp >= length)
+    {
+      return 0;
+    }
+    nitems = std::min(nitems, (length - rp) / size);
+    std::memcpy(ptr, data + rp, size * nitems);
+    rp += size * nitems;
+    return nitems;
+  }
+};
+
+// Lower bound of the serialized size of an index, from the codes (and ids) of its vectors, used to
+// reserve the output of toBuffer. Other data (quantizers, graphs) is left to grow the buffer.
+static size_t serializedSizeHint(const faiss::Index *index)
+{
+  const size_t header = 4096;
+  if (auto ivf = dynamic_cast<const faiss::IndexIVF *>(index))
+  { // on-disk lists are written as a reference to their data file
+    auto inMemory = dynamic_cast<const faiss::ArrayInvertedLists *>(ivf->invlists) != nullptr;
+    return header + (inMemory ? ivf->ntotal * (ivf->code_size + sizeof(idx_t)) : 0);
+  }
+  if (auto codes = dynamic_cast<const faiss::IndexFlatCodes *>(index))
+  {
+    return header + codes->ntotal * codes->code_size;
+  }
+  return header;
+}
+
+static size_t serializedSizeHint(const faiss::IndexBinary *index)
+{
+  return 4096 + index->ntotal * index->code_size;
+}
+
+// Constructors of the generated float and binary index classes. An object must be an instance of
+// one of them before it is unwrapped as an IndexBase or BinaryIndexBase: unwrapping any other
+// wrapped object would reinterpret memory of a different layout.
+static std::vector<Napi::FunctionReference *> indexConstructors;
+static std::vector<Napi::FunctionReference *> binaryIndexConstructors;
+
+static bool isInstanceOfAny(const Napi::Value &value, const std::vector<Napi::FunctionReference *> &constructors)
+{
+  return value.IsObject() && std::any_of(constructors.begin(), constructors.end(), [&](Napi::FunctionReference *constructor)
+                                         { return value.As<Napi::Object>().InstanceOf(constructor->Value()); });
+}
+
+template <class T, typename Y, IndexType IT>
+class IndexBase : public Napi::ObjectWrap<T>
+{
+public:
+  IndexBase(const Napi::CallbackInfo &info) : Napi::ObjectWrap<T>(info)
+  {
+    Napi::Env env = info.Env();
+
+    if constexpr (IT == IndexType::IndexHNSW)
+    { // HNSW constructor
+      if (info.Length() > 0 && info[0].IsNumber())
+      {
+        auto d = info[0].As<Napi::Number>().Uint32Value();
+        auto m = 32;                                // faiss default
+        auto metric = faiss::MetricType::METRIC_L2; // faiss default
+        if (info.Length() > 1 && info[1].IsNumber())
+        {
+          m = info[1].As<Napi::Number>().Uint32Value();
+        }
+        if (info.Length() > 2 && info[2].IsNumber())
+        {
+          metric = static_cast<faiss::MetricType>(info[2].As<Napi::Number>().Uint32Value());
+        }
+        index_ = std::unique_ptr<faiss::IndexHNSW>(new faiss::IndexHNSW(d, m, metric));
+      }
+    }
+    else if constexpr (IT == IndexType::IndexHNSWSQ)
+    { // HNSWSQ constructor
+      if (info.Length() > 0 && info[0].IsNumber())
+      {
+        auto d = info[0].As<Napi::Number>().Uint32Value();
+        auto qtype = faiss::ScalarQuantizer::QT_8bit;
+        auto m = 32;                                // faiss default
+        auto metric = faiss::MetricType::METRIC_L2; // faiss default
+        if (info.Length() > 1 && info[1].IsNumber())
+        {
+          qtype = static_cast<faiss::ScalarQuantizer::QuantizerType>(info[1].As<Napi::Number>().Uint32Value());
+        }
+        if (info.Length() > 2 && info[2].IsNumber())
+        {
+          m = info[2].As<Napi::Number>().Uint32Value();
+        }
+        if (info.Length() > 3 && info[3].IsNumber())
+        {
+          metric = static_cast<faiss::MetricType>(info[3].As<Napi::Number>().Uint32Value());
+        }
+
+        try
+        {
+          index_ = std::unique_ptr<faiss::IndexHNSWSQ>(new faiss::IndexHNSWSQ(d, qtype, m, metric));
+        }
+        catch (const faiss::FaissException &ex)
+        {
+          Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+        }
+      }
+    }
+    else if constexpr (IT == IndexType::IndexHNSWPQ)
+    { // HNSWPQ constructor
+      if (info.Length() > 1 && info[0].IsNumber() && info[1].IsNumber())
+      {
+        auto d = info[0].As<Napi::Number>().Uint32Value();
+        auto pqM = info[1].As<Napi::Number>().Uint32Value();
+        auto m = 32;    // faiss default
+        auto nbits = 8; // faiss default
+        if (info.Length() > 2 && info[2].IsNumber())
+        {
+          m = info[2].As<Napi::Number>().Uint32Value();
+        }
+        if (info.Length() > 3 && info[3].IsNumber())
+        {
+          nbits = info[3].As<Napi::Number>().Uint32Value();
+        }
+
+        try
+        {
+          index_ = std::unique_ptr<faiss::IndexHNSWPQ>(new faiss::IndexHNSWPQ(d, pqM, m, nbits));
+        }
+        catch (const faiss::FaissException &ex)
+        {
+          Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+        }
+      }
+    }
+    else if constexpr (IT == IndexType::IndexIVFFlat)
+    { // IVFFlat constructor
+      if (info.Length() > 2 && info[0].IsObject() && info[1].IsNumber() && info[2].IsNumber())
+      {
+        auto quantizer = unwrapIndex(info[0]);
+        if (quantizer == nullptr)
+        {
+          Napi::TypeError::New(env, "Invalid the first argument, must be an Index that is not disposed.").ThrowAsJavaScriptException();
+          return;
+        }
+
+        auto d = info[1].As<Napi::Number>().Uint32Value();
+        auto nlist = info[2].As<Napi::Number>().Uint32Value();
+        auto metric = faiss::MetricType::METRIC_L2; // faiss default
+        if (info.Length() > 3 && info[3].IsNumber())
+        {
+          metric = static_cast<faiss::MetricType>(info[3].As<Napi::Number>().Uint32Value());
+        }
+
+        index_ = std::unique_ptr<faiss::IndexIVFFlat>(new faiss::IndexIVFFlat(quantizer, d, nlist, metric));
+        attachQuantizer(info[0].As<Napi::Object>());
+      }
+    }
+    else if constexpr (IT == IndexType::IndexIVFPQ)
+    { // IVFPQ constructor
+      if (info.Length() > 3 && info[0].IsObject() && info[1].IsNumber() && info[2].IsNumber() && info[3].IsNumber())
+      {
+        auto quantizer = unwrapIndex(info[0]);
+        if (quantizer == nullptr)
+        {
+          Napi::TypeError::New(env, "Invalid the first argument, must be an Index that is not disposed.").ThrowAsJavaScriptException();
+          return;
+        }
+
+        auto d = info[1].As<Napi::Number>().Uint32Value();
+        auto nlist = info[2].As<Napi::Number>().Uint32Value();
+        auto m = info[3].As<Napi::Number>().Uint32Value();
+        auto nbits = 8;                             // faiss default
+        auto metric = faiss::MetricType::METRIC_L2; // faiss default
+        if (info.Length() > 4 && info[4].IsNumber())
+        {
+          nbits = info[4].As<Napi::Number>().Uint32Value();
+        }
+        if (info.Length() > 5 && info[5].IsNumber())
+        {
+          metric = static_cast<faiss::MetricType>(info[5].As<Napi::Number>().Uint32Value());
+        }
+
+        try
+        {
+          index_ = std::unique_ptr<faiss::IndexIVFPQ>(new faiss::IndexIVFPQ(quantizer, d, nlist, m, nbits, metric));
+        }
+        catch (const faiss::FaissException &ex)
+        {
+          Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+          return;
+        }
+        attachQuantizer(info[0].As<Napi::Object>());
+      }
+    }
+    else if constexpr (IT == IndexType::IndexPQFastScan)
+    { // PQFastScan constructor
+      if (info.Length() > 1 && info[0].IsNumber() && info[1].IsNumber())
+      {
+        auto d = info[0].As<Napi::Number>().Uint32Value();
+        auto m = info[1].As<Napi::Number>().Uint32Value();
+        auto nbits = 4;                             // the only size supported by the fast-scan kernels
+        auto metric = faiss::MetricType::METRIC_L2; // faiss default
+        auto bbs = 32;                              // faiss default
+        if (info.Length() > 2 && info[2].IsNumber())
+        {
+          nbits = info[2].As<Napi::Number>().Uint32Value();
+        }
+        if (info.Length() > 3 && info[3].IsNumber())
+        {
+          metric = static_cast<faiss::MetricType>(info[3].As<Napi::Number>().Uint32Value());
+        }
+        if (info.Length() > 4 && info[4].IsNumber())
+        {
+          bbs = info[4].As<Napi::Number>().Uint32Value();
+        }
+
+        try
+        {
+          index_ = std::unique_ptr<faiss::IndexPQFastScan>(new faiss::IndexPQFastScan(d, m, nbits, metric, bbs));
+        }
+        catch (const faiss::FaissException &ex)
+        {
+          Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+        }
+      }
+    }
+    else if constexpr (IT == IndexType::IndexIVFPQFastScan)
+    { // IVFPQFastScan constructor
+      if (info.Length() > 3 && info[0].IsObject() && info[1].IsNumber() && info[2].IsNumber() && info[3].IsNumber())
+      {
+        auto quantizer = unwrapIndex(info[0]);
+        if (quantizer == nullptr)
+        {
+          Napi::TypeError::New(env, "Invalid the first argument, must be an Index that is not disposed.").ThrowAsJavaScriptException();
+          return;
+        }
+
+        auto d = info[1].As<Napi::Number>().Uint32Value();
+        auto nlist = info[2].As<Napi::Number>().Uint32Value();
+        auto m = info[3].As<Napi::Number>().Uint32Value();
+        auto nbits = 4;                             // the only size supported by the fast-scan kernels
+        auto metric = faiss::MetricType::METRIC_L2; // faiss default
+        auto bbs = 32;                              // faiss default
+        if (info.Length() > 4 && info[4].IsNumber())
+        {
+          nbits = info[4].As<Napi::Number>().Uint32Value();
+        }
+        if (info.Length() > 5 && info[5].IsNumber())
+        {
+          metric = static_cast<faiss::MetricType>(info[5].As<Napi::Number>().Uint32Value());
+        }
+        if (info.Length() > 6 && info[6].IsNumber())
+        {
+          bbs = info[6].As<Napi::Number>().Uint32Value();
+        }
+
+        try
+        {
+          index_ = std::unique_ptr<faiss::IndexIVFPQFastScan>(new faiss::IndexIVFPQFastScan(quantizer, d, nlist, m, nbits, metric, bbs));
+        }
+        catch (const faiss::FaissException &ex)
+        {
+          Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+          return;
+        }
+        attachQuantizer(info[0].As<Napi::Object>());
+      }
+    }
+    else if constexpr (IT == IndexType::IndexIVFScalarQuantizer)
+    { // IVFScalarQuantizer constructor
+      if (info.Length() > 2 && info[0].IsObject() && info[1].IsNumber() && info[2].IsNumber())
+      {
+        auto quantizer = unwrapIndex(info[0]);
+        if (quantizer == nullptr)
+        {
+          Napi::TypeError::New(env, "Invalid the first argument, must be an Index that is not disposed.").ThrowAsJavaScriptException();
+          return;
+        }
+
+        auto d = info[1].As<Napi::Number>().Uint32Value();
+        auto nlist = info[2].As<Napi::Number>().Uint32Value();
+        auto qtype = faiss::ScalarQuantizer::QT_8bit;
+        auto metric = faiss::MetricType::METRIC_L2; // faiss default
+        auto byResidual = true;                     // faiss default
+        if (info.Length() > 3 && info[3].IsNumber())
+        {
+          qtype = static_cast<faiss::ScalarQuantizer::QuantizerType>(info[3].As<Napi::Number>().Uint32Value());
+        }
+        if (info.Length() > 4 && info[4].IsNumber())
+        {
+          metric = static_cast<faiss::MetricType>(info[4].As<Napi::Number>().Uint32Value());
+        }
+        if (info.Length() > 5 && info[5].IsBoolean())
+        {
+          byResidual = info[5].As<Napi::Boolean>().Value();
+        }
+
+        try
+        {
+          index_ = std::unique_ptr<faiss::IndexIVFScalarQuantizer>(new faiss::IndexIVFScalarQuantizer(quantizer, d, nlist, qtype, metric, byResidual));
+        }
+        catch (const faiss::FaissException &ex)
+        {
+          Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+          return;
+        }
+        attachQuantizer(info[0].As<Napi::Object>());
+      }
+    }
+    else if constexpr (IT == IndexType::IndexShards)
+    { // Shards constructor
+      if (info.Length() > 0 && info[0].IsNumber())
+      {
+        auto d = info[0].As<Napi::Number>().Uint32Value();
+        auto threaded = true; // search the shards in parallel, faiss defaults to serially
+        auto successiveIds = true;
+        if (info.Length() > 1 && info[1].IsBoolean())
+        {
+          threaded = info[1].As<Napi::Boolean>().Value();
+        }
+        if (info.Length() > 2 && info[2].IsBoolean())
+        {
+          successiveIds = info[2].As<Napi::Boolean>().Value();
+        }
+        index_ = std::unique_ptr<faiss::IndexShards>(new faiss::IndexShards(d, threaded, successiveIds));
+      }
+    }
+    else if constexpr (IT == IndexType::IndexReplicas)
+    { // Replicas constructor
+      if (info.Length() > 0 && info[0].IsNumber())
+      {
+        auto d = info[0].As<Napi::Number>().Uint32Value();
+        auto threaded = true; // faiss default
+        if (info.Length() > 1 && info[1].IsBoolean())
+        {
+          threaded = info[1].As<Napi::Boolean>().Value();
+        }
+        index_ = std::unique_ptr<faiss::IndexReplicas>(new faiss::IndexReplicas(d, threaded));
+      }
+    }
+    else if (info.Length() > 0 && info[0].IsNumber())
+    {
+      auto n = info[0].As<Napi::Number>().Uint32Value();
+      index_ = std::unique_ptr<Y>(new Y(n));
+    }
+  }
+
+  // Called by the Init of each generated index class.
+  static void setConstructor(Napi::Function func)
+  {
+    constructor = new Napi::FunctionReference(Napi::Persistent(func));
+    indexConstructors.push_back(constructor);
+  }
+
+  // The instance behind a JS value if it is a float index of any class, or nullptr. The classes
+  // only differ by constructor, so the instance of another class is used through this one's layout.
+  static IndexBase *unwrapInstance(const Napi::Value &value)
+  {
+    if (!isInstanceOfAny(value, indexConstructors))
+    {
+      return nullptr;
+    }
+    return Napi::ObjectWrap<T>::Unwrap(value.As<Napi::Object>());
+  }
+
+  // The faiss index of a JS index, or nullptr if the value is not a float index or is disposed.
+  // Indexes built on it use it in place and must attach it (see attachSubIndex).
+  static faiss::Index *unwrapIndex(const Napi::Value &value)
+  {
+    auto instance = unwrapInstance(value);
+    return instance != nullptr ? instance->index_.get() : nullptr;
+  }
+
+  static Napi::Value read(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || info.Length() > 2)
+    {
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    int ioFlags = 0;
+    if (info.Length() > 1 && !readIOFlags(env, info[1], ioFlags))
+    {
+      return env.Undefined();
+    }
+
+    Napi::Object instance = T::constructor->New({});
+    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+    std::string fname = info[0].As<Napi::String>().Utf8Value();
+
+    try
+    {
+      index->index_ = std::unique_ptr<faiss::Index>(dynamic_cast<faiss::Index *>(faiss::read_index(fname.c_str(), ioFlags)));
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
+
+    return instance;
+  }
+
+  static Napi::Value fromBuffer(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsBuffer())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a buffer.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    Napi::Object instance = T::constructor->New({});
+    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+
+    auto buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    MemoryIOReader reader(buffer.Data(), buffer.Length());
+
+    try
+    {
+      index->index_ = std::unique_ptr<faiss::Index>(dynamic_cast<faiss::Index *>(faiss::read_index(&reader)));
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
+
+    return instance;
+  }
+
+  static Napi::Value readStream(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || info.Length() > 2)
+    {
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!isStream(info[0], "on"))
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a readable stream.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    size_t highWaterMark = 8 << 20;
+    if (info.Length() > 1)
+    {
+      if (!info[1].IsObject())
+      {
+        Napi::TypeError::New(env, "Invalid the second argument type, must be an Object.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      Napi::Object options = info[1].As<Napi::Object>();
+      if (options.Has("highWaterMark"))
+      {
+        Napi::Value val = options.Get("highWaterMark");
+        if (!val.IsNumber() || val.As<Napi::Number>().Int64Value() <= 0)
+        {
+          Napi::TypeError::New(env, "Invalid highWaterMark option, must be a positive Number.").ThrowAsJavaScriptException();
+          return env.Undefined();
+        }
+        highWaterMark = val.As<Napi::Number>().Int64Value();
+      }
+    }
+
+    auto reader = new StreamReader(env, info[0].As<Napi::Object>(), highWaterMark);
+    return reader->Start(env);
+  }
+
+  static Napi::Value fromFactory(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 2)
+    {
+      Napi::Error::New(env, "Expected 2 or 3 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsNumber())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a number.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[1].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid the second argument type, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto metric = faiss::MetricType::METRIC_L2;
+    if (info[2].IsNumber())
+    {
+      metric = static_cast<faiss::MetricType>(info[2].As<Napi::Number>().Uint32Value());
+    }
+
+    Napi::Object instance = T::constructor->New({});
+    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+
+    const uint32_t d = info[0].As<Napi::Number>().Uint32Value();
+    std::string description = info[1].As<Napi::String>().Utf8Value();
+
+    try
+    {
+      index->index_ = std::unique_ptr<faiss::Index>(dynamic_cast<faiss::Index *>(faiss::index_factory(d, description.c_str(), metric)));
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
+
+    return instance;
+  }
+
+#ifndef _MSC_VER
+  static Napi::Value mergeOnDisk(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (info.Length() != 3)
+    {
+      Napi::Error::New(env, "Expected 3 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsArray())
+    {
+      Napi::TypeError::New(env, "Invalid first argument, must be an array.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[1].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid second argument, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[2].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid third argument, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    Napi::Array inputArr = info[0].As<Napi::Array>();
+    auto inputArrLength = inputArr.Length();
+    if (inputArrLength < 2)
+    {
+      Napi::Error::New(env, "Invalid first argument, array must contain at least 2 entries to merge.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!checkMergeInputs(env, inputArr))
+    {
+      return env.Undefined();
+    }
+    std::string outIndexFname = info[1].As<Napi::String>().Utf8Value();
+    std::string outDataFname = info[2].As<Napi::String>().Utf8Value();
+
+    IndexLocks locks;
+    for (size_t i = 0; i < inputArrLength; i++)
+    {
+      Napi::Value val = inputArr[i];
+      if (val.IsObject())
+      {
+        locks.add(unwrapInstance(val), true);
+      }
+    }
+    locks.lock();
+
+    idx_t ntotal = 0;
+    std::vector<const faiss::InvertedLists *> lists;
+    // lists of the indexes read from files; those of JS indexes stay theirs, and the trained index
+    // releases its own when they are replaced
+    std::vector<const faiss::InvertedLists *> ownedLists;
+    faiss::IndexIVF *trainedIndex = nullptr;
+    auto trainedIndexOwned = true;
+    for (size_t i = 0; i < inputArrLength; i++)
+    {
+      Napi::Value val = inputArr[i];
+      faiss::IndexIVF *mergeIndex = nullptr;
+      auto mergeIndexOwned = true;
+      if (val.IsObject())
+      {
+        mergeIndex = faiss::ivflib::extract_index_ivf(unwrapInstance(val)->index_.get());
+        mergeIndexOwned = false;
+      }
+      else
+      {
+        mergeIndex = faiss::ivflib::extract_index_ivf(faiss::read_index(val.As<Napi::String>().Utf8Value().c_str(), faiss::IO_FLAG_MMAP));
+        mergeIndex->own_invlists = false; // allow IVF to be released without deleting the inverted lists
+        ownedLists.push_back(mergeIndex->invlists);
+      }
+
+      if (i == 0)
+      { // first index is trained index
+        trainedIndex = mergeIndex;
+        trainedIndexOwned = mergeIndexOwned;
         mergeIndexOwned = false;
       }
-      else
+
+      lists.push_back(mergeIndex->invlists);
+      ntotal += mergeIndex->ntotal;
+
+      if (mergeIndexOwned)
+      {
+        delete mergeIndex;
+      }
+    }
+
+    auto il = new faiss::OnDiskInvertedLists(trainedIndex->nlist, trainedIndex->code_size, outDataFname.c_str());
+    // this will write the merged index to disk
+    il->merge_from(lists.data(), lists.size(), false);
+
+    // replace invertedLists in the output index
+    trainedIndex->replace_invlists(il, true);
+    trainedIndex->ntotal = ntotal;
+
+    // release all indexes
+    if (trainedIndexOwned)
+    {
+      // write the trained index to disk using the same filename
+      try
+      {
+        faiss::write_index(trainedIndex, outIndexFname.c_str());
+        delete trainedIndex;
+      }
+      catch (const faiss::FaissException &ex)
+      {
+        delete trainedIndex;
+        Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      }
+    }
+
+    for (size_t i = 0; i < ownedLists.size(); i++)
+    {
+      delete ownedLists[i];
+    }
+
+    return env.Undefined();
+  }
+
+  // Merge inputs are IVF indexes or paths. An index that is a part of another one (e.g. its shard)
+  // would be merged twice, so that is rejected; sharing a part (e.g. a quantizer) is fine.
+  static bool checkMergeInputs(Napi::Env env, const Napi::Array &inputArr)
+  {
+    std::vector<IndexBase *> instances;
+    for (size_t i = 0; i < inputArr.Length(); i++)
+    {
+      Napi::Value val = inputArr[i];
+      if (val.IsString())
+      {
+        continue;
+      }
+      auto instance = unwrapInstance(val);
+      if (instance == nullptr || !instance->index_)
+      {
+        Napi::TypeError::New(env, "Invalid first argument, entries must be IVF indexes or paths.").ThrowAsJavaScriptException();
+        return false;
+      }
+      if (std::any_of(instances.begin(), instances.end(), [&](IndexBase *other)
+                      { return isPartOf(instance, other) || isPartOf(other, instance); }))
+      {
+        Napi::Error::New(env, "Invalid first argument, indexes to merge must not be parts of one another.").ThrowAsJavaScriptException();
+        return false;
+      }
+      instances.push_back(instance);
+    }
+    return true;
+  }
+
+  // Asynchronous mergeOnDisk: see MergeWorker. Inputs are IVF indexes or paths, read memory-mapped.
+  static Napi::Value mergeOnDiskAsync(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 3 || info.Length() > 4)
+    {
+      Napi::Error::New(env, "Expected 3 or 4 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsArray())
+    {
+      Napi::TypeError::New(env, "Invalid first argument, must be an array.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[1].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid second argument, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[2].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid third argument, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    MergeOptions options;
+    options.outputIndexPath = info[1].As<Napi::String>().Utf8Value();
+    options.outputDataPath = info[2].As<Napi::String>().Utf8Value();
+    Napi::Function onProgress;
+    if (info.Length() > 3 && !info[3].IsUndefined())
+    {
+      if (!info[3].IsObject())
+      {
+        Napi::TypeError::New(env, "Invalid the fourth argument type, must be an Object.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      Napi::Object obj = info[3].As<Napi::Object>();
+      options.append = obj.Get("append").ToBoolean().Value();
+      if (!readThreadsOption(env, obj, options.threads))
+      {
+        return env.Undefined();
+      }
+      if (obj.Has("onProgress"))
+      {
+        Napi::Value val = obj.Get("onProgress");
+        if (!val.IsFunction())
+        {
+          Napi::TypeError::New(env, "Invalid onProgress option, must be a Function.").ThrowAsJavaScriptException();
+          return env.Undefined();
+        }
+        onProgress = val.As<Napi::Function>();
+      }
+    }
+
+    Napi::Array inputArr = info[0].As<Napi::Array>();
+    if (inputArr.Length() < (options.append ? 1 : 2))
+    {
+      Napi::Error::New(env, options.append ? "Invalid first argument, array must contain at least 1 entry to append."
+                                           : "Invalid first argument, array must contain at least 2 entries to merge.")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    if (!checkMergeInputs(env, inputArr))
+    {
+      return env.Undefined();
+    }
+
+    auto worker = new MergeWorker(env, std::move(options), onProgress);
+    for (size_t i = 0; i < inputArr.Length(); i++)
+    {
+      Napi::Value val = inputArr[i];
+      if (val.IsString())
+      {
+        worker->AddInput(val.As<Napi::String>().Utf8Value());
+      }
+      else
+      {
+        worker->AddInput(val.As<Napi::Object>());
+      }
+    }
+    auto promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+  }
+#endif // _MSC_VER
+
+  Napi::Value getIndexType(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    return Napi::Number::New(info.Env(), static_cast<uint32_t>(indexTypeOf(index_.get())));
+  }
+
+  // The most specific IndexType of a faiss index; subclasses without their own value (e.g. from a
+  // factory) fall back to their family, then to Index.
+  static IndexType indexTypeOf(const faiss::Index *index)
+  {
+    if (auto flat = dynamic_cast<const faiss::IndexFlat *>(index))
+    { // the factory makes plain IndexFlat instances, so the metric decides
+      switch (flat->metric_type)
+      {
+      case faiss::METRIC_L2:
+        return IndexType::IndexFlatL2;
+      case faiss::METRIC_INNER_PRODUCT:
+        return IndexType::IndexFlatIP;
+      default:
+        return IndexType::IndexFlat;
+      }
+    }
+    if (dynamic_cast<const faiss::IndexHNSWSQ *>(index) != nullptr)
+    {
+      return IndexType::IndexHNSWSQ;
+    }
+    if (dynamic_cast<const faiss::IndexHNSWPQ *>(index) != nullptr)
+    {
+      return IndexType::IndexHNSWPQ;
+    }
+    if (dynamic_cast<const faiss::IndexHNSW *>(index) != nullptr)
+    {
+      return IndexType::IndexHNSW;
+    }
+    if (dynamic_cast<const faiss::IndexIVFFlat *>(index) != nullptr)
+    {
+      return IndexType::IndexIVFFlat;
+    }
+    if (dynamic_cast<const faiss::IndexIVFPQ *>(index) != nullptr)
+    {
+      return IndexType::IndexIVFPQ;
+    }
+    if (dynamic_cast<const faiss::IndexIVFScalarQuantizer *>(index) != nullptr)
+    {
+      return IndexType::IndexIVFScalarQuantizer;
+    }
+    if (dynamic_cast<const faiss::IndexIVFPQFastScan *>(index) != nullptr)
+    {
+      return IndexType::IndexIVFPQFastScan;
+    }
+    if (dynamic_cast<const faiss::IndexIVF *>(index) != nullptr)
+    {
+      return IndexType::IndexIVF;
+    }
+    if (dynamic_cast<const faiss::IndexPQFastScan *>(index) != nullptr)
+    {
+      return IndexType::IndexPQFastScan;
+    }
+    if (dynamic_cast<const faiss::IndexPQ *>(index) != nullptr)
+    {
+      return IndexType::IndexPQ;
+    }
+    if (dynamic_cast<const faiss::IndexRefine *>(index) != nullptr)
+    {
+      return IndexType::IndexRefine;
+    }
+    if (dynamic_cast<const faiss::IndexShards *>(index) != nullptr)
+    {
+      return IndexType::IndexShards;
+    }
+    if (dynamic_cast<const faiss::IndexReplicas *>(index) != nullptr)
+    {
+      return IndexType::IndexReplicas;
+    }
+
+    return IndexType::Index;
+  }
+
+  Napi::Value getIsTrained(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    return Napi::Boolean::New(env, index_->is_trained);
+  }
+
+  Napi::Value getNTotal(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    return Napi::Number::New(env, index_->ntotal);
+  }
+
+  Napi::Value getDimension(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    return Napi::Number::New(env, index_->d);
+  }
+
+  Napi::Value getMetricType(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    return Napi::Number::New(info.Env(), index_->metric_type);
+  }
+
+  Napi::Value getMetricArg(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    return Napi::Number::New(info.Env(), index_->metric_arg);
+  }
+
+  Napi::Value getCodeSize(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    if (auto ivf = dynamic_cast<faiss::IndexIVF *>(index_.get()))
+    {
+      return Napi::Number::New(info.Env(), ivf->code_size);
+    }
+    if (auto hnsw = dynamic_cast<faiss::IndexHNSW *>(index_.get()))
+    {
+      return Napi::Number::New(info.Env(), dynamic_cast<faiss::IndexFlatCodes *>(hnsw->storage)->code_size);
+    }
+    auto index = dynamic_cast<faiss::IndexFlat *>(index_.get());
+    return Napi::Number::New(info.Env(), index->code_size);
+  }
+
+  Napi::Value getCodesUInt8(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    auto lock = readLock();
+    auto index = dynamic_cast<faiss::IndexFlat *>(index_.get());
+    return Napi::Buffer<uint8_t>::Copy(env, index->codes.data(), index->codes.size());
+  }
+
+  Napi::Value getCodesByRange(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    auto lock = readLock();
+    auto index = dynamic_cast<faiss::IndexFlat *>(index_.get());
+
+    size_t start = 0;
+    size_t end = index->codes.size();
+
+    if (info.Length() >= 1)
+    {
+      start = info[0].As<Napi::Number>().Uint32Value();
+      if (start >= end)
+      {
+        Napi::Error::New(env, "Position must be less than end.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+    }
+    if (info.Length() >= 2)
+    {
+      end = info[1].As<Napi::Number>().Uint32Value();
+      if (end > index->codes.size())
+      {
+        end = index->codes.size();
+      }
+    }
+
+    return Napi::Buffer<uint8_t>::Copy(env, &index->codes.data()[start], end - start);
+  }
+
+  Napi::Value setCodesByRange(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    auto index = dynamic_cast<faiss::IndexFlat *>(index_.get());
+
+    size_t start = 0;
+
+    if (info.Length() < 1)
+    {
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (info.Length() >= 2)
+    {
+      start = info[1].As<Napi::Number>().Uint32Value();
+      if (start >= index->codes.size())
+      {
+        Napi::Error::New(env, "Position must be less than end.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+    }
+
+    auto buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    auto length = buffer.Length();
+    if (length + start > index->codes.size())
+    {
+      Napi::Error::New(env, "Buffer size must be less than or equal to the remaining size.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    // write buffer to codes
+    std::memcpy(&index->codes.data()[start], buffer.Data(), length);
+
+    return env.Undefined();
+  }
+
+  Napi::Value getIds(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    auto lock = readLock();
+    auto index = dynamic_cast<faiss::IndexIDMap *>(index_.get());
+    auto length = index->id_map.size();
+    Napi::Array ids = Napi::Array::New(env, length);
+    auto id_map = index->id_map.data();
+    for (size_t i = 0; i < length; i++)
+    {
+      ids[i] = Napi::BigInt::New(env, id_map[i]);
+    }
+
+    return ids;
+  }
+
+  Napi::Value getNProbe(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    auto index = unwrap<faiss::IndexIVF>();
+    return Napi::Number::New(info.Env(), index->nprobe);
+  }
+
+  Napi::Value setNProbe(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsNumber())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    auto index = unwrap<faiss::IndexIVF>();
+    index->nprobe = info[0].As<Napi::Number>().Int32Value();
+    return env.Undefined();
+  }
+
+  // The index of type I, looking through the wrappers made by toIDMap2 and toRefineFlat.
+  template <class I>
+  I *unwrap() const
+  {
+    auto index = index_.get();
+    while (index != nullptr)
+    {
+      if (auto match = dynamic_cast<I *>(index))
+      {
+        return match;
+      }
+      if (auto idmap = dynamic_cast<faiss::IndexIDMap *>(index))
+      {
+        index = idmap->index;
+      }
+      else if (auto refine = dynamic_cast<faiss::IndexRefine *>(index))
+      {
+        index = refine->base_index;
+      }
+      else
+      {
+        return nullptr;
+      }
+    }
+    return nullptr;
+  }
+
+  const faiss::ProductQuantizer &productQuantizer() const
+  {
+    if (auto ivfpq = unwrap<faiss::IndexIVFPQ>())
+    {
+      return ivfpq->pq;
+    }
+    if (auto ivfFastScan = unwrap<faiss::IndexIVFPQFastScan>())
+    {
+      return ivfFastScan->pq;
+    }
+    if (auto hnsw = unwrap<faiss::IndexHNSWPQ>())
+    {
+      return dynamic_cast<faiss::IndexPQ *>(hnsw->storage)->pq;
+    }
+    return unwrap<faiss::IndexPQFastScan>()->pq;
+  }
+
+  Napi::Value getM(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    return Napi::Number::New(info.Env(), productQuantizer().M);
+  }
+
+  Napi::Value getNBits(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    return Napi::Number::New(info.Env(), productQuantizer().nbits);
+  }
+
+  Napi::Value getBbs(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    if (auto ivf = unwrap<faiss::IndexIVFFastScan>())
+    {
+      return Napi::Number::New(info.Env(), ivf->bbs);
+    }
+    return Napi::Number::New(info.Env(), unwrap<faiss::IndexFastScan>()->bbs);
+  }
+
+  Napi::Value getImplem(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    if (auto ivf = unwrap<faiss::IndexIVFFastScan>())
+    {
+      return Napi::Number::New(info.Env(), ivf->implem);
+    }
+    return Napi::Number::New(info.Env(), unwrap<faiss::IndexFastScan>()->implem);
+  }
+
+  Napi::Value setImplem(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsNumber() || info[0].As<Napi::Number>().Int32Value() < 0)
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a non-negative Number.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    auto implem = info[0].As<Napi::Number>().Int32Value();
+    if (auto ivf = unwrap<faiss::IndexIVFFastScan>())
+    {
+      ivf->implem = implem;
+    }
+    else
+    {
+      unwrap<faiss::IndexFastScan>()->implem = implem;
+    }
+    return env.Undefined();
+  }
+
+  Napi::Value getQType(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    if (auto hnsw = dynamic_cast<faiss::IndexHNSWSQ *>(index_.get()))
+    {
+      auto storage = dynamic_cast<faiss::IndexScalarQuantizer *>(hnsw->storage);
+      return Napi::Number::New(info.Env(), static_cast<uint32_t>(storage->sq.qtype));
+    }
+    auto index = dynamic_cast<faiss::IndexIVFScalarQuantizer *>(index_.get());
+    return Napi::Number::New(info.Env(), static_cast<uint32_t>(index->sq.qtype));
+  }
+
+  // by_residual is a member of each IVF subclass in this faiss version.
+  bool *byResidual()
+  {
+    if (auto pq = dynamic_cast<faiss::IndexIVFPQ *>(index_.get()))
+    {
+      return &pq->by_residual;
+    }
+    return &dynamic_cast<faiss::IndexIVFScalarQuantizer *>(index_.get())->by_residual;
+  }
+
+  Napi::Value getByResidual(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    return Napi::Boolean::New(info.Env(), *byResidual());
+  }
+
+  Napi::Value setByResidual(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsBoolean())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a Boolean.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    if (index_->is_trained)
+    {
+      Napi::Error::New(env, "byResidual can only be changed before training.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    *byResidual() = info[0].As<Napi::Boolean>().Value();
+    return env.Undefined();
+  }
+
+  Napi::Value getUsePrecomputedTable(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    auto index = dynamic_cast<faiss::IndexIVFPQ *>(index_.get());
+    return Napi::Number::New(info.Env(), index->use_precomputed_table);
+  }
+
+  Napi::Value setUsePrecomputedTable(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsNumber() || info[0].As<Napi::Number>().Int32Value() < -1 || info[0].As<Napi::Number>().Int32Value() > 2)
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number between -1 and 2.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    auto index = dynamic_cast<faiss::IndexIVFPQ *>(index_.get());
+    index->use_precomputed_table = info[0].As<Napi::Number>().Int32Value();
+    // tables are otherwise built at the end of training
+    if (index->is_trained)
+    {
+      try
+      {
+        index->precompute_table();
+      }
+      catch (const faiss::FaissException &ex)
+      {
+        Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      }
+    }
+    return env.Undefined();
+  }
+
+  Napi::Value getEfConstruction(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    auto index = dynamic_cast<faiss::IndexHNSW *>(index_.get());
+    return Napi::Number::New(info.Env(), index->hnsw.efConstruction);
+  }
+
+  Napi::Value setEfConstruction(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsNumber())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    auto index = dynamic_cast<faiss::IndexHNSW *>(index_.get());
+    index->hnsw.efConstruction = info[0].As<Napi::Number>().Int32Value();
+    return env.Undefined();
+  }
+
+  Napi::Value getEfSearch(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    auto index = dynamic_cast<faiss::IndexHNSW *>(index_.get());
+    return Napi::Number::New(info.Env(), index->hnsw.efSearch);
+  }
+
+  Napi::Value setEfSearch(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsNumber())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    auto index = dynamic_cast<faiss::IndexHNSW *>(index_.get());
+    index->hnsw.efSearch = info[0].As<Napi::Number>().Int32Value();
+    return env.Undefined();
+  }
+
+  Napi::Value add(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    FloatInput xb;
+    if (!readVectors(env, info[0], "first", xb))
+    {
+      return env.Undefined();
+    }
+
+    auto n = xb.length / index_->d;
+    timer.marshalled();
+    auto lock = writeLock();
+    timer.waited();
+    try
+    {
+      index_->add(n, xb.data);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      metrics_.add.recordError();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    timer.computed();
+    metrics_.add.record(n, timer);
+
+    return env.Undefined();
+  }
+
+  Napi::Value addAsync(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    if (info.Length() < 1 || info.Length() > 2)
+    {
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    FloatInput xb;
+    int threads = 0;
+    if (!readVectors(env, info[0], "first", xb, true) || !readWorkerOptions(env, info[1], "second", threads))
+    {
+      return env.Undefined();
+    }
+
+    auto n = xb.length / index_->d;
+    auto worker = new AddWorker(env, this, info.This().As<Napi::Object>(), std::move(xb), IdInput(), false);
+    worker->SetThreads(threads);
+    worker->SetMetrics(&metrics_.add, n, timer);
+    auto promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+  }
+
+  Napi::Value addWithIds(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    FloatInput xb;
+    IdInput xids;
+    if (!readAddWithIdsArgs(info, xb, xids))
+    {
+      return env.Undefined();
+    }
+
+    timer.marshalled();
+    auto lock = writeLock();
+    timer.waited();
+    try
+    {
+      index_->add_with_ids(xids.length, xb.data, xids.data);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      metrics_.add.recordError();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    timer.computed();
+    metrics_.add.record(xids.length, timer);
+
+    return env.Undefined();
+  }
+
+  Napi::Value addWithIdsAsync(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    FloatInput xb;
+    IdInput xids;
+    int threads = 0;
+    if (!readAddWithIdsArgs(info, xb, xids, true) || !readWorkerOptions(env, info[2], "third", threads))
+    {
+      return env.Undefined();
+    }
+
+    auto n = xids.length;
+    auto worker = new AddWorker(env, this, info.This().As<Napi::Object>(), std::move(xb), std::move(xids), true);
+    worker->SetThreads(threads);
+    worker->SetMetrics(&metrics_.add, n, timer);
+    auto promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+  }
+
+  Napi::Value reset(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    index_->reset();
+
+    return env.Undefined();
+  }
+
+  Napi::Value dispose(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (*parents_ > 0)
+    {
+      Napi::Error::New(env, "Index is used by another index (as a shard, replica, refine source or quantizer) and cannot be disposed.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    batcher_.reset();
+    // waits for in-flight async work to complete
+    auto lock = writeLock();
+    auto idx = index_.release();
+    delete idx;
+    index_ = nullptr;
+    mutex_.unlinkAll();
+    subIndexes_.clear();
+    subIndexRefs_.clear();
+
+    return env.Undefined();
+  }
+
+  Napi::Value train(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    FloatInput xb;
+    if (!readVectors(env, info[0], "first", xb))
+    {
+      return env.Undefined();
+    }
+
+    auto n = xb.length / index_->d;
+    timer.marshalled();
+    auto lock = writeLock();
+    timer.waited();
+    try
+    {
+      index_->train(n, xb.data);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      metrics_.train.recordError();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    timer.computed();
+    metrics_.train.record(n, timer);
+
+    return env.Undefined();
+  }
+
+  Napi::Value trainAsync(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    if (info.Length() < 1 || info.Length() > 2)
+    {
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    FloatInput xb;
+    int threads = 0;
+    if (!readVectors(env, info[0], "first", xb, true) || !readWorkerOptions(env, info[1], "second", threads))
+    {
+      return env.Undefined();
+    }
+
+    auto n = xb.length / index_->d;
+    auto worker = new TrainWorker(env, this, info.This().As<Napi::Object>(), std::move(xb));
+    worker->SetThreads(threads);
+    worker->SetMetrics(&metrics_.train, n, timer);
+    auto promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+  }
+
+  Napi::Value search(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    FloatInput xq;
+    idx_t k = 0;
+    SearchOptions options;
+    if (!readSearchArgs(info, xq, k) || !readSearchOptions(env, info[2], "third", options) || !checkFilter(env, options))
+    {
+      return env.Undefined();
+    }
+
+    auto nq = xq.length / index_->d;
+    std::vector<idx_t> I(k * nq);
+    std::vector<float> D(k * nq);
+
+    SearchStats stats;
+    timer.marshalled();
+    auto lock = readLock();
+    timer.waited();
+    try
+    {
+      runSearch(nq, xq.data, k, D.data(), I.data(), options, &stats);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      metrics_.search.recordError();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    timer.computed();
+
+    Napi::Object results = toSearchResult(env, D, I);
+    if (options.withStats)
+    {
+      results.Set("stats", toStatsObject(env, stats));
+    }
+    timer.marshalled();
+    metrics_.search.record(nq, timer);
+    return results;
+  }
+
+  Napi::Value searchTyped(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    FloatInput xq;
+    idx_t k = 0;
+    SearchOptions options;
+    if (!readSearchArgs(info, xq, k) || !readSearchOptions(env, info[2], "third", options) || !checkFilter(env, options))
+    {
+      return env.Undefined();
+    }
+
+    auto nq = xq.length / index_->d;
+    std::vector<idx_t> I(k * nq);
+    std::vector<float> D(k * nq);
+
+    SearchStats stats;
+    timer.marshalled();
+    auto lock = readLock();
+    timer.waited();
+    try
+    {
+      runSearch(nq, xq.data, k, D.data(), I.data(), options, &stats);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      metrics_.search.recordError();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    timer.computed();
+
+    Napi::Object results = toTypedSearchResult(env, std::move(D), std::move(I));
+    if (options.withStats)
+    {
+      results.Set("stats", toStatsObject(env, stats));
+    }
+    timer.marshalled();
+    metrics_.search.record(nq, timer);
+    return results;
+  }
+
+  Napi::Value searchInto(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    if (info.Length() < 4 || info.Length() > 5)
+    {
+      Napi::Error::New(env, "Expected 4 or 5 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[2].IsTypedArray() || info[2].As<Napi::TypedArray>().TypedArrayType() != napi_float32_array)
+    {
+      Napi::TypeError::New(env, "Invalid the third argument type, must be a Float32Array.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[3].IsTypedArray() || info[3].As<Napi::TypedArray>().TypedArrayType() != napi_bigint64_array)
+    {
+      Napi::TypeError::New(env, "Invalid the fourth argument type, must be a BigInt64Array.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    FloatInput xq;
+    idx_t k = 0;
+    SearchOptions options;
+    if (!readSearchArgs(info, xq, k) || !readSearchOptions(env, info[4], "fifth", options) || !checkFilter(env, options))
+    {
+      return env.Undefined();
+    }
+
+    auto nq = xq.length / index_->d;
+    auto distances = info[2].As<Napi::Float32Array>();
+    auto labels = info[3].As<Napi::BigInt64Array>();
+    if (distances.ElementLength() < k * nq || labels.ElementLength() < k * nq)
+    {
+      Napi::Error::New(env, "Output arrays must hold at least " + std::to_string(k * nq) + " results.")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    timer.marshalled();
+    auto lock = readLock();
+    timer.waited();
+    try
+    {
+      runSearch(nq, xq.data, k, distances.Data(), labels.Data(), options);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      metrics_.search.recordError();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    timer.computed();
+    metrics_.search.record(nq, timer);
+
+    return Napi::Number::New(env, k * nq);
+  }
+
+  Napi::Value rangeSearch(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    if (info.Length() < 2 || info.Length() > 3)
+    {
+      Napi::Error::New(env, "Expected 2 or 3 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[1].IsNumber())
+    {
+      Napi::TypeError::New(env, "Invalid the second argument type, must be a Number.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    FloatInput xq;
+    SearchOptions options;
+    if (!readVectors(env, info[0], "first", xq) || !readSearchOptions(env, info[2], "third", options) || !checkFilter(env, options))
+    {
+      return env.Undefined();
+    }
+
+    auto nq = xq.length / index_->d;
+    float radius = info[1].As<Napi::Number>().FloatValue();
+    faiss::RangeSearchResult result(nq);
+
+    timer.marshalled();
+    auto lock = readLock();
+    timer.waited();
+    try
+    {
+      runRangeSearch(nq, xq.data, radius, &result, options);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      metrics_.search.recordError();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    timer.computed();
+    lock.unlock();
+
+    Napi::Object results = toRangeSearchResult(env, result);
+    timer.marshalled();
+    metrics_.search.record(nq, timer);
+    return results;
+  }
+
+  Napi::Value searchAsync(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    CallTimer timer;
+
+    FloatInput xq;
+    idx_t k = 0;
+    SearchOptions options;
+    if (!readSearchArgs(info, xq, k, true) || !readSearchOptions(env, info[2], "third", options, true) || !checkFilter(env, options))
+    {
+      return env.Undefined();
+    }
+
+    // queries with their own options can't share a batched search
+    if (batcher_ && options.empty())
+    {
+      return batcher_->Enqueue(env, info.This().As<Napi::Object>(), std::move(xq), k, timer);
+    }
+
+    auto nq = xq.length / index_->d;
+    auto worker = new SearchWorker(env, this, info.This().As<Napi::Object>(), std::move(xq), k, std::move(options));
+    worker->SetMetrics(&metrics_.search, nq, timer);
+    auto promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+  }
+
+  Napi::Value setBatching(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsObject())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be an Object.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    Napi::Object options = info[0].As<Napi::Object>();
+    uint32_t maxBatch = 64;
+    uint32_t maxWaitMicros = 1000;
+    if (options.Has("maxBatch"))
+    {
+      Napi::Value val = options.Get("maxBatch");
+      if (!val.IsNumber())
+      {
+        Napi::TypeError::New(env, "Invalid maxBatch option, must be a Number.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      maxBatch = val.As<Napi::Number>().Uint32Value();
+    }
+    if (options.Has("maxWaitMicros"))
+    {
+      Napi::Value val = options.Get("maxWaitMicros");
+      if (!val.IsNumber())
+      {
+        Napi::TypeError::New(env, "Invalid maxWaitMicros option, must be a Number.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      maxWaitMicros = val.As<Napi::Number>().Uint32Value();
+    }
+
+    // replacing the batcher drains queries already queued on the previous one
+    batcher_.reset();
+    if (maxBatch > 1)
+    {
+      batcher_ = std::make_unique<SearchBatcher>(env, this, maxBatch, std::chrono::microseconds(maxWaitMicros));
+    }
+
+    return env.Undefined();
+  }
+
+  Napi::Value getBatchingStats(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    Napi::Object stats = Napi::Object::New(env);
+    stats.Set("enabled", Napi::Boolean::New(env, batcher_ != nullptr));
+    if (batcher_)
+    {
+      batcher_->GetStats(stats);
+    }
+    return stats;
+  }
+
+  // A snapshot of the counters and latency histograms; reading them never blocks the index.
+  Napi::Value getMetrics(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    auto bounds = Napi::Float64Array::New(env, LatencyHistogram::kBuckets);
+    for (size_t i = 0; i < LatencyHistogram::kBuckets; i++)
+    {
+      bounds[i] = LatencyHistogram::upperBound(i) / 1000.0;
+    }
+
+    Napi::Object metrics = Napi::Object::New(env);
+    metrics.Set("search", metrics_.search.snapshot(env));
+    metrics.Set("add", metrics_.add.snapshot(env));
+    metrics.Set("train", metrics_.train.snapshot(env));
+    metrics.Set("bucketBoundsMs", bounds);
+    return metrics;
+  }
+
+#ifndef _MSC_VER
+  Napi::Value warmup(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() > 1)
+    {
+      Napi::Error::New(env, "Expected 0 or 1 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    size_t maxLists = SIZE_MAX;
+    size_t maxBytes = SIZE_MAX;
+    Napi::Function onProgress;
+    if (info.Length() == 1 && !info[0].IsUndefined())
+    {
+      if (!info[0].IsObject())
+      {
+        Napi::TypeError::New(env, "Invalid the first argument type, must be an Object.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      Napi::Object options = info[0].As<Napi::Object>();
+      // limits are non-negative Numbers, Infinity meaning no limit
+      auto readLimit = [&](const char *name, size_t &limit)
+      {
+        Napi::Value val = options.Get(name);
+        if (val.IsUndefined())
+        {
+          return true;
+        }
+        double number = val.IsNumber() ? val.As<Napi::Number>().DoubleValue() : -1;
+        if (!(number >= 0))
+        {
+          Napi::TypeError::New(env, std::string("Invalid the first argument type, ") + name + " must be a non-negative Number.")
+              .ThrowAsJavaScriptException();
+          return false;
+        }
+        if (number < static_cast<double>(SIZE_MAX))
+        {
+          limit = static_cast<size_t>(number);
+        }
+        return true;
+      };
+      if (!readLimit("maxLists", maxLists) || !readLimit("maxBytes", maxBytes))
+      {
+        return env.Undefined();
+      }
+      if (options.Has("onProgress"))
+      {
+        Napi::Value val = options.Get("onProgress");
+        if (!val.IsFunction())
+        {
+          Napi::TypeError::New(env, "Invalid onProgress option, must be a Function.").ThrowAsJavaScriptException();
+          return env.Undefined();
+        }
+        onProgress = val.As<Napi::Function>();
+      }
+    }
+
+    auto lock = readLock();
+    if (getOnDiskInvertedLists() == nullptr)
+    {
+      Napi::Error::New(env, "Index does not have memory-mapped inverted lists.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    lock.unlock();
+
+    auto worker = new WarmupWorker(env, this, info.This().As<Napi::Object>(), maxLists, maxBytes, onProgress);
+    auto promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
+  }
+
+  Napi::Value setMadvise(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    const std::string advice = info[0].As<Napi::String>().Utf8Value();
+    int flag = 0;
+    if (advice == "normal")
+    {
+      flag = MADV_NORMAL;
+    }
+    else if (advice == "random")
+    {
+      flag = MADV_RANDOM;
+    }
+    else if (advice == "sequential")
+    {
+      flag = MADV_SEQUENTIAL;
+    }
+    else if (advice == "willneed")
+    {
+      flag = MADV_WILLNEED;
+    }
+    else if (advice == "dontneed")
+    {
+      flag = MADV_DONTNEED;
+    }
+    else
+    {
+      Napi::Error::New(env, "Unknown advice '" + advice + "', expected normal, random, sequential, willneed or dontneed.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto lock = readLock();
+    auto od = getOnDiskInvertedLists();
+    if (od == nullptr)
+    {
+      Napi::Error::New(env, "Index does not have memory-mapped inverted lists.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (od->ptr != nullptr && madvise(od->ptr, od->totsize, flag) != 0)
+    {
+      Napi::Error::New(env, std::string("madvise failed: ") + std::strerror(errno)).ThrowAsJavaScriptException();
+    }
+
+    return env.Undefined();
+  }
+
+  // Replace the inverted lists of an IVF index by an OnDiskInvertedLists data file, so that codes
+  // added afterwards are written to the file rather than held in memory. Entries already in the
+  // index are copied to the file.
+  Napi::Value setOnDiskInvertedLists(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    const std::string dataPath = info[0].As<Napi::String>().Utf8Value();
+
+    auto lock = writeLock();
+    try
+    {
+      auto ivf = faiss::ivflib::extract_index_ivf(index_.get());
+      if (ivf->invlists->code_size == faiss::InvertedLists::INVALID_CODE_SIZE)
+      {
+        Napi::Error::New(env, "Inverted lists of this index cannot be stored on disk.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      auto od = new faiss::OnDiskInvertedLists(ivf->nlist, ivf->code_size, dataPath.c_str());
+      if (ivf->ntotal > 0)
+      {
+        const faiss::InvertedLists *lists = ivf->invlists;
+        try
+        {
+          od->merge_from(&lists, 1);
+        }
+        catch (const faiss::FaissException &)
+        {
+          delete od;
+          throw;
+        }
+      }
+      ivf->replace_invlists(od, true);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
+
+    return env.Undefined();
+  }
+#endif // _MSC_VER
+
+  Napi::Value reconstruct(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    idx_t key = -1;
+    if (info[0].IsNumber())
+    {
+      key = info[0].As<Napi::Number>().Int64Value();
+    }
+    else if (info[0].IsBigInt())
+    {
+      auto lossless = false;
+      key = info[0].As<Napi::BigInt>().Int64Value(&lossless);
+    }
+    else
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number or BigInt.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto lock = readLock();
+    float *inpArr = new float[index_->d];
+    Napi::Array outArr = Napi::Array::New(env, index_->d);
+    index_->reconstruct(key, inpArr);
+    for (size_t i = 0; i < index_->d; i++)
+    {
+      outArr[i] = Napi::Number::New(env, inpArr[i]);
+    }
+    delete[] inpArr;
+
+    return outArr;
+  }
+
+  Napi::Value reconstructBatch(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1 || !info[0].IsArray())
+    {
+      Napi::Error::New(env, "Expected 1 array argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    Napi::Array keysArr = info[0].As<Napi::Array>();
+    auto keyCount = keysArr.Length();
+    idx_t *keys = new idx_t[keyCount];
+    for (size_t i = 0; i < keyCount; i++)
+    {
+      Napi::Value val = keysArr[i];
+      if (val.IsNumber())
+      {
+        keys[i] = val.As<Napi::Number>().Int64Value();
+      }
+      else if (val.IsBigInt())
+      {
+        auto lossless = false;
+        keys[i] = val.As<Napi::BigInt>().Int64Value(&lossless);
+      }
+      else
+      {
+        Napi::TypeError::New(env, "Invalid the first argument type, must be a Number or BigInt.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+    }
+
+    auto lock = readLock();
+    auto dimCount = keyCount * index_->d;
+    float *inpArr = new float[dimCount];
+    Napi::Array outArr = Napi::Array::New(env, dimCount);
+    index_->reconstruct_batch(keyCount, keys, inpArr);
+    for (size_t i = 0; i < dimCount; i++)
+    {
+      outArr[i] = Napi::Number::New(env, inpArr[i]);
+    }
+    delete[] keys;
+    delete[] inpArr;
+
+    return outArr;
+  }
+
+  Napi::Value write(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    const std::string fname = info[0].As<Napi::String>().Utf8Value();
+
+    auto lock = readLock();
+    try
+    {
+      faiss::write_index(index_.get(), fname.c_str());
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
+
+    return env.Undefined();
+  }
+
+  Napi::Value mergeFrom(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsObject())
+    {
+      Napi::TypeError::New(env, "Invalid argument type, must be an object.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto otherIndexInstance = unwrapInstance(info[0]);
+    if (otherIndexInstance == nullptr || !otherIndexInstance->index_)
+    {
+      Napi::TypeError::New(env, "Invalid argument, must be an Index that is not disposed.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    if (isPartOf(this, otherIndexInstance) || isPartOf(otherIndexInstance, this))
+    {
+      Napi::Error::New(env, "The merging index must not be a part of this index, nor contain it.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    if (otherIndexInstance->index_->d != index_->d)
+    {
+      Napi::Error::New(env, "The merging index must have the same dimension.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    IndexLocks locks;
+    locks.add(this, true);
+    locks.add(otherIndexInstance, false);
+    locks.lock();
+    try
+    {
+      index_->merge_from(*(otherIndexInstance->index_));
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    return env.Undefined();
+  }
+
+  Napi::Value removeIds(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!isIdInput(info[0]))
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be an Array.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    IdInput xb;
+    if (!readIds(env, info[0], xb))
+    {
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    size_t num = index_->remove_ids(faiss::IDSelectorArray{xb.length, xb.data});
+
+    return Napi::Number::New(info.Env(), num);
+  }
+
+  Napi::Value toBuffer(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 0)
+    {
+      Napi::Error::New(env, "Expected 0 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto writer = new faiss::VectorIOWriter();
+
+    auto lock = readLock();
+    try
+    {
+      writer->data.reserve(serializedSizeHint(index_.get()));
+      faiss::write_index(index_.get(), writer);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      delete writer;
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    // hand the serialized bytes to JS as-is, they are freed with the buffer
+    return Napi::Buffer<uint8_t>::New(
+        env, writer->data.data(), writer->data.size(),
+        [](Napi::Env, uint8_t *, faiss::VectorIOWriter *hint)
+        { delete hint; },
+        writer);
+  }
+
+  Napi::Value writeStream(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() < 1 || info.Length() > 2)
+    {
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!isStream(info[0], "write"))
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a writable stream.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    size_t chunkSize = 1 << 20;
+    if (info.Length() > 1)
+    {
+      if (!info[1].IsObject())
+      {
+        Napi::TypeError::New(env, "Invalid the second argument type, must be an Object.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      Napi::Object options = info[1].As<Napi::Object>();
+      if (options.Has("chunkSize"))
+      {
+        Napi::Value val = options.Get("chunkSize");
+        if (!val.IsNumber() || val.As<Napi::Number>().Int64Value() <= 0)
+        {
+          Napi::TypeError::New(env, "Invalid chunkSize option, must be a positive Number.").ThrowAsJavaScriptException();
+          return env.Undefined();
+        }
+        chunkSize = val.As<Napi::Number>().Int64Value();
+      }
+    }
+    auto writer = new StreamWriter(env, this, info.This().As<Napi::Object>(), info[0].As<Napi::Object>(), chunkSize);
+    return writer->Start(env);
+  }
+
+  Napi::Value toIDMap2(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 0)
+    {
+      Napi::Error::New(env, "Expected 0 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    Napi::Object instance = T::constructor->New({});
+    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+
+    try
+    {
+      // wrap the new IDMap'd index around the old and leave it to faiss to throw if index not compatible
+      index->index_ = std::unique_ptr<faiss::IndexIDMap2>(new faiss::IndexIDMap2(index_.get()));
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
+
+    return instance;
+  }
+
+  Napi::Value toRefineFlat(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() > 1)
+    {
+      Napi::Error::New(env, "Expected 0 or 1 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (info.Length() > 0 && !isKFactor(info[0]))
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number of at least 1.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    return toRefineIndex(env, env.Undefined(), info[0]);
+  }
+
+  Napi::Value toRefine(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() < 1 || info.Length() > 2)
+    {
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsObject())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be an Index.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (info.Length() > 1 && !isKFactor(info[1]))
+    {
+      Napi::TypeError::New(env, "Invalid the second argument type, must be a Number of at least 1.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto refineInstance = unwrapInstance(info[0]);
+    if (refineInstance == nullptr || !refineInstance->index_)
+    {
+      Napi::TypeError::New(env, "Invalid the first argument, must be an Index that is not disposed.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (refineInstance == this || areLinked(this, refineInstance))
+    {
+      Napi::Error::New(env, "Invalid the first argument, must be another Index not sharing parts with this one.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (refineInstance->index_->ntotal != index_->ntotal)
+    {
+      Napi::Error::New(env, "The refine index must hold as many vectors as this index.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    return toRefineIndex(env, info[0], info[1]);
+  }
+
+  Napi::Value getKFactor(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    auto refine = unwrap<faiss::IndexRefine>();
+    if (refine == nullptr)
+    {
+      return env.Undefined();
+    }
+    return Napi::Number::New(env, refine->k_factor);
+  }
+
+  Napi::Value setKFactor(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!isKFactor(info[0]))
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number of at least 1.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    auto refine = unwrap<faiss::IndexRefine>();
+    if (refine == nullptr)
+    {
+      Napi::Error::New(env, "kFactor can only be set on an index made by toRefineFlat or toRefine.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    refine->k_factor = info[0].As<Napi::Number>().FloatValue();
+    return env.Undefined();
+  }
+
+  // Add an index, or the index file at a path, as a shard. Vectors added to or removed from a shard
+  // directly are not reflected in ntotal of this index.
+  Napi::Value addShard(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    return addSubIndex(info, dynamic_cast<faiss::IndexShards *>(index_.get()), "addShard can only be called on an IndexShards.");
+  }
+
+  Napi::Value getNShards(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    auto shards = dynamic_cast<faiss::IndexShards *>(index_.get());
+    return Napi::Number::New(info.Env(), shards->count());
+  }
+
+  // Add an index, or the index file at a path, as a replica. Replicas must hold the same vectors;
+  // additions through this index go to every replica, each write-locked like this index.
+  Napi::Value addReplica(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    return addSubIndex(info, dynamic_cast<faiss::IndexReplicas *>(index_.get()), "addReplica can only be called on an IndexReplicas.");
+  }
+
+  Napi::Value getNReplicas(const Napi::CallbackInfo &info)
+  {
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    auto replicas = dynamic_cast<faiss::IndexReplicas *>(index_.get());
+    return Napi::Number::New(info.Env(), replicas->count());
+  }
+
+protected:
+  // Base for promise returning methods: the faiss call runs in Run() on the libuv
+  // thread pool while the owning JS object is kept alive by a persistent reference.
+  class IndexWorker : public Napi::AsyncWorker
+  {
+  public:
+    IndexWorker(Napi::Env env, IndexBase *self, Napi::Object owner, bool exclusive)
+        : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)), self_(self), owner_(Napi::Persistent(owner)), exclusive_(exclusive)
+    {
+    }
+
+    Napi::Promise GetPromise()
+    {
+      return deferred_.Promise();
+    }
+
+    void SetThreads(int threads)
+    {
+      threads_ = threads;
+    }
+
+    // Record the call in `metrics` once settled, `timer` having measured its argument conversion.
+    void SetMetrics(OperationMetrics *metrics, size_t n, const CallTimer &timer)
+    {
+      metrics_ = metrics;
+      n_ = n;
+      timer_ = timer;
+      timer_.marshalled();
+    }
+
+  protected:
+    virtual void Run() = 0;
+
+    virtual Napi::Value Result(Napi::Env env)
+    {
+      return env.Undefined();
+    }
+
+    void Execute() override
+    {
+      try
+      {
+        std::shared_lock<IndexMutex> sharedLock;
+        std::unique_lock<IndexMutex> exclusiveLock;
+        if (exclusive_)
+        {
+          exclusiveLock = self_->writeLock();
+        }
+        else
+        {
+          sharedLock = self_->readLock();
+        }
+        if (!self_->index_)
+        {
+          SetError("Index has been disposed.");
+          return;
+        }
+        OmpThreadsScope threads(threads_);
+        timer_.waited();
+        Run();
+        timer_.computed();
+      }
+      catch (const faiss::FaissException &ex)
+      {
+        SetError(ex.what());
+      }
+    }
+
+    void OnOK() override
+    {
+      timer_.waited();
+      Napi::Value result = Result(Env());
+      if (metrics_)
+      {
+        timer_.marshalled();
+        metrics_->record(n_, timer_);
+      }
+      deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error &e) override
+    {
+      if (metrics_)
+      {
+        metrics_->recordError();
+      }
+      deferred_.Reject(e.Value());
+    }
+
+    Napi::Promise::Deferred deferred_;
+    IndexBase *self_;
+    Napi::ObjectReference owner_;
+    bool exclusive_;
+    int threads_ = 0;
+    OperationMetrics *metrics_ = nullptr;
+    size_t n_ = 0;
+    CallTimer timer_;
+  };
+
+  class AddWorker : public IndexWorker
+  {
+  public:
+    AddWorker(Napi::Env env, IndexBase *self, Napi::Object owner, FloatInput &&xb, IdInput &&xids, bool withIds)
+        : IndexWorker(env, self, owner, true), xb_(std::move(xb)), xids_(std::move(xids)), withIds_(withIds)
+    {
+    }
+
+  protected:
+    void Run() override
+    {
+      auto index = this->self_->index_.get();
+      if (withIds_)
+      {
+        index->add_with_ids(xids_.length, xb_.data, xids_.data);
+      }
+      else
+      {
+        index->add(xb_.length / index->d, xb_.data);
+      }
+    }
+
+  private:
+    FloatInput xb_;
+    IdInput xids_;
+    bool withIds_;
+  };
+
+  class TrainWorker : public IndexWorker
+  {
+  public:
+    TrainWorker(Napi::Env env, IndexBase *self, Napi::Object owner, FloatInput &&xb)
+        : IndexWorker(env, self, owner, true), xb_(std::move(xb))
+    {
+    }
+
+  protected:
+    void Run() override
+    {
+      auto index = this->self_->index_.get();
+      index->train(xb_.length / index->d, xb_.data);
+    }
+
+  private:
+    FloatInput xb_;
+  };
+
+  class SearchWorker : public IndexWorker
+  {
+  public:
+    SearchWorker(Napi::Env env, IndexBase *self, Napi::Object owner, FloatInput &&xq, idx_t k, SearchOptions &&options)
+        : IndexWorker(env, self, owner, false), xq_(std::move(xq)), k_(k), options_(std::move(options))
+    {
+    }
+
+  protected:
+    void Run() override
+    {
+      auto nq = xq_.length / this->self_->index_->d;
+      I_.resize(k_ * nq);
+      D_.resize(k_ * nq);
+      this->self_->runSearch(nq, xq_.data, k_, D_.data(), I_.data(), options_, &stats_);
+    }
+
+    Napi::Value Result(Napi::Env env) override
+    {
+      Napi::Object results = toSearchResult(env, D_, I_);
+      if (options_.withStats)
+      {
+        results.Set("stats", toStatsObject(env, stats_));
+      }
+      return results;
+    }
+
+  private:
+    FloatInput xq_;
+    idx_t k_;
+    SearchOptions options_;
+    SearchStats stats_;
+    std::vector<float> D_;
+    std::vector<idx_t> I_;
+  };
+
+#ifndef _MSC_VER
+  struct WarmupProgress
+  {
+    size_t lists;
+    size_t bytes;
+  };
+
+  // Faults in the memory-mapped inverted lists, largest first, within the given list and byte budgets.
+  class WarmupWorker : public Napi::AsyncProgressWorker<WarmupProgress>
+  {
+  public:
+    WarmupWorker(Napi::Env env, IndexBase *self, Napi::Object owner, size_t maxLists, size_t maxBytes, Napi::Function onProgress)
+        : Napi::AsyncProgressWorker<WarmupProgress>(env), deferred_(Napi::Promise::Deferred::New(env)), self_(self),
+          owner_(Napi::Persistent(owner)), maxLists_(maxLists), maxBytes_(maxBytes), done_{0, 0}
+    {
+      if (!onProgress.IsEmpty())
+      {
+        onProgress_ = Napi::Persistent(onProgress);
+      }
+    }
+
+    Napi::Promise GetPromise()
+    {
+      return deferred_.Promise();
+    }
+
+  protected:
+    void Execute(const typename Napi::AsyncProgressWorker<WarmupProgress>::ExecutionProgress &progress) override
+    {
+      auto lock = self_->readLock();
+      auto od = self_->index_ ? self_->getOnDiskInvertedLists() : nullptr;
+      if (od == nullptr)
+      {
+        this->SetError("Index does not have memory-mapped inverted lists.");
+        return;
+      }
+
+      const size_t entrySize = od->code_size + sizeof(idx_t);
+      std::vector<size_t> order(od->nlist);
+      for (size_t i = 0; i < order.size(); i++)
+      {
+        order[i] = i;
+      }
+      std::sort(order.begin(), order.end(), [od](size_t a, size_t b)
+                { return od->list_size(a) > od->list_size(b); });
+
+      const size_t pageSize = sysconf(_SC_PAGESIZE);
+      for (auto list_no : order)
+      {
+        auto size = od->list_size(list_no);
+        if (size == 0 || done_.lists >= maxLists_ || done_.bytes + size * entrySize > maxBytes_)
+        {
+          break;
+        }
+        done_.bytes += touch(od->get_codes(list_no), size * od->code_size, pageSize);
+        done_.bytes += touch(reinterpret_cast<const uint8_t *>(od->get_ids(list_no)), size * sizeof(idx_t), pageSize);
+        done_.lists++;
+        progress.Send(&done_, 1);
+      }
+    }
+
+    void OnProgress(const WarmupProgress *data, size_t count) override
+    {
+      if (data == nullptr || onProgress_.IsEmpty())
+      {
+        return;
+      }
+      onProgress_.Call({toObject(this->Env(), *data)});
+    }
+
+    void OnOK() override
+    {
+      deferred_.Resolve(toObject(this->Env(), done_));
+    }
+
+    void OnError(const Napi::Error &e) override
+    {
+      deferred_.Reject(e.Value());
+    }
+
+  private:
+    // Read one byte per page so the page faults happen here rather than in the first searches.
+    static size_t touch(const uint8_t *data, size_t length, size_t pageSize)
+    {
+      if (length == 0)
+      {
+        return 0;
+      }
+      auto begin = reinterpret_cast<uintptr_t>(data);
+      auto start = begin & ~(pageSize - 1);
+      madvise(reinterpret_cast<void *>(start), begin + length - start, MADV_WILLNEED);
+      volatile uint8_t sink = 0;
+      for (size_t offset = 0; offset < length; offset += pageSize)
+      {
+        sink += data[offset];
+      }
+      sink += data[length - 1];
+      return length;
+    }
+
+    static Napi::Object toObject(Napi::Env env, const WarmupProgress &progress)
+    {
+      Napi::Object obj = Napi::Object::New(env);
+      obj.Set("lists", Napi::Number::New(env, progress.lists));
+      obj.Set("bytes", Napi::Number::New(env, progress.bytes));
+      return obj;
+    }
+
+    Napi::Promise::Deferred deferred_;
+    IndexBase *self_;
+    Napi::ObjectReference owner_;
+    Napi::FunctionReference onProgress_;
+    size_t maxLists_;
+    size_t maxBytes_;
+    WarmupProgress done_;
+  };
+
+  struct MergeOptions
+  {
+    std::string outputIndexPath;
+    std::string outputDataPath;
+    bool append = false;
+    int threads = 0;
+  };
+
+  struct MergeProgress
+  {
+    size_t lists;
+    size_t totalLists;
+    size_t entries;
+  };
+
+  // Merges the inverted lists of IVF inputs into an OnDiskInvertedLists data file, then writes an
+  // index using it. The first input provides the trained structure of a new output; with `append`
+  // the existing output index is extended instead: its lists are resized in place, so only lists
+  // outgrowing their capacity move within the data file. Each list is copied by one OpenMP thread,
+  // progress is reported after every chunk of lists. Inputs are never modified.
+  class MergeWorker : public Napi::AsyncProgressWorker<MergeProgress>
+  {
+  public:
+    MergeWorker(Napi::Env env, MergeOptions &&options, Napi::Function onProgress)
+        : Napi::AsyncProgressWorker<MergeProgress>(env), deferred_(Napi::Promise::Deferred::New(env)), options_(std::move(options)), done_{0, 0, 0}
+    {
+      if (!onProgress.IsEmpty())
+      {
+        onProgress_ = Napi::Persistent(onProgress);
+      }
+    }
+
+    Napi::Promise GetPromise()
+    {
+      return deferred_.Promise();
+    }
+
+    void AddInput(const std::string &path)
+    {
+      inputs_.push_back({path, nullptr});
+    }
+
+    void AddInput(Napi::Object index)
+    {
+      inputs_.push_back({"", unwrapInstance(index)});
+      refs_.push_back(Napi::Persistent(index));
+    }
+
+  protected:
+    void Execute(const typename Napi::AsyncProgressWorker<MergeProgress>::ExecutionProgress &progress) override
+    {
+      try
+      {
+        Merge(progress);
+      }
+      catch (const faiss::FaissException &ex)
+      {
+        this->SetError(ex.what());
+      }
+    }
+
+    void OnProgress(const MergeProgress *data, size_t count) override
+    {
+      if (data == nullptr || onProgress_.IsEmpty())
+      {
+        return;
+      }
+      onProgress_.Call({toObject(this->Env(), *data)});
+    }
+
+    void OnOK() override
+    {
+      Napi::Object result = toObject(this->Env(), done_);
+      result.Set("ntotal", Napi::Number::New(this->Env(), ntotal_));
+      deferred_.Resolve(result);
+    }
+
+    void OnError(const Napi::Error &e) override
+    {
+      deferred_.Reject(e.Value());
+    }
+
+  private:
+    struct Input
+    {
+      std::string path;
+      IndexBase *index;
+    };
+
+    void Merge(const typename Napi::AsyncProgressWorker<MergeProgress>::ExecutionProgress &progress)
+    {
+      // the first input is written with the merged lists in place of its own when not appending,
+      // so it is locked exclusively; the others are only read
+      IndexLocks locks;
+      for (size_t i = 0; i < inputs_.size(); i++)
+      {
+        if (inputs_[i].index != nullptr)
+        {
+          locks.add(inputs_[i].index, i == 0 && !options_.append);
+        }
+      }
+      locks.lock();
+
+      std::vector<std::unique_ptr<faiss::Index>> owned;
+      std::vector<faiss::IndexIVF *> ivfs;
+      for (size_t i = 0; i < inputs_.size(); i++)
+      {
+        auto &input = inputs_[i];
+        faiss::Index *index = nullptr;
+        if (input.index != nullptr)
+        {
+          index = input.index->index_.get();
+          if (index == nullptr)
+          {
+            this->SetError("Index has been disposed.");
+            return;
+          }
+        }
+        else
+        {
+          owned.emplace_back(faiss::read_index(input.path.c_str(), faiss::IO_FLAG_MMAP));
+          index = owned.back().get();
+        }
+        ivfs.push_back(faiss::ivflib::extract_index_ivf(index));
+      }
+
+      std::unique_ptr<faiss::Index> output;
+      std::unique_ptr<faiss::OnDiskInvertedLists> created;
+      faiss::IndexIVF *templ = nullptr;
+      faiss::OnDiskInvertedLists *od = nullptr;
+      if (options_.append)
+      {
+        output.reset(faiss::read_index(options_.outputIndexPath.c_str()));
+        templ = faiss::ivflib::extract_index_ivf(output.get());
+        od = dynamic_cast<faiss::OnDiskInvertedLists *>(templ->invlists);
+        if (od == nullptr || od->filename != options_.outputDataPath)
+        {
+          this->SetError("The output index does not use the given data file.");
+          return;
+        }
+      }
+      else
+      {
+        templ = ivfs[0];
+        created.reset(new faiss::OnDiskInvertedLists(templ->nlist, templ->code_size, options_.outputDataPath.c_str()));
+        od = created.get();
+      }
+
+      const size_t nlist = od->nlist;
+      std::vector<size_t> offsets(nlist);
+      std::vector<size_t> added(nlist, 0);
+      for (auto ivf : ivfs)
+      {
+        if (ivf->nlist != nlist || ivf->code_size != od->code_size)
+        {
+          this->SetError("Inverted lists of all indexes must have the same number of lists and code size.");
+          return;
+        }
+        for (size_t j = 0; j < nlist; j++)
+        {
+          added[j] += ivf->invlists->list_size(j);
+        }
+      }
+
+      if (options_.append)
+      {
+        // resizing may grow and remap the data file, so it is done before any copy
+        for (size_t j = 0; j < nlist; j++)
+        {
+          offsets[j] = od->list_size(j);
+          if (added[j] > 0)
+          {
+            od->resize(j, offsets[j] + added[j]);
+          }
+        }
+      }
+      else
+      {
+        // pack the lists back to back and size the file once, as OnDiskInvertedLists::merge_from
+        size_t totsize = 0;
+        for (size_t j = 0; j < nlist; j++)
+        {
+          auto &list = od->lists[j];
+          list.size = list.capacity = added[j];
+          list.offset = totsize;
+          totsize += added[j] * (sizeof(idx_t) + od->code_size);
+        }
+        od->update_totsize(totsize);
+        od->slots.clear();
+      }
+
+      done_.totalLists = nlist;
+      const size_t chunk = std::max<size_t>(1, nlist / 100);
+      OmpThreadsScope threads(options_.threads);
+      for (size_t begin = 0; begin < nlist; begin += chunk)
+      {
+        const size_t end = std::min(nlist, begin + chunk);
+        std::string error;
+#pragma omp parallel for schedule(dynamic)
+        for (int64_t j = begin; j < static_cast<int64_t>(end); j++)
+        {
+          try
+          {
+            auto offset = offsets[j];
+            for (auto ivf : ivfs)
+            {
+              auto il = ivf->invlists;
+              auto n = il->list_size(j);
+              if (n == 0)
+              {
+                continue;
+              }
+              faiss::InvertedLists::ScopedIds ids(il, j);
+              faiss::InvertedLists::ScopedCodes codes(il, j);
+              od->update_entries(j, offset, n, ids.get(), codes.get());
+              offset += n;
+            }
+          }
+          catch (const std::exception &ex)
+          {
+            // exceptions must not leave the parallel region
+#pragma omp critical
+            error = ex.what();
+          }
+        }
+        if (!error.empty())
+        {
+          this->SetError(error);
+          return;
+        }
+
+        for (size_t j = begin; j < end; j++)
+        {
+          done_.entries += added[j];
+        }
+        done_.lists = end;
+        progress.Send(&done_, 1);
+      }
+
+      if (options_.append)
+      {
+        templ->ntotal += done_.entries;
+        faiss::write_index(templ, options_.outputIndexPath.c_str());
+        ntotal_ = templ->ntotal;
+        return;
+      }
+
+      // write the first input with the merged lists swapped in, then restore it
+      auto lists = templ->invlists;
+      auto ownLists = templ->own_invlists;
+      auto ntotal = templ->ntotal;
+      templ->invlists = od;
+      templ->own_invlists = false;
+      templ->ntotal = done_.entries;
+      try
+      {
+        faiss::write_index(templ, options_.outputIndexPath.c_str());
+      }
+      catch (const faiss::FaissException &)
+      {
+        templ->invlists = lists;
+        templ->own_invlists = ownLists;
+        templ->ntotal = ntotal;
+        throw;
+      }
+      templ->invlists = lists;
+      templ->own_invlists = ownLists;
+      templ->ntotal = ntotal;
+      ntotal_ = done_.entries;
+    }
+
+    static Napi::Object toObject(Napi::Env env, const MergeProgress &progress)
+    {
+      Napi::Object obj = Napi::Object::New(env);
+      obj.Set("lists", Napi::Number::New(env, progress.lists));
+      obj.Set("totalLists", Napi::Number::New(env, progress.totalLists));
+      obj.Set("entries", Napi::Number::New(env, progress.entries));
+      return obj;
+    }
+
+    Napi::Promise::Deferred deferred_;
+    MergeOptions options_;
+    std::vector<Input> inputs_;
+    std::vector<Napi::ObjectReference> refs_;
+    Napi::FunctionReference onProgress_;
+    MergeProgress done_;
+    idx_t ntotal_ = 0;
+  };
+
+  // The memory-mapped inverted lists of an IVF index (possibly wrapped), or nullptr.
+  faiss::OnDiskInvertedLists *getOnDiskInvertedLists()
+  {
+    try
+    {
+      auto ivf = faiss::ivflib::extract_index_ivf(index_.get());
+      return dynamic_cast<faiss::OnDiskInvertedLists *>(ivf->invlists);
+    }
+    catch (const faiss::FaissException &)
+    {
+      return nullptr;
+    }
+  }
+#endif // _MSC_VER
+
+  // Coalesces concurrent searchAsync calls into a single index_->search on a dispatcher thread.
+  // The first queued query waits at most maxWait for up to maxBatch query vectors sharing its k,
+  // then each promise is settled with its slice of the combined result via a thread-safe function.
+  class SearchBatcher
+  {
+  public:
+    SearchBatcher(Napi::Env env, IndexBase *self, size_t maxBatch, std::chrono::microseconds maxWait)
+        : self_(self), maxBatch_(maxBatch), maxWait_(maxWait), shared_(std::make_shared<Shared>())
+    {
+      shared_->tsfn = Napi::ThreadSafeFunction::New(
+          env, Napi::Function::New(env, [](const Napi::CallbackInfo &) {}), "faiss-napi.SearchBatcher", 0, 1);
+      // only keep the event loop alive while queries are pending
+      shared_->tsfn.Unref(env);
+      thread_ = std::thread([this]
+                            { Dispatch(); });
+    }
+
+    ~SearchBatcher()
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+      }
+      cv_.notify_one();
+      thread_.join();
+      shared_->tsfn.Release();
+    }
+
+    Napi::Promise Enqueue(Napi::Env env, Napi::Object owner, FloatInput &&xq, idx_t k, const CallTimer &timer)
+    {
+      auto request = new Request{
+          Napi::Promise::Deferred::New(env), Napi::Persistent(owner), shared_, std::move(xq), 0, k, std::chrono::steady_clock::now(),
+          &self_->metrics_.search, timer};
+      request->nq = request->xq.length / self_->index_->d;
+      request->timer.marshalled();
+      auto promise = request->deferred.Promise();
+
+      if (shared_->pending++ == 0)
+      {
+        shared_->tsfn.Ref(env);
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        queue_.push_back(request);
+        queuedVectors_ += request->nq;
+      }
+      cv_.notify_one();
+
+      return promise;
+    }
+
+    void GetStats(Napi::Object &stats)
+    {
+      Napi::Env env = stats.Env();
+      size_t batches = batches_;
+      size_t vectors = vectors_;
+      stats.Set("maxBatch", Napi::Number::New(env, maxBatch_));
+      stats.Set("maxWaitMicros", Napi::Number::New(env, maxWait_.count()));
+      stats.Set("batches", Napi::Number::New(env, batches));
+      stats.Set("queries", Napi::Number::New(env, queries_));
+      stats.Set("vectors", Napi::Number::New(env, vectors));
+      stats.Set("maxBatchSize", Napi::Number::New(env, maxBatchSize_));
+      stats.Set("averageBatchSize", Napi::Number::New(env, batches == 0 ? 0.0 : static_cast<double>(vectors) / batches));
+    }
+
+  private:
+    // state shared with settle callbacks, which may run after the batcher is destroyed
+    struct Shared
+    {
+      Napi::ThreadSafeFunction tsfn;
+      size_t pending = 0; // only touched on the JS thread
+    };
+
+    struct Request
+    {
+      Napi::Promise::Deferred deferred;
+      Napi::ObjectReference owner;
+      std::shared_ptr<Shared> shared;
+      FloatInput xq;
+      size_t nq;
+      idx_t k;
+      std::chrono::steady_clock::time_point enqueued;
+      OperationMetrics *metrics; // of the index, kept alive by `owner`
+      CallTimer timer;
+      std::vector<float> D;
+      std::vector<idx_t> I;
+      std::string error;
+    };
+
+    void Dispatch()
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (true)
+      {
+        cv_.wait(lock, [this]
+                 { return stopping_ || !queue_.empty(); });
+        if (queue_.empty())
+        { // stopping with nothing left to drain
+          break;
+        }
+        cv_.wait_until(lock, queue_.front()->enqueued + maxWait_, [this]
+                       { return stopping_ || queuedVectors_ >= maxBatch_; });
+
+        std::vector<Request *> batch;
+        size_t nq = 0;
+        idx_t k = queue_.front()->k;
+        for (auto it = queue_.begin(); it != queue_.end() && nq < maxBatch_;)
+        {
+          auto request = *it;
+          if (request->k == k && (batch.empty() || nq + request->nq <= maxBatch_))
+          {
+            batch.push_back(request);
+            nq += request->nq;
+            it = queue_.erase(it);
+          }
+          else
+          {
+            ++it;
+          }
+        }
+        queuedVectors_ -= nq;
+
+        lock.unlock();
+        Search(batch, nq, k);
+        lock.lock();
+      }
+    }
+
+    void Search(const std::vector<Request *> &batch, size_t nq, idx_t k)
+    {
+      auto lock = self_->readLock();
+      auto index = self_->index_.get();
+
+      std::vector<float> combined;
+      const float *xq = batch[0]->xq.data;
+      if (batch.size() > 1)
+      {
+        combined.reserve(nq * index->d);
+        for (auto request : batch)
+        {
+          combined.insert(combined.end(), request->xq.data, request->xq.data + request->xq.length);
+        }
+        xq = combined.data();
+      }
+
+      std::vector<float> D(nq * k);
+      std::vector<idx_t> I(nq * k);
+      std::string error;
+      auto start = Clock::now();
+      try
+      {
+        OmpThreadsScope threads;
+        index->search(nq, xq, k, D.data(), I.data());
+      }
+      catch (const std::exception &ex)
+      {
+        error = ex.what();
+      }
+      auto native = Clock::now() - start;
+      lock.unlock();
+
+      batches_++;
+      queries_ += batch.size();
+      vectors_ += nq;
+      if (nq > maxBatchSize_)
+      {
+        maxBatchSize_ = nq;
+      }
+
+      size_t offset = 0;
+      for (auto request : batch)
+      {
+        auto n = request->nq * k;
+        request->timer.addNative(native);
+        if (error.empty())
+        {
+          request->D.assign(D.begin() + offset, D.begin() + offset + n);
+          request->I.assign(I.begin() + offset, I.begin() + offset + n);
+        }
+        else
+        {
+          request->error = error;
+        }
+        offset += n;
+        shared_->tsfn.BlockingCall(request, Settle);
+      }
+    }
+
+    static void Settle(Napi::Env env, Napi::Function, Request *request)
+    {
+      if (request->error.empty())
+      {
+        request->timer.waited();
+        Napi::Object results = toSearchResult(env, request->D, request->I);
+        request->timer.marshalled();
+        request->metrics->record(request->nq, request->timer);
+        request->deferred.Resolve(results);
+      }
+      else
+      {
+        request->metrics->recordError();
+        request->deferred.Reject(Napi::Error::New(env, request->error).Value());
+      }
+      if (--request->shared->pending == 0)
+      {
+        request->shared->tsfn.Unref(env);
+      }
+      delete request;
+    }
+
+    IndexBase *self_;
+    const size_t maxBatch_;
+    const std::chrono::microseconds maxWait_;
+    std::shared_ptr<Shared> shared_;
+    std::thread thread_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<Request *> queue_;
+    size_t queuedVectors_ = 0;
+    bool stopping_ = false;
+    std::atomic<size_t> batches_{0};
+    std::atomic<size_t> queries_{0};
+    std::atomic<size_t> vectors_{0};
+    std::atomic<size_t> maxBatchSize_{0};
+  };
+
+  // Serializes the index on a dedicated thread into fixed-size chunks that are written to a Node
+  // writable stream on the JS thread. The thread waits for each chunk to be accepted, or for the
+  // stream's 'drain' event, before producing the next one, so at most one chunk is held in memory.
+  class StreamWriter : public faiss::IOWriter
+  {
+  public:
+    StreamWriter(Napi::Env env, IndexBase *self, Napi::Object owner, Napi::Object stream, size_t chunkSize)
+        : deferred_(Napi::Promise::Deferred::New(env)), self_(self), chunkSize_(chunkSize)
+    {
+      name = "stream";
+      owner_ = Napi::Persistent(owner);
+      stream_ = Napi::Persistent(stream);
+      onDrain_ = Napi::Persistent(Napi::Function::New(env, [this](const Napi::CallbackInfo &)
+                                                      { Resume(std::string()); }));
+      onError_ = Napi::Persistent(Napi::Function::New(env, [this](const Napi::CallbackInfo &info)
+                                                      { Resume(errorMessage(info[0])); }));
+    }
+
+    Napi::Promise Start(Napi::Env env)
+    {
+      auto promise = deferred_.Promise();
+      callMethod(stream_.Value(), "on", {Napi::String::New(env, "error"), onError_.Value()});
+      self_->mutex_.addStreams(1);
+      tsfn_ = Napi::ThreadSafeFunction::New(
+          env, Napi::Function::New(env, [](const Napi::CallbackInfo &) {}), "faiss-napi.StreamWriter", 0, 1, this,
+          [](Napi::Env, StreamWriter *writer)
+          {
+            writer->thread_.join();
+            delete writer;
+          });
+      thread_ = std::thread([this]
+                            { Run(); });
+      return promise;
+    }
+
+    size_t operator()(const void *ptr, size_t size, size_t nitems) override
+    {
+      auto bytes = static_cast<const uint8_t *>(ptr);
+      size_t remaining = size * nitems;
+      while (remaining > 0)
+      {
+        size_t n = std::min(remaining, chunkSize_ - chunk_.size());
+        chunk_.insert(chunk_.end(), bytes, bytes + n);
+        bytes += n;
+        remaining -= n;
+        if (chunk_.size() == chunkSize_)
+        {
+          Flush();
+        }
+      }
+      return nitems;
+    }
+
+  private:
+    void Run()
+    {
+      {
+        auto lock = self_->readLock();
+        try
+        {
+          chunk_.reserve(chunkSize_);
+          faiss::write_index(self_->index_.get(), this);
+          Flush();
+        }
+        catch (const std::exception &ex)
+        {
+          error_ = ex.what();
+        }
+      }
+      tsfn_.BlockingCall(this, [](Napi::Env env, Napi::Function, StreamWriter *writer)
+                         { writer->Finish(env); });
+    }
+
+    // Hand the current chunk to the JS thread and wait until the stream accepted it.
+    void Flush()
+    {
+      if (chunk_.empty())
+      {
+        return;
+      }
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!streamError_.empty())
+        {
+          throw faiss::FaissException(streamError_);
+        }
+        accepted_ = false;
+      }
+
+      auto chunk = new std::vector<uint8_t>(std::move(chunk_));
+      chunk_ = std::vector<uint8_t>();
+      chunk_.reserve(chunkSize_);
+      written_ += chunk->size();
+      if (tsfn_.BlockingCall(chunk, [this](Napi::Env env, Napi::Function, std::vector<uint8_t> *chunk)
+                             { Push(env, chunk); }) != napi_ok)
+      {
+        delete chunk;
+        throw faiss::FaissException("Stream was closed.");
+      }
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock, [this]
+               { return accepted_ || !streamError_.empty(); });
+      if (!streamError_.empty())
+      {
+        throw faiss::FaissException(streamError_);
+      }
+    }
+
+    void Push(Napi::Env env, std::vector<uint8_t> *chunk)
+    {
+      try
+      {
+        auto buffer = Napi::Buffer<uint8_t>::New(
+            env, chunk->data(), chunk->size(),
+            [](Napi::Env, uint8_t *, std::vector<uint8_t> *hint)
+            { delete hint; },
+            chunk);
+        auto stream = stream_.Value();
+        if (callMethod(stream, "write", {buffer}).ToBoolean())
+        {
+          Resume(std::string());
+        }
+        else
+        {
+          callMethod(stream, "once", {Napi::String::New(env, "drain"), onDrain_.Value()});
+        }
+      }
+      catch (const Napi::Error &e)
+      {
+        Resume(e.Message());
+      }
+    }
+
+    void Resume(const std::string &error)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        accepted_ = true;
+        if (streamError_.empty())
+        {
+          streamError_ = error;
+        }
+      }
+      cv_.notify_one();
+    }
+
+    void Finish(Napi::Env env)
+    {
+      auto stream = stream_.Value();
+      try
+      {
+        callMethod(stream, "removeListener", {Napi::String::New(env, "error"), onError_.Value()});
+        callMethod(stream, "removeListener", {Napi::String::New(env, "drain"), onDrain_.Value()});
+      }
+      catch (const Napi::Error &)
+      {
+      }
+      self_->mutex_.addStreams(-1);
+
+      if (error_.empty())
+      {
+        deferred_.Resolve(Napi::Number::New(env, written_));
+      }
+      else
+      {
+        deferred_.Reject(Napi::Error::New(env, error_).Value());
+      }
+      tsfn_.Release();
+    }
+
+    Napi::Promise::Deferred deferred_;
+    IndexBase *self_;
+    Napi::ObjectReference owner_;
+    Napi::ObjectReference stream_;
+    Napi::FunctionReference onDrain_;
+    Napi::FunctionReference onError_;
+    Napi::ThreadSafeFunction tsfn_;
+    std::thread thread_;
+    const size_t chunkSize_;
+    std::vector<uint8_t> chunk_;
+    size_t written_ = 0;
+    std::string error_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool accepted_ = false;
+    std::string streamError_;
+  };
+
+  // Deserializes an index on a dedicated thread from the chunks emitted by a Node readable stream.
+  // The stream is paused while more than highWaterMark bytes are queued and resumed once the
+  // thread has consumed half of them.
+  class StreamReader : public faiss::IOReader
+  {
+  public:
+    StreamReader(Napi::Env env, Napi::Object stream, size_t highWaterMark)
+        : deferred_(Napi::Promise::Deferred::New(env)), highWaterMark_(highWaterMark)
+    {
+      name = "stream";
+      stream_ = Napi::Persistent(stream);
+      onData_ = Napi::Persistent(Napi::Function::New(env, [this](const Napi::CallbackInfo &info)
+                                                     { Push(info[0]); }));
+      onEnd_ = Napi::Persistent(Napi::Function::New(env, [this](const Napi::CallbackInfo &)
+                                                    { End(std::string()); }));
+      onError_ = Napi::Persistent(Napi::Function::New(env, [this](const Napi::CallbackInfo &info)
+                                                      { End(errorMessage(info[0])); }));
+    }
+
+    Napi::Promise Start(Napi::Env env)
+    {
+      auto promise = deferred_.Promise();
+      auto stream = stream_.Value();
+      callMethod(stream, "on", {Napi::String::New(env, "error"), onError_.Value()});
+      callMethod(stream, "on", {Napi::String::New(env, "end"), onEnd_.Value()});
+      callMethod(stream, "on", {Napi::String::New(env, "data"), onData_.Value()});
+      tsfn_ = Napi::ThreadSafeFunction::New(
+          env, Napi::Function::New(env, [](const Napi::CallbackInfo &) {}), "faiss-napi.StreamReader", 0, 1, this,
+          [](Napi::Env, StreamReader *reader)
+          {
+            reader->thread_.join();
+            delete reader;
+          });
+      thread_ = std::thread([this]
+                            { Run(); });
+      return promise;
+    }
+
+    size_t operator()(void *ptr, size_t size, size_t nitems) override
+    {
+      if (size == 0)
+      {
+        return 0;
+      }
+      auto out = static_cast<uint8_t *>(ptr);
+      size_t wanted = size * nitems;
+      size_t got = 0;
+
+      std::unique_lock<std::mutex> lock(mutex_);
+      while (got < wanted)
+      {
+        cv_.wait(lock, [this]
+                 { return !queue_.empty() || ended_; });
+        if (queue_.empty())
+        {
+          break;
+        }
+        auto &front = queue_.front();
+        size_t n = std::min(wanted - got, front.size() - offset_);
+        std::memcpy(out + got, front.data() + offset_, n);
+        got += n;
+        offset_ += n;
+        queued_ -= n;
+        if (offset_ == front.size())
+        {
+          queue_.pop_front();
+          offset_ = 0;
+        }
+      }
+      if (paused_ && queued_ <= highWaterMark_ / 2)
+      {
+        paused_ = false;
+        lock.unlock();
+        tsfn_.BlockingCall(this, [](Napi::Env env, Napi::Function, StreamReader *reader)
+                           {
+                             try
+                             {
+                               callMethod(reader->stream_.Value(), "resume", {});
+                             }
+                             catch (const Napi::Error &e)
+                             {
+                               reader->End(e.Message());
+                             }
+                           });
+      }
+      return got / size;
+    }
+
+  private:
+    void Run()
+    {
+      try
+      {
+        index_ = std::unique_ptr<faiss::Index>(faiss::read_index(this));
+      }
+      catch (const std::exception &ex)
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        error_ = streamError_.empty() ? ex.what() : streamError_;
+      }
+      tsfn_.BlockingCall(this, [](Napi::Env env, Napi::Function, StreamReader *reader)
+                         { reader->Finish(env); });
+    }
+
+    // Queue a copy of a chunk emitted by the stream, pausing it if the reader thread falls behind.
+    void Push(const Napi::Value &value)
+    {
+      if (!value.IsBuffer())
+      {
+        End("Stream must emit Buffer chunks.");
+        return;
+      }
+      auto buffer = value.As<Napi::Buffer<uint8_t>>();
+      bool pause = false;
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (ended_)
+        {
+          return;
+        }
+        queue_.emplace_back(buffer.Data(), buffer.Data() + buffer.Length());
+        queued_ += buffer.Length();
+        if (!paused_ && queued_ > highWaterMark_)
+        {
+          paused_ = pause = true;
+        }
+      }
+      cv_.notify_one();
+      if (pause)
+      {
+        callMethod(stream_.Value(), "pause", {});
+      }
+    }
+
+    void End(const std::string &error)
+    {
+      {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ended_ = true;
+        if (streamError_.empty())
+        {
+          streamError_ = error;
+        }
+      }
+      cv_.notify_one();
+    }
+
+    void Finish(Napi::Env env)
+    {
+      auto stream = stream_.Value();
+      try
+      {
+        callMethod(stream, "removeListener", {Napi::String::New(env, "data"), onData_.Value()});
+        callMethod(stream, "removeListener", {Napi::String::New(env, "end"), onEnd_.Value()});
+        callMethod(stream, "removeListener", {Napi::String::New(env, "error"), onError_.Value()});
+      }
+      catch (const Napi::Error &)
+      {
+      }
+
+      if (index_)
+      {
+        Napi::Object instance = T::constructor->New({});
+        T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+        index->index_ = std::move(index_);
+        deferred_.Resolve(instance);
+      }
+      else
+      {
+        deferred_.Reject(Napi::Error::New(env, error_).Value());
+      }
+      tsfn_.Release();
+    }
+
+    Napi::Promise::Deferred deferred_;
+    Napi::ObjectReference stream_;
+    Napi::FunctionReference onData_;
+    Napi::FunctionReference onEnd_;
+    Napi::FunctionReference onError_;
+    Napi::ThreadSafeFunction tsfn_;
+    std::thread thread_;
+    const size_t highWaterMark_;
+    std::unique_ptr<faiss::Index> index_;
+    std::string error_;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<std::vector<uint8_t>> queue_;
+    size_t offset_ = 0;
+    size_t queued_ = 0;
+    bool paused_ = false;
+    bool ended_ = false;
+    std::string streamError_;
+  };
+
+  static bool isFloatInput(const Napi::Value &value)
+  {
+    if (value.IsTypedArray())
+    {
+      auto type = value.As<Napi::TypedArray>().TypedArrayType();
+      return type == napi_float32_array || type == napi_uint8_array;
+    }
+    return value.IsArray() || value.IsArrayBuffer();
+  }
+
+  // Read a flat matrix of floats, validating it holds whole vectors of the index dimension.
+  // Float32Array, Buffer and ArrayBuffer memory is used in place; plain Arrays are copied.
+  // With `copy`, typed memory is copied too, for work that outlives the call.
+  bool readVectors(Napi::Env env, const Napi::Value &value, const std::string &position, FloatInput &out, bool copy = false)
+  {
+    if (!isFloatInput(value))
+    {
+      Napi::TypeError::New(env, "Invalid the " + position + " argument type, must be an Array.").ThrowAsJavaScriptException();
+      return false;
+    }
+
+    if (value.IsArray())
+    {
+      Napi::Array arr = value.As<Napi::Array>();
+      size_t length = arr.Length();
+      if (length % index_->d != 0)
+      {
+        Napi::Error::New(env, "Invalid the given array length.")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+
+      out.owned.resize(length);
+      for (size_t i = 0; i < length; i++)
+      {
+        Napi::Value val = arr[i];
+        out.owned[i] = val.As<Napi::Number>().FloatValue();
+      }
+      out.data = out.owned.data();
+      out.length = length;
+      return true;
+    }
+
+    const uint8_t *bytes = nullptr;
+    size_t byteLength = 0;
+    if (value.IsArrayBuffer())
+    {
+      auto buffer = value.As<Napi::ArrayBuffer>();
+      bytes = static_cast<const uint8_t *>(buffer.Data());
+      byteLength = buffer.ByteLength();
+    }
+    else if (value.As<Napi::TypedArray>().TypedArrayType() == napi_float32_array)
+    {
+      auto arr = value.As<Napi::Float32Array>();
+      bytes = reinterpret_cast<const uint8_t *>(arr.Data());
+      byteLength = arr.ByteLength();
+    }
+    else
+    {
+      auto arr = value.As<Napi::Uint8Array>();
+      if (arr.ByteOffset() % sizeof(float) != 0)
+      {
+        Napi::Error::New(env, "Invalid the " + position + " argument, byte arrays must start at a multiple of 4 bytes.")
+            .ThrowAsJavaScriptException();
+        return false;
+      }
+      bytes = arr.Data();
+      byteLength = arr.ByteLength();
+    }
+
+    if (byteLength % (sizeof(float) * index_->d) != 0)
+    {
+      Napi::Error::New(env, "Invalid the given array length.")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+
+    out.data = reinterpret_cast<const float *>(bytes);
+    out.length = byteLength / sizeof(float);
+    if (copy)
+    {
+      out.own();
+    }
+
+    return true;
+  }
+
+  // Async variants (`copy`) also take a trailing options object, read by the caller.
+  bool readAddWithIdsArgs(const Napi::CallbackInfo &info, FloatInput &xb, IdInput &xids, bool copy = false)
+  {
+    Napi::Env env = info.Env();
+
+    if (copy && (info.Length() < 2 || info.Length() > 3))
+    {
+      Napi::Error::New(env, "Expected 2 or 3 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    if (!copy && info.Length() != 2)
+    {
+      Napi::Error::New(env, "Expected 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    if (!isFloatInput(info[0]))
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be an Array.").ThrowAsJavaScriptException();
+      return false;
+    }
+    if (!isIdInput(info[1]))
+    {
+      Napi::TypeError::New(env, "Invalid the second argument type, must be an Array.").ThrowAsJavaScriptException();
+      return false;
+    }
+
+    if (!readVectors(env, info[0], "first", xb, copy))
+    {
+      return false;
+    }
+    if (!readIds(env, info[1], xids, copy))
+    {
+      return false;
+    }
+    if (xids.length != xb.length / index_->d)
+    {
+      Napi::Error::New(env, "Labels array length must match the number of vectors.")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+
+    return true;
+  }
+
+  // Parse `(x, k?)` shared by the search variants; k defaults to and is capped at ntotal.
+  bool readSearchArgs(const Napi::CallbackInfo &info, FloatInput &xq, idx_t &k, bool copy = false)
+  {
+    Napi::Env env = info.Env();
+
+    k = index_->ntotal;
+    if (info.Length() < 1 || !isFloatInput(info[0]))
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be an Array.").ThrowAsJavaScriptException();
+      return false;
+    }
+    if (info.Length() >= 2)
+    {
+      if (!info[1].IsNumber())
+      {
+        Napi::TypeError::New(env, "Invalid the second argument type, must be a Number.").ThrowAsJavaScriptException();
+        return false;
+      }
+
+      k = info[1].As<Napi::Number>().Uint32Value();
+    }
+
+    if (k > index_->ntotal)
+    {
+      k = index_->ntotal;
+    }
+
+    return readVectors(env, info[0], "first", xq, copy);
+  }
+
+  static bool readThreadsOption(Napi::Env env, const Napi::Object &options, int &threads)
+  {
+    if (options.Has("threads"))
+    {
+      Napi::Value val = options.Get("threads");
+      if (!val.IsNumber() || val.As<Napi::Number>().Int32Value() < 0)
+      {
+        Napi::TypeError::New(env, "Invalid threads option, must be a non-negative Number.").ThrowAsJavaScriptException();
+        return false;
+      }
+      threads = val.As<Napi::Number>().Int32Value();
+    }
+    return true;
+  }
+
+  // Read the `{ threads }` options of the async add and train methods.
+  static bool readWorkerOptions(Napi::Env env, const Napi::Value &value, const std::string &position, int &threads)
+  {
+    if (value.IsUndefined())
+    {
+      return true;
+    }
+    if (!value.IsObject() || value.IsArray())
+    {
+      Napi::TypeError::New(env, "Invalid the " + position + " argument type, must be an Object.").ThrowAsJavaScriptException();
+      return false;
+    }
+    return readThreadsOption(env, value.As<Napi::Object>(), threads);
+  }
+
+  // Read the `{ filter, nprobe, maxCodes, efSearch, checkRelativeDistance, threads, withStats }` search options. A filter is an id allow-list (Array or BigInt64Array), an
+  // `{ min, max }` id range (max excluded) or a Uint8Array bitmap where bit (id % 8) of byte (id / 8)
+  // is set for the ids to keep. With `copy`, the bitmap is copied for async searches.
+  static bool readSearchOptions(Napi::Env env, const Napi::Value &value, const std::string &position, SearchOptions &out, bool copy = false)
+  {
+    if (value.IsUndefined())
+    {
+      return true;
+    }
+    if (!value.IsObject() || value.IsArray())
+    {
+      Napi::TypeError::New(env, "Invalid the " + position + " argument type, must be an Object.").ThrowAsJavaScriptException();
+      return false;
+    }
+
+    Napi::Object options = value.As<Napi::Object>();
+    if (options.Has("filter"))
+    {
+      Napi::Value filter = options.Get("filter");
+      if (isIdInput(filter))
+      {
+        IdInput ids;
+        if (!readIds(env, filter, ids))
+        {
+          return false;
+        }
+        out.sel = std::make_unique<faiss::IDSelectorBatch>(ids.length, ids.data);
+      }
+      else if (filter.IsTypedArray() && filter.As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array)
+      {
+        auto bitmap = filter.As<Napi::Uint8Array>();
+        out.bitmap.data = bitmap.Data();
+        out.bitmap.length = bitmap.ElementLength();
+        if (copy)
+        {
+          out.bitmap.own();
+        }
+        out.sel = std::make_unique<faiss::IDSelectorBitmap>(out.bitmap.length, out.bitmap.data);
+      }
+      else if (filter.IsObject() && filter.As<Napi::Object>().Get("min").IsNumber() && filter.As<Napi::Object>().Get("max").IsNumber())
+      {
+        auto range = filter.As<Napi::Object>();
+        out.sel = std::make_unique<faiss::IDSelectorRange>(range.Get("min").As<Napi::Number>().Int64Value(), range.Get("max").As<Napi::Number>().Int64Value());
+      }
+      else
+      {
+        Napi::TypeError::New(env, "Invalid filter option, must be an id Array, a BigInt64Array, a { min, max } range or a Uint8Array bitmap.").ThrowAsJavaScriptException();
+        return false;
+      }
+    }
+    if (!readThreadsOption(env, options, out.threads))
+    {
+      return false;
+    }
+    for (auto name : {"nprobe", "maxCodes", "efSearch"})
+    {
+      if (!options.Has(name))
+      {
+        continue;
+      }
+      Napi::Value val = options.Get(name);
+      if (!val.IsNumber() || val.As<Napi::Number>().Int64Value() < 0)
+      {
+        Napi::TypeError::New(env, std::string("Invalid ") + name + " option, must be a non-negative Number.").ThrowAsJavaScriptException();
+        return false;
+      }
+    }
+    if (options.Has("nprobe"))
+    {
+      out.nprobe = options.Get("nprobe").As<Napi::Number>().Int64Value();
+    }
+    if (options.Has("maxCodes"))
+    {
+      out.maxCodes = options.Get("maxCodes").As<Napi::Number>().Int64Value();
+    }
+    if (options.Has("efSearch"))
+    {
+      out.efSearch = options.Get("efSearch").As<Napi::Number>().Int32Value();
+    }
+    if (options.Has("checkRelativeDistance"))
+    {
+      Napi::Value val = options.Get("checkRelativeDistance");
+      if (!val.IsBoolean())
+      {
+        Napi::TypeError::New(env, "Invalid checkRelativeDistance option, must be a Boolean.").ThrowAsJavaScriptException();
+        return false;
+      }
+      out.checkRelativeDistance = val.As<Napi::Boolean>().Value();
+    }
+    if (options.Has("withStats"))
+    {
+      Napi::Value val = options.Get("withStats");
+      if (!val.IsBoolean())
+      {
+        Napi::TypeError::New(env, "Invalid withStats option, must be a Boolean.").ThrowAsJavaScriptException();
+        return false;
+      }
+      out.withStats = val.As<Napi::Boolean>().Value();
+    }
+
+    return true;
+  }
+
+  // The index that search parameters are built for: IDMap wrappers pass them on to theirs.
+  const faiss::Index *searchedIndex() const
+  {
+    const faiss::Index *index = index_.get();
+    while (auto idmap = dynamic_cast<const faiss::IndexIDMap *>(index))
+    {
+      index = idmap->index;
+    }
+    return index;
+  }
+
+  // IVF indexes taking SearchParametersIVF; fast-scan ones reject any search parameters.
+  static const faiss::IndexIVF *ivfWithParameters(const faiss::Index *index)
+  {
+    if (dynamic_cast<const faiss::IndexIVFFastScan *>(index) != nullptr)
+    {
+      return nullptr;
+    }
+    return dynamic_cast<const faiss::IndexIVF *>(index);
+  }
+
+  // faiss 1.7.4 only honours the IDSelector of search parameters on IVF, HNSW and flat indexes, and
+  // rejects parameters on the others (e.g. IndexRefine, IndexShards, IndexReplicas, PQ and
+  // fast-scan indexes), so a filter on those fails here with a clear error instead.
+  bool checkFilter(Napi::Env env, const SearchOptions &options) const
+  {
+    auto index = searchedIndex();
+    if (options.sel && ivfWithParameters(index) == nullptr && dynamic_cast<const faiss::IndexHNSW *>(index) == nullptr &&
+        dynamic_cast<const faiss::IndexFlat *>(index) == nullptr)
+    {
+      Napi::Error::New(env, "The filter option is not supported by this index type.").ThrowAsJavaScriptException();
+      return false;
+    }
+    return true;
+  }
+
+  // faiss checks that search parameters are of the type the index expects, and those also carry
+  // the index defaults (e.g. nprobe), so build them for the index being searched, not its IDMap.
+  // Options that don't apply to the index type are ignored, without passing parameters at all when
+  // none applies; filters were checked by checkFilter. The shared index is never modified.
+  std::unique_ptr<faiss::SearchParameters> toSearchParameters(const SearchOptions &options) const
+  {
+    if (!options.hasSearchParameters())
+    {
+      return nullptr;
+    }
+
+    auto index = searchedIndex();
+    std::unique_ptr<faiss::SearchParameters> params;
+    if (auto ivf = ivfWithParameters(index))
+    {
+      auto ivfParams = new faiss::SearchParametersIVF();
+      ivfParams->nprobe = options.nprobe.value_or(ivf->nprobe);
+      ivfParams->max_codes = options.maxCodes.value_or(ivf->max_codes);
+      params.reset(ivfParams);
+    }
+    else if (auto hnsw = dynamic_cast<const faiss::IndexHNSW *>(index))
+    {
+      auto hnswParams = new faiss::SearchParametersHNSW();
+      hnswParams->efSearch = options.efSearch.value_or(hnsw->hnsw.efSearch);
+      hnswParams->check_relative_distance = options.checkRelativeDistance.value_or(hnsw->hnsw.check_relative_distance);
+      params.reset(hnswParams);
+    }
+    else if (options.sel)
+    {
+      params = std::make_unique<faiss::SearchParameters>();
+    }
+    else
+    {
+      return nullptr;
+    }
+    params->sel = options.sel.get();
+
+    return params;
+  }
+
+  // The search entry points of all search variants; callers hold a read lock. With the `withStats`
+  // option, the work done by the call is stored in `stats` when given.
+  void runSearch(idx_t n, const float *x, idx_t k, float *distances, idx_t *labels, const SearchOptions &options, SearchStats *stats = nullptr) const
+  {
+    OmpThreadsScope threads(options.threads);
+    auto params = toSearchParameters(options);
+    if (!options.withStats || !stats)
+    {
+      index_->search(n, x, k, distances, labels, params.get());
+      return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto ivf = dynamic_cast<const faiss::IndexIVF *>(index_.get());
+    // fast-scan IVF indexes don't report stats from search_preassigned
+    if (ivf && dynamic_cast<const faiss::IndexIVFFastScan *>(ivf) == nullptr)
+    {
+      stats->ivf = searchIVF(*ivf, n, x, k, distances, labels, static_cast<const faiss::SearchParametersIVF *>(params.get()));
+    }
+    else
+    {
+      // the mutex is only held to read the globals, so that searches don't wait for one another;
+      // any search running on other threads meanwhile is counted in this diff too, as documented
+      // in lib/index.d.ts
+      faiss::IndexIVFStats ivfBefore;
+      faiss::HNSWStats hnswBefore;
+      {
+        std::lock_guard<std::mutex> lock(searchStatsMutex);
+        ivfBefore = faiss::indexIVF_stats;
+        hnswBefore = faiss::hnsw_stats;
+      }
+      index_->search(n, x, k, distances, labels, params.get());
+
+      std::lock_guard<std::mutex> lock(searchStatsMutex);
+      auto index = index_.get();
+      while (auto idmap = dynamic_cast<faiss::IndexIDMap *>(index))
+      {
+        index = idmap->index;
+      }
+      if (faiss::ivflib::try_extract_index_ivf(index) != nullptr)
+      {
+        stats->ivf = ivfStatsSince(ivfBefore);
+      }
+      if (dynamic_cast<faiss::IndexHNSW *>(index) != nullptr)
+      {
+        stats->hnsw = hnswStatsSince(hnswBefore);
+      }
+    }
+    stats->timeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  }
+
+  // IndexIVF::search in two stages, coarse quantization then list scanning, so that the counters
+  // go to this call rather than only to the global indexIVF_stats.
+  static faiss::IndexIVFStats searchIVF(const faiss::IndexIVF &ivf, idx_t n, const float *x, idx_t k, float *distances, idx_t *labels, const faiss::SearchParametersIVF *params)
+  {
+    size_t nprobe = std::min(ivf.nlist, params ? params->nprobe : ivf.nprobe);
+    FAISS_THROW_IF_NOT(k > 0 && nprobe > 0);
+
+    faiss::IndexIVFStats stats;
+    std::vector<idx_t> assign(n * nprobe);
+    std::vector<float> centroidDistances(n * nprobe);
+    auto start = std::chrono::steady_clock::now();
+    ivf.quantizer->search(n, x, nprobe, centroidDistances.data(), assign.data());
+    auto quantized = std::chrono::steady_clock::now();
+    ivf.invlists->prefetch_lists(assign.data(), n * nprobe);
+    ivf.search_preassigned(n, x, k, assign.data(), centroidDistances.data(), distances, labels, false, params, &stats);
+    auto end = std::chrono::steady_clock::now();
+    stats.quantization_time = std::chrono::duration<double, std::milli>(quantized - start).count();
+    // as faiss' IndexIVF::search, search_time excludes quantization_time
+    stats.search_time = std::chrono::duration<double, std::milli>(end - quantized).count();
+
+    std::lock_guard<std::mutex> lock(searchStatsMutex);
+    faiss::indexIVF_stats.add(stats);
+    return stats;
+  }
+
+  void runRangeSearch(idx_t n, const float *x, float radius, faiss::RangeSearchResult *result, const SearchOptions &options) const
+  {
+    OmpThreadsScope threads(options.threads);
+    auto params = toSearchParameters(options);
+    index_->range_search(n, x, radius, result, params.get());
+  }
+
+  static Napi::Object toSearchResult(Napi::Env env, const std::vector<float> &D, const std::vector<idx_t> &I)
+  {
+    auto n = D.size();
+    Napi::Array arr_distances = Napi::Array::New(env, n);
+    Napi::Array arr_labels = Napi::Array::New(env, n);
+    for (size_t i = 0; i < n; i++)
+    {
+      arr_distances[i] = Napi::Number::New(env, D[i]);
+      arr_labels[i] = Napi::BigInt::New(env, I[i]);
+    }
+
+    Napi::Object results = Napi::Object::New(env);
+    results.Set("distances", arr_distances);
+    results.Set("labels", arr_labels);
+    return results;
+  }
+
+  // Hand the result vectors to JS as external ArrayBuffers, freed when the typed arrays are collected.
+  static Napi::Object toTypedSearchResult(Napi::Env env, std::vector<float> &&D, std::vector<idx_t> &&I)
+  {
+    auto n = D.size();
+    Napi::Object results = Napi::Object::New(env);
+    results.Set("distances", Napi::Float32Array::New(env, n, toExternalArrayBuffer(env, std::move(D)), 0));
+    results.Set("labels", Napi::BigInt64Array::New(env, n, toExternalArrayBuffer(env, std::move(I)), 0));
+    return results;
+  }
+
+  // Take ownership of the result arrays instead of copying them; a RangeSearchResult frees whatever it still points to.
+  static Napi::Object toRangeSearchResult(Napi::Env env, faiss::RangeSearchResult &result)
+  {
+    auto nq = result.nq;
+    auto n = result.lims[nq];
+    Napi::Object results = Napi::Object::New(env);
+    results.Set("lims", Napi::BigUint64Array::New(env, nq + 1, toExternalArrayBuffer(env, result.lims, nq + 1), 0));
+    result.lims = nullptr;
+    results.Set("distances", Napi::Float32Array::New(env, n, toExternalArrayBuffer(env, result.distances, n), 0));
+    result.distances = nullptr;
+    results.Set("labels", Napi::BigInt64Array::New(env, n, toExternalArrayBuffer(env, result.labels, n), 0));
+    result.labels = nullptr;
+    return results;
+  }
+
+  // Shared by addShard and addReplica: `parent` is null if this index is not of the expected kind.
+  Napi::Value addSubIndex(const Napi::CallbackInfo &info, faiss::ThreadedIndex<faiss::Index> *parent, const char *wrongIndexError)
+  {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || info.Length() > 2)
+    {
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsString() && !info[0].IsObject())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be an Index or a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    if (parent == nullptr)
+    {
+      Napi::Error::New(env, wrongIndexError).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (*parents_ > 0)
+    { // the locks linked by the parents would miss the new one
+      Napi::Error::New(env, "Indexes cannot be added to an index used by another index.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    std::unique_ptr<faiss::Index> owned;
+    IndexBase *subInstance = nullptr;
+    faiss::Index *subIndex = nullptr;
+    if (info[0].IsString())
+    {
+      int ioFlags = 0;
+      if (info.Length() > 1 && !readIOFlags(env, info[1], ioFlags))
+      {
+        return env.Undefined();
+      }
+      std::string fname = info[0].As<Napi::String>().Utf8Value();
+      try
       {
-        mergeIndex = faiss::ivflib::extract_index_ivf(faiss::read_index(val.As<Napi::String>().Utf8Value().c_str(), faiss::IO_FLAG_MMAP));
+        owned.reset(faiss::read_index(fname.c_str(), ioFlags));
+      }
+      catch (const faiss::FaissException &ex)
+      {
+        Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      subIndex = owned.get();
+    }
+    else
+    {
+      subInstance = unwrapInstance(info[0]);
+      subIndex = subInstance != nullptr ? subInstance->index_.get() : nullptr;
+      if (subIndex == nullptr || subIndex == index_.get())
+      {
+        Napi::Error::New(env, "Invalid the first argument, must be another Index that is not disposed.").ThrowAsJavaScriptException();
+        return env.Undefined();
+      }
+      if (areLinked(this, subInstance))
+      {
+        Napi::Error::New(env, "Invalid the first argument, must not be used by this index already.").ThrowAsJavaScriptException();
+        return env.Undefined();
       }
+    }
 
-      if (i == 0)
-      { // first index is trained index
-        trainedIndex = mergeIndex;
-        trainedIndexOwned = mergeIndexOwned;
-        mergeIndexOwned = false;
+    auto lock = writeLock();
+    std::unique_lock<IndexMutex> subLock;
+    if (subInstance != nullptr)
+    {
+      subLock = subInstance->writeLock();
+    }
+    try
+    {
+      // results are merged by the metric of the sub-indexes
+      if (parent->count() == 0)
+      {
+        parent->metric_type = subIndex->metric_type;
+        parent->metric_arg = subIndex->metric_arg;
       }
+      parent->addIndex(subIndex);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (owned)
+    {
+      subIndexes_.push_back(std::move(owned));
+    }
+    else
+    {
+      attachSubIndex(info[0].As<Napi::Object>(), std::move(subLock));
+    }
 
-      mergeIndex->own_invlists = false; // allow IVF to be released without deleting the inverted lists
-      lists.push_back(mergeIndex->invlists);
-      ntotal += mergeIndex->ntotal;
+    return env.Undefined();
+  }
 
-      if (mergeIndexOwned)
+  // Locks of several indexes and the indexes linked to them, taken together by
+  // IndexMutex::lockAll so that calls locking overlapping sets of indexes in any order can't wait
+  // on one another in a cycle.
+  class IndexLocks
+  {
+  public:
+    IndexLocks() = default;
+    IndexLocks(const IndexLocks &) = delete;
+    ~IndexLocks()
+    {
+      if (locked_)
       {
-        delete mergeIndex;
+        IndexMutex::unlockAll(parts_);
       }
     }
 
-    auto il = new faiss::OnDiskInvertedLists(trainedIndex->nlist, trainedIndex->code_size, outDataFname.c_str());
-    // this will write the merged index to disk
-    il->merge_from(lists.data(), lists.size(), false);
+    // Lock `instance` exclusively or shared; a lock added twice is taken once, exclusively if
+    // either asked for it.
+    void add(IndexBase *instance, bool exclusive)
+    {
+      instances_.emplace_back(instance, exclusive);
+      for (auto &part : instance->mutex_.parts(!exclusive))
+      {
+        auto it = std::find_if(parts_.begin(), parts_.end(), [&](const IndexMutex::Part &other)
+                               { return other.mutex == part.mutex; });
+        if (it == parts_.end())
+        {
+          parts_.push_back(part);
+        }
+        else
+        {
+          it->shared = it->shared && part.shared;
+        }
+      }
+    }
 
-    // replace invertedLists in the output index
-    trainedIndex->replace_invlists(il, true);
-    trainedIndex->ntotal = ntotal;
+    // As readLock and writeLock, fails on the JS thread rather than wait on a writeStream.
+    void lock()
+    {
+      for (auto &instance : instances_)
+      {
+        if (instance.first->mutex_.streaming() && std::this_thread::get_id() == instance.first->jsThread_)
+        {
+          throw Napi::Error::New(instance.first->Env(), instance.second ? "Index cannot be modified while writeStream is in progress." : "Index is busy while writeStream is in progress.");
+        }
+      }
+      if (!parts_.empty())
+      {
+        IndexMutex::lockAll(parts_);
+        locked_ = true;
+      }
+    }
 
-    // release all indexes
-    if (trainedIndexOwned)
+  private:
+    std::vector<std::pair<IndexBase *, bool>> instances_;
+    std::vector<IndexMutex::Part> parts_;
+    bool locked_ = false;
+  };
+
+  // Whether `part` is used in place by `whole`, directly or through another part.
+  static bool isPartOf(const IndexBase *part, const IndexBase *whole)
+  {
+    return part != whole && whole->mutex_.covers(&part->mutex_);
+  }
+
+  // Whether two distinct indexes are parts of one another or share a part, so that linking one to
+  // the other would list some lock twice.
+  static bool areLinked(const IndexBase *a, const IndexBase *b)
+  {
+    return a != b && a->mutex_.overlaps(&b->mutex_);
+  }
+
+  // IVF indexes built by the constructors use their quantizer in place: attach it like a shard, so
+  // that it is kept alive, locked with this index and can't be disposed before it.
+  void attachQuantizer(Napi::Object quantizer)
+  {
+    auto lock = writeLock();
+    attachSubIndex(quantizer, unwrapInstance(quantizer)->writeLock());
+  }
+
+  // Keep a JS index used in place by index_ alive, and link its lock to this one so that work on
+  // this index excludes conflicting work on it. Called with both indexes locked exclusively, the
+  // lock of the attached index being handed over.
+  void attachSubIndex(Napi::Object object, std::unique_lock<IndexMutex> &&subLock)
+  {
+    auto instance = unwrapInstance(object);
+    mutex_.link(subLock.release());
+    subIndexRefs_.emplace_back(Napi::Persistent(object), instance->parents_);
+  }
+
+  static bool isKFactor(const Napi::Value &value)
+  {
+    return value.IsNumber() && value.As<Napi::Number>().FloatValue() >= 1;
+  }
+
+  // Searches fetch k * kFactor candidates from this index and return the k nearest by distance in
+  // the refine index (an Index object, or undefined for a flat index of the full vectors). Both
+  // indexes are used in place and attached to the new index like shards: vectors added through it
+  // go to both, and they can't be disposed before it.
+  Napi::Value toRefineIndex(Napi::Env env, const Napi::Value &refineObject, const Napi::Value &kFactor)
+  {
+    Napi::Object instance = T::constructor->New({});
+    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+    auto refineInstance = refineObject.IsObject() ? unwrapInstance(refineObject) : nullptr;
+
+    // the new index isn't shared yet, so locking it first can't deadlock
+    auto lock = index->writeLock();
+    auto baseLock = writeLock();
+    std::unique_lock<IndexMutex> refineLock;
+    if (refineInstance != nullptr)
     {
-      // write the trained index to disk using the same filename
-      try
+      refineLock = refineInstance->writeLock();
+    }
+    try
+    {
+      auto refine = refineInstance != nullptr ? new faiss::IndexRefine(index_.get(), refineInstance->index_.get())
+                                              : new faiss::IndexRefineFlat(index_.get());
+      if (kFactor.IsNumber())
       {
-        faiss::write_index(trainedIndex, outIndexFname.c_str());
-        delete trainedIndex;
+        refine->k_factor = kFactor.As<Napi::Number>().FloatValue();
       }
-      catch (const faiss::FaissException &ex)
+      index->index_ = std::unique_ptr<faiss::IndexRefine>(refine);
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return instance;
+    }
+    index->attachSubIndex(this->Value(), std::move(baseLock));
+    if (refineInstance != nullptr)
+    {
+      index->attachSubIndex(refineObject.As<Napi::Object>(), std::move(refineLock));
+    }
+
+    return instance;
+  }
+
+  static bool isStream(const Napi::Value &value, const char *method)
+  {
+    return value.IsObject() && value.As<Napi::Object>().Get(method).IsFunction();
+  }
+
+  static Napi::Value callMethod(Napi::Object object, const char *method, const std::initializer_list<napi_value> &args)
+  {
+    return object.Get(method).As<Napi::Function>().Call(object, args);
+  }
+
+  static std::string errorMessage(const Napi::Value &error)
+  {
+    if (error.IsObject() && error.As<Napi::Object>().Get("message").IsString())
+    {
+      return error.As<Napi::Object>().Get("message").As<Napi::String>().Utf8Value();
+    }
+    return error.ToString().Utf8Value();
+  }
+
+  // Every instance method but dispose starts with this check, since dispose leaves index_ null.
+  bool isDisposed(Napi::Env env)
+  {
+    if (index_)
+    {
+      return false;
+    }
+    Napi::Error::New(env, "Index has been disposed.").ThrowAsJavaScriptException();
+    return true;
+  }
+
+  // While a writeStream is in progress its thread holds a read lock, also covering the indexes
+  // linked to the streaming one, and waits for the JS thread to accept chunks. So locks taken on
+  // the JS thread on any of these indexes, or on indexes using them, must fail rather than wait.
+  std::shared_lock<IndexMutex> readLock()
+  {
+    if (mutex_.streaming() && std::this_thread::get_id() == jsThread_)
+    {
+      std::shared_lock<IndexMutex> lock(mutex_, std::try_to_lock);
+      if (!lock.owns_lock())
       {
-        delete trainedIndex;
-        Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+        throw Napi::Error::New(this->Env(), "Index is busy while writeStream is in progress.");
+      }
+      return lock;
+    }
+    return std::shared_lock<IndexMutex>(mutex_);
+  }
+
+  std::unique_lock<IndexMutex> writeLock()
+  {
+    if (mutex_.streaming() && std::this_thread::get_id() == jsThread_)
+    {
+      throw Napi::Error::New(this->Env(), "Index cannot be modified while writeStream is in progress.");
+    }
+    return std::unique_lock<IndexMutex>(mutex_);
+  }
+
+  // Indexes used in place by index_, e.g. shards: read from files and owned here, or kept alive
+  // through references to their JS objects. Declared before index_ to be destroyed after it.
+  std::vector<std::unique_ptr<faiss::Index>> subIndexes_;
+  std::vector<SubIndexRef> subIndexRefs_;
+  std::shared_ptr<std::atomic<int>> parents_ = std::make_shared<std::atomic<int>>(0);
+  std::unique_ptr<faiss::Index> index_;
+  IndexMutex mutex_;
+  const std::thread::id jsThread_ = std::this_thread::get_id();
+  std::unique_ptr<SearchBatcher> batcher_;
+  IndexMetrics metrics_;
+  inline static Napi::FunctionReference *constructor;
+};
+
+// Binary counterpart of IndexBase over faiss::IndexBinary: vectors are packed bits, d / 8 bytes
+// each, passed as Uint8Array (used in place) or byte Arrays (copied), and searches return Hamming
+// distances. It deliberately covers a narrower API, documented on IndexBinary in index.d.ts: no
+// search options, metrics, batching, streams or async writes, and no indexes attached to it but
+// the quantizer of an IVF index.
+template <class T, typename Y, IndexType IT>
+class BinaryIndexBase : public Napi::ObjectWrap<T>
+{
+public:
+  BinaryIndexBase(const Napi::CallbackInfo &info) : Napi::ObjectWrap<T>(info)
+  {
+    Napi::Env env = info.Env();
+
+    try
+    {
+      if constexpr (IT == IndexType::IndexBinaryHNSW)
+      { // BinaryHNSW constructor
+        if (info.Length() > 0 && info[0].IsNumber())
+        {
+          auto d = info[0].As<Napi::Number>().Uint32Value();
+          auto m = 32; // faiss default
+          if (info.Length() > 1 && info[1].IsNumber())
+          {
+            m = info[1].As<Napi::Number>().Uint32Value();
+          }
+          index_ = std::unique_ptr<faiss::IndexBinaryHNSW>(new faiss::IndexBinaryHNSW(d, m));
+        }
+      }
+      else if constexpr (IT == IndexType::IndexBinaryIVF)
+      { // BinaryIVF constructor
+        if (info.Length() > 2 && info[0].IsObject() && info[1].IsNumber() && info[2].IsNumber())
+        {
+          auto quantizer = unwrapIndex(info[0]);
+          if (quantizer == nullptr)
+          {
+            Napi::TypeError::New(env, "Invalid the first argument, must be a binary Index that is not disposed.").ThrowAsJavaScriptException();
+            return;
+          }
+
+          auto d = info[1].As<Napi::Number>().Uint32Value();
+          auto nlist = info[2].As<Napi::Number>().Uint32Value();
+          index_ = std::unique_ptr<faiss::IndexBinaryIVF>(new faiss::IndexBinaryIVF(quantizer, d, nlist));
+          attachQuantizer(info[0].As<Napi::Object>());
+        }
+      }
+      else if (info.Length() > 0 && info[0].IsNumber())
+      {
+        auto d = info[0].As<Napi::Number>().Uint32Value();
+        index_ = std::unique_ptr<Y>(new Y(d));
       }
     }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
+  }
+
+  // Called by the Init of each generated binary index class.
+  static void setConstructor(Napi::Function func)
+  {
+    constructor = new Napi::FunctionReference(Napi::Persistent(func));
+    binaryIndexConstructors.push_back(constructor);
+  }
+
+  // The faiss index of a JS binary index, or nullptr if the value is not a binary index or is
+  // disposed.
+  static faiss::IndexBinary *unwrapIndex(const Napi::Value &value)
+  {
+    if (!isInstanceOfAny(value, binaryIndexConstructors))
+    {
+      return nullptr;
+    }
+    return Napi::ObjectWrap<T>::Unwrap(value.As<Napi::Object>())->index_.get();
+  }
+
+  static Napi::Value read(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (info.Length() < 1 || info.Length() > 2)
+    {
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsString())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    int ioFlags = 0;
+    if (info.Length() > 1 && !readIOFlags(env, info[1], ioFlags))
+    {
+      return env.Undefined();
+    }
+
+    Napi::Object instance = T::constructor->New({});
+    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+    std::string fname = info[0].As<Napi::String>().Utf8Value();
+
+    try
+    {
+      index->index_ = std::unique_ptr<faiss::IndexBinary>(faiss::read_index_binary(fname.c_str(), ioFlags));
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
+
+    return instance;
+  }
+
+  static Napi::Value fromBuffer(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (info.Length() != 1)
+    {
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+    if (!info[0].IsBuffer())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a buffer.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    Napi::Object instance = T::constructor->New({});
+    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
+
+    auto buffer = info[0].As<Napi::Buffer<uint8_t>>();
+    MemoryIOReader reader(buffer.Data(), buffer.Length());
 
-    for (size_t i = 0; i < lists.size(); i++)
+    try
+    {
+      index->index_ = std::unique_ptr<faiss::IndexBinary>(faiss::read_index_binary(&reader));
+    }
+    catch (const faiss::FaissException &ex)
     {
-      delete lists[i];
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
     }
 
-    return env.Undefined();
+    return instance;
   }
-#endif // _MSC_VER
 
-  Napi::Value getIndexType(const Napi::CallbackInfo &info)
+  static Napi::Value fromFactory(const Napi::CallbackInfo &info)
   {
-    auto index = index_.get();
+    Napi::Env env = info.Env();
 
-    if (dynamic_cast<faiss::IndexFlat *>(index) != nullptr)
+    if (info.Length() != 2)
     {
-      return Napi::Number::New(info.Env(), static_cast<uint32_t>(IndexType::IndexFlat));
+      Napi::Error::New(env, "Expected 2 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
+      return env.Undefined();
     }
-    else if (dynamic_cast<faiss::IndexIVF *>(index) != nullptr)
+    if (!info[0].IsNumber())
     {
-      return Napi::Number::New(info.Env(), static_cast<uint32_t>(IndexType::IndexIVF));
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a number.").ThrowAsJavaScriptException();
+      return env.Undefined();
     }
-    else if (dynamic_cast<faiss::IndexHNSW *>(index) != nullptr)
+    if (!info[1].IsString())
     {
-      return Napi::Number::New(info.Env(), static_cast<uint32_t>(IndexType::IndexHNSW));
+      Napi::TypeError::New(env, "Invalid the second argument type, must be a string.").ThrowAsJavaScriptException();
+      return env.Undefined();
     }
 
-    return Napi::Number::New(info.Env(), static_cast<uint32_t>(IndexType::Index));
-  }
-
-  Napi::Value getIsTrained(const Napi::CallbackInfo &info)
-  {
-    Napi::Env env = info.Env();
+    Napi::Object instance = T::constructor->New({});
+    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
 
-    return Napi::Boolean::New(env, index_->is_trained);
-  }
+    const int d = info[0].As<Napi::Number>().Int32Value();
+    std::string description = info[1].As<Napi::String>().Utf8Value();
 
-  Napi::Value getNTotal(const Napi::CallbackInfo &info)
-  {
-    Napi::Env env = info.Env();
+    try
+    {
+      index->index_ = std::unique_ptr<faiss::IndexBinary>(faiss::index_binary_factory(d, description.c_str()));
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+    }
 
-    return Napi::Number::New(env, index_->ntotal);
+    return instance;
   }
 
-  Napi::Value getDimension(const Napi::CallbackInfo &info)
+  Napi::Value getIndexType(const Napi::CallbackInfo &info)
   {
-    Napi::Env env = info.Env();
-
-    return Napi::Number::New(env, index_->d);
-  }
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
 
-  Napi::Value getMetricType(const Napi::CallbackInfo &info)
-  {
-    return Napi::Number::New(info.Env(), index_->metric_type);
-  }
+    auto index = index_.get();
 
-  Napi::Value getMetricArg(const Napi::CallbackInfo &info)
-  {
-    return Napi::Number::New(info.Env(), index_->metric_arg);
-  }
+    if (dynamic_cast<faiss::IndexBinaryFlat *>(index) != nullptr)
+    {
+      return Napi::Number::New(info.Env(), static_cast<uint32_t>(IndexType::IndexBinaryFlat));
+    }
+    else if (dynamic_cast<faiss::IndexBinaryIVF *>(index) != nullptr)
+    {
+      return Napi::Number::New(info.Env(), static_cast<uint32_t>(IndexType::IndexBinaryIVF));
+    }
+    else if (dynamic_cast<faiss::IndexBinaryHNSW *>(index) != nullptr)
+    {
+      return Napi::Number::New(info.Env(), static_cast<uint32_t>(IndexType::IndexBinaryHNSW));
+    }
 
-  Napi::Value getCodeSize(const Napi::CallbackInfo &info)
-  {
-    auto index = dynamic_cast<faiss::IndexFlat *>(index_.get());
-    return Napi::Number::New(info.Env(), index->code_size);
+    return Napi::Number::New(info.Env(), static_cast<uint32_t>(IndexType::IndexBinary));
   }
 
-  Napi::Value getCodesUInt8(const Napi::CallbackInfo &info)
+  Napi::Value getIsTrained(const Napi::CallbackInfo &info)
   {
-    Napi::Env env = info.Env();
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
 
-    auto index = dynamic_cast<faiss::IndexFlat *>(index_.get());
-    return Napi::Buffer<uint8_t>::Copy(env, index->codes.data(), index->codes.size());
+    return Napi::Boolean::New(info.Env(), index_->is_trained);
   }
 
-  Napi::Value getCodesByRange(const Napi::CallbackInfo &info)
+  Napi::Value getNTotal(const Napi::CallbackInfo &info)
   {
-    Napi::Env env = info.Env();
-
-    auto index = dynamic_cast<faiss::IndexFlat *>(index_.get());
-
-    size_t start = 0;
-    size_t end = index->codes.size();
-
-    if (info.Length() >= 1)
+    if (isDisposed(info.Env()))
     {
-      start = info[0].As<Napi::Number>().Uint32Value();
-      if (start >= end)
-      {
-        Napi::Error::New(env, "Position must be less than end.").ThrowAsJavaScriptException();
-        return env.Undefined();
-      }
-    }
-    if (info.Length() >= 2)
-    {
-      end = info[1].As<Napi::Number>().Uint32Value();
-      if (end > index->codes.size())
-      {
-        end = index->codes.size();
-      }
+      return info.Env().Undefined();
     }
 
-    return Napi::Buffer<uint8_t>::Copy(env, &index->codes.data()[start], end - start);
+    return Napi::Number::New(info.Env(), index_->ntotal);
   }
 
-  Napi::Value setCodesByRange(const Napi::CallbackInfo &info)
+  // Dimension in bits.
+  Napi::Value getDimension(const Napi::CallbackInfo &info)
   {
-    Napi::Env env = info.Env();
-
-    auto index = dynamic_cast<faiss::IndexFlat *>(index_.get());
-
-    size_t start = 0;
-
-    if (info.Length() < 1)
-    {
-      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
-    }
-    if (info.Length() >= 2)
-    {
-      start = info[1].As<Napi::Number>().Uint32Value();
-      if (start >= index->codes.size())
-      {
-        Napi::Error::New(env, "Position must be less than end.").ThrowAsJavaScriptException();
-        return env.Undefined();
-      }
-    }
-
-    auto buffer = info[0].As<Napi::Buffer<uint8_t>>();
-    auto length = buffer.Length();
-    if (length + start > index->codes.size())
+    if (isDisposed(info.Env()))
     {
-      Napi::Error::New(env, "Buffer size must be less than or equal to the remaining size.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      return info.Env().Undefined();
     }
 
-    // write buffer to codes
-    std::memcpy(&index->codes.data()[start], buffer.Data(), length);
-
-    return env.Undefined();
+    return Napi::Number::New(info.Env(), index_->d);
   }
 
-  Napi::Value getIds(const Napi::CallbackInfo &info)
+  Napi::Value getCodeSize(const Napi::CallbackInfo &info)
   {
-    Napi::Env env = info.Env();
-
-    auto index = dynamic_cast<faiss::IndexIDMap *>(index_.get());
-    auto length = index->id_map.size();
-    Napi::Array ids = Napi::Array::New(env, length);
-    auto id_map = index->id_map.data();
-    for (size_t i = 0; i < length; i++)
+    if (isDisposed(info.Env()))
     {
-      ids[i] = Napi::BigInt::New(env, id_map[i]);
+      return info.Env().Undefined();
     }
 
-    return ids;
+    return Napi::Number::New(info.Env(), index_->code_size);
   }
 
   Napi::Value getNProbe(const Napi::CallbackInfo &info)
   {
-    auto index = dynamic_cast<faiss::IndexIVF *>(index_.get());
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    auto index = dynamic_cast<faiss::IndexBinaryIVF *>(index_.get());
     return Napi::Number::New(info.Env(), index->nprobe);
   }
 
   Napi::Value setNProbe(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
-
-    if (info.Length() != 1)
+    if (isDisposed(env))
     {
-      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    if (!info[0].IsNumber())
+
+    if (!readSetterArg(info))
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number.").ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    auto index = dynamic_cast<faiss::IndexIVF *>(index_.get());
-    index->nprobe = info[0].As<Napi::Number>().Int32Value();
+    auto lock = writeLock();
+    auto index = dynamic_cast<faiss::IndexBinaryIVF *>(index_.get());
+    index->nprobe = info[0].As<Napi::Number>().Uint32Value();
     return env.Undefined();
   }
 
   Napi::Value getEfConstruction(const Napi::CallbackInfo &info)
   {
-    auto index = dynamic_cast<faiss::IndexHNSW *>(index_.get());
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    auto index = dynamic_cast<faiss::IndexBinaryHNSW *>(index_.get());
     return Napi::Number::New(info.Env(), index->hnsw.efConstruction);
   }
 
   Napi::Value setEfConstruction(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
-
-    if (info.Length() != 1)
+    if (isDisposed(env))
     {
-      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    if (!info[0].IsNumber())
+
+    if (!readSetterArg(info))
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number.").ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    auto index = dynamic_cast<faiss::IndexHNSW *>(index_.get());
+    auto lock = writeLock();
+    auto index = dynamic_cast<faiss::IndexBinaryHNSW *>(index_.get());
     index->hnsw.efConstruction = info[0].As<Napi::Number>().Int32Value();
     return env.Undefined();
   }
 
   Napi::Value getEfSearch(const Napi::CallbackInfo &info)
   {
-    auto index = dynamic_cast<faiss::IndexHNSW *>(index_.get());
+    if (isDisposed(info.Env()))
+    {
+      return info.Env().Undefined();
+    }
+
+    auto index = dynamic_cast<faiss::IndexBinaryHNSW *>(index_.get());
     return Napi::Number::New(info.Env(), index->hnsw.efSearch);
   }
 
   Napi::Value setEfSearch(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
-
-    if (info.Length() != 1)
+    if (isDisposed(env))
     {
-      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    if (!info[0].IsNumber())
+
+    if (!readSetterArg(info))
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number.").ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    auto index = dynamic_cast<faiss::IndexHNSW *>(index_.get());
+    auto lock = writeLock();
+    auto index = dynamic_cast<faiss::IndexBinaryHNSW *>(index_.get());
     index->hnsw.efSearch = info[0].As<Napi::Number>().Int32Value();
     return env.Undefined();
   }
@@ -530,6 +5844,10 @@ public:
   Napi::Value add(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
 
     if (info.Length() != 1)
     {
@@ -537,38 +5855,33 @@ public:
           .ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    if (!info[0].IsArray())
+
+    CodeInput xb;
+    if (!readCodes(env, info[0], "first", xb))
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be an Array.").ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    Napi::Array arr = info[0].As<Napi::Array>();
-    size_t length = arr.Length();
-    auto dv = std::div(length, index_->d);
-    if (dv.rem != 0)
+    auto lock = writeLock();
+    try
     {
-      Napi::Error::New(env, "Invalid the given array length.")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
+      index_->add(xb.length / index_->code_size, xb.data);
     }
-
-    float *xb = new float[length];
-    for (size_t i = 0; i < length; i++)
+    catch (const faiss::FaissException &ex)
     {
-      Napi::Value val = arr[i];
-      xb[i] = val.As<Napi::Number>().FloatValue();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
     }
 
-    index_->add(dv.quot, xb);
-
-    delete[] xb;
     return env.Undefined();
   }
 
   Napi::Value addWithIds(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
 
     if (info.Length() != 2)
     {
@@ -576,94 +5889,45 @@ public:
           .ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    if (!info[0].IsArray())
-    {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be an Array.").ThrowAsJavaScriptException();
-      return env.Undefined();
-    }
-    if (!info[1].IsArray())
+    if (!isIdInput(info[1]))
     {
       Napi::TypeError::New(env, "Invalid the second argument type, must be an Array.").ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    Napi::Array arr = info[0].As<Napi::Array>();
-    size_t length = arr.Length();
-    auto dv = std::div(length, index_->d);
-    if (dv.rem != 0)
+    CodeInput xb;
+    IdInput xids;
+    if (!readCodes(env, info[0], "first", xb) || !readIds(env, info[1], xids))
     {
-      Napi::Error::New(env, "Invalid the given array length.")
-          .ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    Napi::Array labels = info[1].As<Napi::Array>();
-    size_t labelCount = labels.Length();
-    if (labelCount != dv.quot)
+    if (xids.length != xb.length / index_->code_size)
     {
       Napi::Error::New(env, "Labels array length must match the number of vectors.")
           .ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    float *xb = new float[length];
-    for (size_t i = 0; i < length; i++)
+    auto lock = writeLock();
+    try
     {
-      Napi::Value val = arr[i];
-      xb[i] = val.As<Napi::Number>().FloatValue();
+      index_->add_with_ids(xids.length, xb.data, xids.data);
     }
-
-    idx_t *xc = new idx_t[labelCount];
-    for (size_t i = 0; i < labelCount; i++)
+    catch (const faiss::FaissException &ex)
     {
-      Napi::Value val = labels[i];
-      if (val.IsNumber())
-      {
-        xc[i] = val.As<Napi::Number>().Int64Value();
-      }
-      else if (val.IsBigInt())
-      {
-        auto lossless = false;
-        xc[i] = val.As<Napi::BigInt>().Int64Value(&lossless);
-      }
-      else
-      {
-        Napi::Error::New(env, "Expected a Number or BigInt as array item. (at: " + std::to_string(i) + ")")
-            .ThrowAsJavaScriptException();
-        return env.Undefined();
-      }
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
     }
 
-    index_->add_with_ids(dv.quot, xb, xc);
-
-    delete[] xb;
-    delete[] xc;
-
-    return env.Undefined();
-  }
-
-  Napi::Value reset(const Napi::CallbackInfo &info)
-  {
-    Napi::Env env = info.Env();
-
-    index_->reset();
-
-    return env.Undefined();
-  }
-
-  Napi::Value dispose(const Napi::CallbackInfo &info)
-  {
-    Napi::Env env = info.Env();
-
-    auto idx = index_.release();
-    delete idx;
-    index_ = nullptr;
-
     return env.Undefined();
   }
 
   Napi::Value train(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
 
     if (info.Length() != 1)
     {
@@ -671,105 +5935,89 @@ public:
           .ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    if (!info[0].IsArray())
+
+    CodeInput xb;
+    if (!readCodes(env, info[0], "first", xb))
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be an Array.").ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    Napi::Array arr = info[0].As<Napi::Array>();
-    size_t length = arr.Length();
-    auto dv = std::div(length, index_->d);
-    if (dv.rem != 0)
+    auto lock = writeLock();
+    try
     {
-      Napi::Error::New(env, "Invalid the given array length.")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
+      index_->train(xb.length / index_->code_size, xb.data);
     }
-
-    float *xb = new float[length];
-    for (size_t i = 0; i < length; i++)
+    catch (const faiss::FaissException &ex)
     {
-      Napi::Value val = arr[i];
-      xb[i] = val.As<Napi::Number>().FloatValue();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
     }
 
-    index_->train(dv.quot, xb);
-
-    delete[] xb;
     return env.Undefined();
   }
 
+  // Results are `{ distances: Int32Array, labels: BigInt64Array }`, nq * k each.
   Napi::Value search(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
-
-    uint32_t k = index_->ntotal;
-    if (info.Length() < 1 || !info[0].IsArray())
+    if (isDisposed(env))
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be an Array.").ThrowAsJavaScriptException();
       return env.Undefined();
     }
-    if (info.Length() == 2)
-    {
-      if (!info[1].IsNumber())
-      {
-        Napi::TypeError::New(env, "Invalid the second argument type, must be a Number.").ThrowAsJavaScriptException();
-        return env.Undefined();
-      }
 
-      k = info[1].As<Napi::Number>().Uint32Value();
+    CodeInput xq;
+    idx_t k = 0;
+    if (!readSearchArgs(info, xq, k))
+    {
+      return env.Undefined();
     }
 
-    if (k > index_->ntotal)
+    auto nq = xq.length / index_->code_size;
+    std::vector<int32_t> D(k * nq);
+    std::vector<idx_t> I(k * nq);
+
+    auto lock = readLock();
+    try
     {
-      k = index_->ntotal;
+      OmpThreadsScope threads;
+      index_->search(nq, xq.data, k, D.data(), I.data());
     }
-
-    Napi::Array arr = info[0].As<Napi::Array>();
-    size_t length = arr.Length();
-    auto dv = std::div(length, index_->d);
-    if (dv.rem != 0)
+    catch (const faiss::FaissException &ex)
     {
-      Napi::Error::New(env, "Invalid the given array length.")
-          .ThrowAsJavaScriptException();
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    float *xq = new float[length];
-    for (size_t i = 0; i < length; i++)
+    return toSearchResult(env, std::move(D), std::move(I));
+  }
+
+  Napi::Value searchAsync(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
     {
-      Napi::Value val = arr[i];
-      xq[i] = val.As<Napi::Number>().FloatValue();
+      return env.Undefined();
     }
 
-    auto nq = dv.quot;
-    idx_t *I = new idx_t[k * nq];
-    float *D = new float[k * nq];
-
-    index_->search(nq, xq, k, D, I);
-
-    Napi::Array arr_distances = Napi::Array::New(env, k * nq);
-    Napi::Array arr_labels = Napi::Array::New(env, k * nq);
-    for (size_t i = 0; i < k * nq; i++)
+    CodeInput xq;
+    idx_t k = 0;
+    if (!readSearchArgs(info, xq, k, true))
     {
-      idx_t label = I[i];
-      float distance = D[i];
-      arr_distances[i] = Napi::Number::New(env, distance);
-      arr_labels[i] = Napi::BigInt::New(env, label);
+      return env.Undefined();
     }
-    delete[] I;
-    delete[] D;
 
-    Napi::Object results = Napi::Object::New(env);
-    results.Set("distances", arr_distances);
-    results.Set("labels", arr_labels);
-    return results;
+    auto worker = new SearchWorker(env, this, info.This().As<Napi::Object>(), std::move(xq), k);
+    auto promise = worker->GetPromise();
+    worker->Queue();
+    return promise;
   }
 
   Napi::Value reconstruct(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
 
     if (info.Length() != 1)
     {
@@ -794,68 +6042,101 @@ public:
       return env.Undefined();
     }
 
-    float *inpArr = new float[index_->d];
-    Napi::Array outArr = Napi::Array::New(env, index_->d);
-    index_->reconstruct(key, inpArr);
-    for (size_t i = 0; i < index_->d; i++)
+    auto lock = readLock();
+    auto code = Napi::Uint8Array::New(env, index_->code_size);
+    try
     {
-      outArr[i] = Napi::Number::New(env, inpArr[i]);
+      index_->reconstruct(key, code.Data());
+    }
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
     }
-    delete[] inpArr;
 
-    return outArr;
+    return code;
   }
 
-  Napi::Value reconstructBatch(const Napi::CallbackInfo &info)
+  Napi::Value removeIds(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
 
-    if (info.Length() != 1 || !info[0].IsArray())
+    if (info.Length() != 1)
     {
-      Napi::Error::New(env, "Expected 1 array argument, but got " + std::to_string(info.Length()) + ".")
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
           .ThrowAsJavaScriptException();
       return env.Undefined();
     }
+    if (!isIdInput(info[0]))
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be an Array.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
 
-    Napi::Array keysArr = info[0].As<Napi::Array>();
-    auto keyCount = keysArr.Length();
-    idx_t *keys = new idx_t[keyCount];
-    for (size_t i = 0; i < keyCount; i++)
+    IdInput xb;
+    if (!readIds(env, info[0], xb))
     {
-      Napi::Value val = keysArr[i];
-      if (val.IsNumber())
-      {
-        keys[i] = val.As<Napi::Number>().Int64Value();
-      }
-      else if (val.IsBigInt())
-      {
-        auto lossless = false;
-        keys[i] = val.As<Napi::BigInt>().Int64Value(&lossless);
-      }
-      else
-      {
-        Napi::TypeError::New(env, "Invalid the first argument type, must be a Number or BigInt.").ThrowAsJavaScriptException();
-        return env.Undefined();
-      }
+      return env.Undefined();
     }
 
-    auto dimCount = keyCount * index_->d;
-    float *inpArr = new float[dimCount];
-    Napi::Array outArr = Napi::Array::New(env, dimCount);
-    index_->reconstruct_batch(keyCount, keys, inpArr);
-    for (size_t i = 0; i < dimCount; i++)
+    auto lock = writeLock();
+    try
     {
-      outArr[i] = Napi::Number::New(env, inpArr[i]);
+      return Napi::Number::New(env, index_->remove_ids(faiss::IDSelectorArray{xb.length, xb.data}));
     }
-    delete[] keys;
-    delete[] inpArr;
+    catch (const faiss::FaissException &ex)
+    {
+      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+  }
 
-    return outArr;
+  Napi::Value reset(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
+
+    auto lock = writeLock();
+    index_->reset();
+
+    return env.Undefined();
+  }
+
+  // Unlike IndexBase::dispose, there is no batcher to stop, and the only attached index is the
+  // quantizer of an IVF index.
+  Napi::Value dispose(const Napi::CallbackInfo &info)
+  {
+    Napi::Env env = info.Env();
+
+    if (*parents_ > 0)
+    {
+      Napi::Error::New(env, "Index is used by another index (as a quantizer) and cannot be disposed.").ThrowAsJavaScriptException();
+      return env.Undefined();
+    }
+
+    // waits for in-flight async work to complete
+    auto lock = writeLock();
+    index_.reset();
+    mutex_.unlinkAll();
+    quantizerRef_.reset();
+
+    return env.Undefined();
   }
 
   Napi::Value write(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
+    if (isDisposed(env))
+    {
+      return env.Undefined();
+    }
 
     if (info.Length() != 1)
     {
@@ -871,9 +6152,10 @@ public:
 
     const std::string fname = info[0].As<Napi::String>().Utf8Value();
 
+    auto lock = readLock();
     try
     {
-      faiss::write_index(index_.get(), fname.c_str());
+      faiss::write_index_binary(index_.get(), fname.c_str());
     }
     catch (const faiss::FaissException &ex)
     {
@@ -883,144 +6165,240 @@ public:
     return env.Undefined();
   }
 
-  Napi::Value mergeFrom(const Napi::CallbackInfo &info)
+  Napi::Value toBuffer(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
-
-    if (info.Length() != 1)
-    {
-      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
-    }
-    if (!info[0].IsObject())
+    if (isDisposed(env))
     {
-      Napi::TypeError::New(env, "Invalid argument type, must be an object.").ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    Napi::Object otherIndex = info[0].As<Napi::Object>();
-    T *otherIndexInstance = Napi::ObjectWrap<T>::Unwrap(otherIndex);
-
-    if (otherIndexInstance->index_->d != index_->d)
+    if (info.Length() != 0)
     {
-      Napi::Error::New(env, "The merging index must have the same dimension.").ThrowAsJavaScriptException();
+      Napi::Error::New(env, "Expected 0 arguments, but got " + std::to_string(info.Length()) + ".")
+          .ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
+    auto writer = new faiss::VectorIOWriter();
+
+    auto lock = readLock();
     try
     {
-      index_->merge_from(*(otherIndexInstance->index_));
+      writer->data.reserve(serializedSizeHint(index_.get()));
+      faiss::write_index_binary(index_.get(), writer);
     }
     catch (const faiss::FaissException &ex)
     {
+      delete writer;
       Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
       return env.Undefined();
     }
 
-    return env.Undefined();
+    // hand the serialized bytes to JS as-is, they are freed with the buffer
+    return Napi::Buffer<uint8_t>::New(
+        env, writer->data.data(), writer->data.size(),
+        [](Napi::Env, uint8_t *, faiss::VectorIOWriter *hint)
+        { delete hint; },
+        writer);
   }
 
-  Napi::Value removeIds(const Napi::CallbackInfo &info)
-  {
-    Napi::Env env = info.Env();
+protected:
+  using CodeInput = ArrayInput<uint8_t>;
 
-    if (info.Length() != 1)
+  class SearchWorker : public Napi::AsyncWorker
+  {
+  public:
+    SearchWorker(Napi::Env env, BinaryIndexBase *self, Napi::Object owner, CodeInput &&xq, idx_t k)
+        : Napi::AsyncWorker(env), deferred_(Napi::Promise::Deferred::New(env)), self_(self), owner_(Napi::Persistent(owner)), xq_(std::move(xq)), k_(k)
     {
-      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
-          .ThrowAsJavaScriptException();
-      return env.Undefined();
     }
-    if (!info[0].IsArray())
+
+    Napi::Promise GetPromise()
     {
-      Napi::TypeError::New(env, "Invalid the first argument type, must be an Array.").ThrowAsJavaScriptException();
-      return env.Undefined();
+      return deferred_.Promise();
     }
 
-    Napi::Array arr = info[0].As<Napi::Array>();
-    size_t length = arr.Length();
-
-    idx_t *xb = new idx_t[length];
-    for (size_t i = 0; i < length; i++)
+  protected:
+    void Execute() override
     {
-      Napi::Value val = arr[i];
-      if (val.IsNumber())
-      {
-        xb[i] = val.As<Napi::Number>().Int64Value();
-      }
-      else if (val.IsBigInt())
+      try
       {
-        auto lossless = false;
-        xb[i] = val.As<Napi::BigInt>().Int64Value(&lossless);
+        auto lock = self_->readLock();
+        auto index = self_->index_.get();
+        if (!index)
+        {
+          SetError("Index has been disposed.");
+          return;
+        }
+        OmpThreadsScope threads;
+        auto nq = xq_.length / index->code_size;
+        D_.resize(k_ * nq);
+        I_.resize(k_ * nq);
+        index->search(nq, xq_.data, k_, D_.data(), I_.data());
       }
-      else
+      catch (const faiss::FaissException &ex)
       {
-        Napi::Error::New(env, "Expected a Number or BigInt as array item. (at: " + std::to_string(i) + ")")
-            .ThrowAsJavaScriptException();
-        return env.Undefined();
+        SetError(ex.what());
       }
     }
 
-    size_t num = index_->remove_ids(faiss::IDSelectorArray{length, xb});
+    void OnOK() override
+    {
+      deferred_.Resolve(toSearchResult(Env(), std::move(D_), std::move(I_)));
+    }
 
-    delete[] xb;
-    return Napi::Number::New(info.Env(), num);
+    void OnError(const Napi::Error &e) override
+    {
+      deferred_.Reject(e.Value());
+    }
+
+  private:
+    Napi::Promise::Deferred deferred_;
+    BinaryIndexBase *self_;
+    Napi::ObjectReference owner_;
+    CodeInput xq_;
+    idx_t k_;
+    std::vector<int32_t> D_;
+    std::vector<idx_t> I_;
+  };
+
+  static Napi::Object toSearchResult(Napi::Env env, std::vector<int32_t> &&D, std::vector<idx_t> &&I)
+  {
+    auto n = D.size();
+    Napi::Object results = Napi::Object::New(env);
+    results.Set("distances", Napi::Int32Array::New(env, n, toExternalArrayBuffer(env, std::move(D)), 0));
+    results.Set("labels", Napi::BigInt64Array::New(env, n, toExternalArrayBuffer(env, std::move(I)), 0));
+    return results;
   }
 
-  Napi::Value toBuffer(const Napi::CallbackInfo &info)
+  static bool readSetterArg(const Napi::CallbackInfo &info)
   {
     Napi::Env env = info.Env();
 
-    if (info.Length() != 0)
+    if (info.Length() != 1)
     {
-      Napi::Error::New(env, "Expected 0 arguments, but got " + std::to_string(info.Length()) + ".")
+      Napi::Error::New(env, "Expected 1 argument, but got " + std::to_string(info.Length()) + ".")
           .ThrowAsJavaScriptException();
-      return env.Undefined();
+      return false;
     }
+    if (!info[0].IsNumber())
+    {
+      Napi::TypeError::New(env, "Invalid the first argument type, must be a Number.").ThrowAsJavaScriptException();
+      return false;
+    }
+    return true;
+  }
 
-    faiss::VectorIOWriter *writer = new faiss::VectorIOWriter();
-
-    try
+  // Read packed vectors, validating they are whole codes of the index. Uint8Array and Buffer memory
+  // is used in place; Arrays of bytes are copied. With `copy`, Uint8Array memory is copied too, for
+  // work that outlives the call.
+  bool readCodes(Napi::Env env, const Napi::Value &value, const std::string &position, CodeInput &out, bool copy = false)
+  {
+    if (value.IsTypedArray() && value.As<Napi::TypedArray>().TypedArrayType() == napi_uint8_array)
     {
-      faiss::write_index(index_.get(), writer);
+      auto arr = value.As<Napi::Uint8Array>();
+      out.data = arr.Data();
+      out.length = arr.ElementLength();
+      if (copy)
+      {
+        out.own();
+      }
     }
-    catch (const faiss::FaissException &ex)
+    else if (value.IsArray())
     {
-      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      Napi::Array arr = value.As<Napi::Array>();
+      out.owned.resize(arr.Length());
+      for (size_t i = 0; i < out.owned.size(); i++)
+      {
+        Napi::Value val = arr[i];
+        double byte = val.IsNumber() ? val.As<Napi::Number>().DoubleValue() : -1;
+        if (!(byte >= 0 && byte <= 255 && byte == std::floor(byte)))
+        {
+          Napi::Error::New(env, "Invalid the given array values.")
+              .ThrowAsJavaScriptException();
+          return false;
+        }
+        out.owned[i] = static_cast<uint8_t>(byte);
+      }
+      out.data = out.owned.data();
+      out.length = out.owned.size();
+    }
+    else
+    {
+      Napi::TypeError::New(env, "Invalid the " + position + " argument type, must be a Uint8Array.").ThrowAsJavaScriptException();
+      return false;
     }
 
-    // return buffer from IOWriter
-    return Napi::Buffer<uint8_t>::Copy(env, writer->data.data(), writer->data.size());
+    if (out.length % index_->code_size != 0)
+    {
+      Napi::Error::New(env, "Invalid the given array length.")
+          .ThrowAsJavaScriptException();
+      return false;
+    }
+    return true;
   }
 
-  Napi::Value toIDMap2(const Napi::CallbackInfo &info)
+  // Parse `(x, k?)` of the search methods; k defaults to and is capped at ntotal.
+  bool readSearchArgs(const Napi::CallbackInfo &info, CodeInput &xq, idx_t &k, bool copy = false)
   {
     Napi::Env env = info.Env();
 
-    if (info.Length() != 0)
+    if (info.Length() < 1 || info.Length() > 2)
     {
-      Napi::Error::New(env, "Expected 0 arguments, but got " + std::to_string(info.Length()) + ".")
+      Napi::Error::New(env, "Expected 1 or 2 arguments, but got " + std::to_string(info.Length()) + ".")
           .ThrowAsJavaScriptException();
-      return env.Undefined();
+      return false;
     }
-
-    Napi::Object instance = T::constructor->New({});
-    T *index = Napi::ObjectWrap<T>::Unwrap(instance);
-
-    try
+    k = index_->ntotal;
+    if (info.Length() > 1)
     {
-      // wrap the new IDMap'd index around the old and leave it to faiss to throw if index not compatible
-      index->index_ = std::unique_ptr<faiss::IndexIDMap2>(new faiss::IndexIDMap2(index_.get()));
+      if (!info[1].IsNumber())
+      {
+        Napi::TypeError::New(env, "Invalid the second argument type, must be a Number.").ThrowAsJavaScriptException();
+        return false;
+      }
+      k = std::min<idx_t>(info[1].As<Napi::Number>().Uint32Value(), index_->ntotal);
     }
-    catch (const faiss::FaissException &ex)
+
+    return readCodes(env, info[0], "first", xq, copy);
+  }
+
+  // As in IndexBase, every instance method but dispose starts with this check.
+  bool isDisposed(Napi::Env env)
+  {
+    if (index_)
     {
-      Napi::Error::New(env, ex.what()).ThrowAsJavaScriptException();
+      return false;
     }
+    Napi::Error::New(env, "Index has been disposed.").ThrowAsJavaScriptException();
+    return true;
+  }
 
-    return instance;
+  std::shared_lock<IndexMutex> readLock()
+  {
+    return std::shared_lock<IndexMutex>(mutex_);
   }
 
-protected:
-  std::unique_ptr<faiss::Index> index_;
+  std::unique_lock<IndexMutex> writeLock()
+  {
+    return std::unique_lock<IndexMutex>(mutex_);
+  }
+
+  // IndexBinaryIVF uses its quantizer in place: as IndexBase::attachQuantizer, keep it alive and
+  // link its lock to this one, so that training excludes searches on the quantizer.
+  void attachQuantizer(Napi::Object quantizer)
+  {
+    auto instance = Napi::ObjectWrap<T>::Unwrap(quantizer);
+    auto lock = writeLock();
+    mutex_.link(instance->writeLock().release());
+    quantizerRef_.emplace(Napi::Persistent(quantizer), instance->parents_);
+  }
+
+  // Declared before index_ to be destroyed after it.
+  std::optional<SubIndexRef> quantizerRef_;
+  std::shared_ptr<std::atomic<int>> parents_ = std::make_shared<std::atomic<int>>(0);
+  std::unique_ptr<faiss::IndexBinary> index_;
+  IndexMutex mutex_;
   inline static Napi::FunctionReference *constructor;
 };
@@ -1,4 +1,5 @@
-const { Index, MetricType, IndexType } = require('..');
+const { PassThrough, Writable } = require('stream');
+const { Index, MetricType, IndexType, setNumThreads, getNumThreads } = require('..');
 
 describe('Index', () => {
   describe('#fromFactory', () => {
@@ -31,13 +32,18 @@ describe('Index', () => {
   });
 
   describe('#indexType', () => {
-    it('IndexFlatIP is of type IndexFlat', () => {
+    it('IndexFlatIP is of type IndexFlatIP', () => {
       const idx = Index.fromFactory(2, 'Flat', MetricType.METRIC_INNER_PRODUCT);
-      expect(idx.indexType).toBe(IndexType.IndexFlat);
+      expect(idx.indexType).toBe(IndexType.IndexFlatIP);
     });
 
-    it('IndexFlatL2 is of type IndexFlat', () => {
+    it('IndexFlatL2 is of type IndexFlatL2', () => {
       const idx = Index.fromFactory(2, 'Flat', MetricType.METRIC_L2);
+      expect(idx.indexType).toBe(IndexType.IndexFlatL2);
+    });
+
+    it('IndexFlat with another metric is of type IndexFlat', () => {
+      const idx = Index.fromFactory(2, 'Flat', MetricType.METRIC_L1);
       expect(idx.indexType).toBe(IndexType.IndexFlat);
     });
 
@@ -46,9 +52,49 @@ describe('Index', () => {
       expect(idx.indexType).toBe(IndexType.IndexHNSW);
     });
 
-    it('IndexIVFFlat is of type IndexIVF', () => {
+    it('IndexHNSWSQ is of type IndexHNSWSQ', () => {
+      const idx = Index.fromFactory(4, 'HNSW32,SQ8');
+      expect(idx.indexType).toBe(IndexType.IndexHNSWSQ);
+    });
+
+    it('IndexHNSWPQ is of type IndexHNSWPQ', () => {
+      const idx = Index.fromFactory(4, 'HNSW32,PQ2');
+      expect(idx.indexType).toBe(IndexType.IndexHNSWPQ);
+    });
+
+    it('IndexIVFFlat is of type IndexIVFFlat', () => {
       const idx = Index.fromFactory(2, 'IVF2,Flat', MetricType.METRIC_INNER_PRODUCT);
-      expect(idx.indexType).toBe(IndexType.IndexIVF);
+      expect(idx.indexType).toBe(IndexType.IndexIVFFlat);
+    });
+
+    it('IndexIVFPQ is of type IndexIVFPQ', () => {
+      const idx = Index.fromFactory(4, 'IVF2,PQ2');
+      expect(idx.indexType).toBe(IndexType.IndexIVFPQ);
+    });
+
+    it('IndexIVFScalarQuantizer is of type IndexIVFScalarQuantizer', () => {
+      const idx = Index.fromFactory(4, 'IVF2,SQ8');
+      expect(idx.indexType).toBe(IndexType.IndexIVFScalarQuantizer);
+    });
+
+    it('IndexIVFPQFastScan is of type IndexIVFPQFastScan', () => {
+      const idx = Index.fromFactory(4, 'IVF2,PQ2x4fs');
+      expect(idx.indexType).toBe(IndexType.IndexIVFPQFastScan);
+    });
+
+    it('IndexPQ is of type IndexPQ', () => {
+      const idx = Index.fromFactory(4, 'PQ2');
+      expect(idx.indexType).toBe(IndexType.IndexPQ);
+    });
+
+    it('IndexPQFastScan is of type IndexPQFastScan', () => {
+      const idx = Index.fromFactory(4, 'PQ2x4fs');
+      expect(idx.indexType).toBe(IndexType.IndexPQFastScan);
+    });
+
+    it('keeps the type through fromBuffer', () => {
+      const idx = Index.fromFactory(4, 'IVF2,SQ8');
+      expect(Index.fromBuffer(idx.toBuffer()).indexType).toBe(IndexType.IndexIVFScalarQuantizer);
     });
   });
 
@@ -63,6 +109,146 @@ describe('Index', () => {
 
       expect(index.ntotal).toBe(newIndex.ntotal);
     });
+
+    it('round trips an IVF index from a buffer slice', () => {
+      const index = Index.fromFactory(2, 'IVF2,Flat');
+      const x = Array.from({ length: 400 }, () => Math.random());
+      index.train(x);
+      index.add(x);
+
+      const buf = index.toBuffer();
+      const padded = Buffer.alloc(buf.length + 16);
+      buf.copy(padded, 8);
+      const newIndex = Index.fromBuffer(padded.subarray(8, 8 + buf.length));
+
+      expect(newIndex.ntotal).toBe(200);
+      expect(newIndex.search(x.slice(0, 2), 5)).toEqual(index.search(x.slice(0, 2), 5));
+    });
+
+    it('throws an error on a truncated buffer', () => {
+      const index = Index.fromFactory(2, 'Flat');
+      index.add([1, 0, 0, 1]);
+      const buf = index.toBuffer();
+      expect(() => Index.fromBuffer(buf.subarray(0, buf.length - 4))).toThrow();
+    });
+  });
+
+  describe('#writeStream', () => {
+    const x = Array.from({ length: 400 }, () => Math.random());
+    const createIndex = () => {
+      const index = Index.fromFactory(2, 'IVF2,Flat');
+      index.train(x);
+      index.add(x);
+      return index;
+    };
+
+    it('writes the same bytes as toBuffer in chunks', async () => {
+      const index = createIndex();
+      const chunks = [];
+      const stream = new Writable({
+        highWaterMark: 64,
+        write(chunk, encoding, callback) {
+          chunks.push(chunk);
+          setImmediate(callback);
+        },
+      });
+
+      const written = await index.writeStream(stream, { chunkSize: 256 });
+      const buf = index.toBuffer();
+      expect(written).toBe(buf.length);
+      expect(chunks.length).toBe(Math.ceil(buf.length / 256));
+      expect(Buffer.concat(chunks).equals(buf)).toBe(true);
+    });
+
+    it('rejects modifications while streaming', async () => {
+      const index = createIndex();
+      const stream = new PassThrough();
+      stream.resume();
+      const promise = index.writeStream(stream, { chunkSize: 64 });
+      expect(() => index.add([1, 2])).toThrow('Index cannot be modified while writeStream is in progress.');
+      await promise;
+      index.add([1, 2]);
+      expect(index.ntotal).toBe(201);
+    });
+
+    it('rejects modifications of the indexes used by the streaming one', async () => {
+      const base = Index.fromFactory(2, 'Flat');
+      const refined = base.toRefineFlat();
+      refined.add(x);
+      const stream = new PassThrough();
+      stream.resume();
+      const promise = refined.writeStream(stream, { chunkSize: 64 });
+      expect(() => base.add([1, 2])).toThrow('Index cannot be modified while writeStream is in progress.');
+      await promise;
+      base.add([1, 2]);
+      expect(base.ntotal).toBe(201);
+    });
+
+    it('rejects on stream errors', async () => {
+      const index = createIndex();
+      const stream = new Writable({
+        write(chunk, encoding, callback) {
+          callback(new Error('disk full'));
+        },
+      });
+      stream.on('error', () => {});
+      await expect(index.writeStream(stream)).rejects.toThrow('disk full');
+    });
+  });
+
+  describe('#readStream', () => {
+    it('round trips through writeStream', async () => {
+      const x = Array.from({ length: 400 }, () => Math.random());
+      const index = Index.fromFactory(2, 'IVF2,Flat');
+      index.train(x);
+      index.add(x);
+
+      const stream = new PassThrough();
+      const reading = Index.readStream(stream, { highWaterMark: 128 });
+      await index.writeStream(stream, { chunkSize: 100 });
+      stream.end();
+
+      const newIndex = await reading;
+      expect(newIndex.ntotal).toBe(200);
+      expect(newIndex.search(x.slice(0, 2), 5)).toEqual(index.search(x.slice(0, 2), 5));
+    });
+
+    it('rejects on a truncated stream', async () => {
+      const index = Index.fromFactory(2, 'Flat');
+      index.add([1, 0, 0, 1]);
+      const buf = index.toBuffer();
+
+      const stream = new PassThrough();
+      stream.end(buf.subarray(0, buf.length - 4));
+      await expect(Index.readStream(stream)).rejects.toThrow();
+    });
+  });
+
+  describe('#setNumThreads', () => {
+    const defaultThreads = getNumThreads();
+    afterEach(() => setNumThreads(0));
+
+    it('sets the process-wide thread count', () => {
+      setNumThreads(2);
+      expect(getNumThreads()).toBe(2);
+      setNumThreads(0);
+      expect(getNumThreads()).toBe(defaultThreads);
+    });
+
+    it('throws an error on an invalid thread count', () => {
+      expect(() => setNumThreads(-1)).toThrow('Invalid the first argument type, must be a non-negative Number.');
+    });
+
+    it('accepts a per-call thread budget', async () => {
+      const index = Index.fromFactory(2, 'IVF2,Flat');
+      const x = Array.from({ length: 400 }, () => Math.random());
+      await index.trainAsync(x, { threads: 1 });
+      await index.addAsync(x, { threads: 1 });
+      const expected = index.search(x.slice(0, 4), 3);
+      expect(index.search(x.slice(0, 4), 3, { threads: 1 })).toEqual(expected);
+      await expect(index.searchAsync(x.slice(0, 4), 3, { threads: 2 })).resolves.toEqual(expected);
+      expect(() => index.search(x.slice(0, 4), 3, { threads: 'all' })).toThrow('Invalid threads option, must be a non-negative Number.');
+    });
   });
 
   describe('#metricType', () => {
@@ -139,6 +325,86 @@ describe('Index', () => {
     });
   });
 
+  describe('#toRefine', () => {
+    const x = Array.from({ length: 8 * 1000 }, () => Math.random());
+
+    it('re-ranks candidates with a flat index', () => {
+      const base = Index.fromFactory(8, 'PQ4x4');
+      const refined = base.toRefineFlat(50);
+      refined.train(x);
+      refined.add(x);
+
+      expect(base.ntotal).toBe(1000);
+      expect(refined.indexType).toBe(IndexType.IndexRefine);
+      expect(refined.kFactor).toBe(50);
+      const { labels, distances } = refined.search(x.slice(0, 8), 1);
+      expect(labels).toEqual([0n]);
+      expect(distances).toEqual([0]);
+    });
+
+    it('re-ranks candidates with another index', () => {
+      const base = Index.fromFactory(8, 'PQ4x4');
+      const fine = Index.fromFactory(8, 'SQfp16');
+      const refined = base.toRefine(fine, 50);
+      refined.train(x);
+      refined.add(x);
+
+      expect(base.ntotal).toBe(1000);
+      expect(fine.ntotal).toBe(1000);
+      expect(refined.search(x.slice(0, 8), 1).labels).toEqual([0n]);
+    });
+
+    it('ignores search options that do not apply and rejects filters', () => {
+      const base = Index.fromFactory(8, 'IVF4,Flat');
+      const refined = base.toRefineFlat(4);
+      refined.train(x);
+      refined.add(x);
+
+      expect(refined.search(x.slice(0, 8), 1, { nprobe: 4 }).labels).toEqual([0n]);
+      expect(() => refined.search(x.slice(0, 8), 1, { filter: [0] })).toThrow('The filter option is not supported by this index type.');
+    });
+
+    it('kFactor can be changed', () => {
+      const refined = Index.fromFactory(8, 'Flat').toRefineFlat();
+      expect(refined.kFactor).toBe(1);
+      refined.kFactor = 4;
+      expect(refined.kFactor).toBe(4);
+      expect(() => { refined.kFactor = 0; }).toThrow('Invalid the first argument type, must be a Number of at least 1.');
+    });
+
+    it('kFactor is only set on refine indexes', () => {
+      const index = Index.fromFactory(8, 'Flat');
+      expect(index.kFactor).toBeUndefined();
+      expect(() => { index.kFactor = 2; }).toThrow('kFactor can only be set on an index made by toRefineFlat or toRefine.');
+    });
+
+    it('throws an error if the indexes hold different vectors', () => {
+      const fine = Index.fromFactory(8, 'Flat');
+      fine.add(x.slice(0, 8));
+      expect(() => Index.fromFactory(8, 'Flat').toRefine(fine)).toThrow('The refine index must hold as many vectors as this index.');
+    });
+
+    it('throws an error if the refine index is this index', () => {
+      const index = Index.fromFactory(8, 'Flat');
+      expect(() => index.toRefine(index)).toThrow('Invalid the first argument, must be another Index not sharing parts with this one.');
+    });
+
+    it('keeps the indexes it uses from being disposed', () => {
+      const base = Index.fromFactory(8, 'Flat');
+      const fine = Index.fromFactory(8, 'Flat');
+      const refined = base.toRefine(fine);
+      const message = 'Index is used by another index (as a shard, replica, refine source or quantizer) and cannot be disposed.';
+      expect(() => base.dispose()).toThrow(message);
+      expect(() => fine.dispose()).toThrow(message);
+
+      refined.add(x.slice(0, 8));
+      expect(refined.search(x.slice(0, 8), 1).labels).toEqual([0n]);
+      refined.dispose();
+      base.dispose();
+      fine.dispose();
+    });
+  });
+
   describe('#reset', () => {
     let index;
 
@@ -175,5 +441,37 @@ describe('Index', () => {
     it('disposing an index does not throw', () => {
       index.dispose();
     });
+
+    it('waits for in-flight async work', async () => {
+      const pending = index.addAsync([1, 1]).then(() => 'added', (err) => err.message);
+      index.dispose();
+      expect(['added', 'Index has been disposed.']).toContain(await pending);
+    });
+
+    it('throws an error on calls made afterwards', () => {
+      index.dispose();
+      const message = 'Index has been disposed.';
+      expect(() => index.search([1, 0], 1)).toThrow(message);
+      expect(() => index.ntotal).toThrow(message);
+      expect(() => index.addAsync([1, 1])).toThrow(message);
+      expect(() => index.searchAsync([1, 0], 1)).toThrow(message);
+      expect(() => index.toRefineFlat()).toThrow(message);
+      index.dispose();
+    });
+  });
+
+  describe('#concurrency', () => {
+    it('searches while adding', async () => {
+      const index = Index.fromFactory(2, 'Flat');
+      index.add([1, 0, 0, 1]);
+      const x = Array.from({ length: 2000 }, () => Math.random());
+      const work = [index.addAsync(x)];
+      for (let i = 0; i < 8; i++) {
+        work.push(index.searchAsync([1, 0], 1));
+      }
+      const [, ...results] = await Promise.all(work);
+      results.forEach(r => expect(r.labels).toHaveLength(1));
+      expect(index.ntotal).toBe(1002);
+    });
   });
 });
@@ -0,0 +1,113 @@
+const { IndexBinary, IndexBinaryFlat, IndexType } = require('..');
+
+describe('IndexBinaryFlat', () => {
+  // 4 vectors of 16 bits
+  const x = new Uint8Array([
+    0b00000000, 0b00000000,
+    0b00000001, 0b00000000,
+    0b00000011, 0b00000001,
+    0b11111111, 0b11111111,
+  ]);
+
+  describe('#constructor', () => {
+    it('takes the dimension in bits', () => {
+      const index = new IndexBinaryFlat(16);
+      expect(index.dims).toBe(16);
+      expect(index.codeSize).toBe(2);
+      expect(index.isTrained).toBe(true);
+      expect(index.indexType).toBe(IndexType.IndexBinaryFlat);
+    });
+
+    it('throws an error if the dimension is not a multiple of 8', () => {
+      expect(() => new IndexBinaryFlat(12)).toThrow();
+    });
+  });
+
+  describe('#search', () => {
+    const index = new IndexBinaryFlat(16);
+    index.add(x);
+
+    it('returns Hamming distances', () => {
+      const { distances, labels } = index.search(new Uint8Array([0b00000001, 0b00000000]), 4);
+      expect(distances).toEqual(new Int32Array([0, 1, 2, 15]));
+      expect(labels).toEqual(new BigInt64Array([1n, 0n, 2n, 3n]));
+    });
+
+    it('accepts plain arrays of bytes', () => {
+      expect(index.search([255, 255], 1).labels).toEqual(new BigInt64Array([3n]));
+    });
+
+    it('throws an error on arrays of non-bytes', () => {
+      expect(() => index.search([256, 0], 1)).toThrow('Invalid the given array values.');
+      expect(() => index.search([-1, 0], 1)).toThrow('Invalid the given array values.');
+      expect(() => index.search([1.5, 0], 1)).toThrow('Invalid the given array values.');
+      expect(() => index.add(['a', 0])).toThrow('Invalid the given array values.');
+      expect(index.ntotal).toBe(4);
+    });
+
+    it('searches asynchronously', async () => {
+      const { distances, labels } = await index.searchAsync(x.subarray(4, 6), 1);
+      expect(distances).toEqual(new Int32Array([0]));
+      expect(labels).toEqual(new BigInt64Array([2n]));
+    });
+
+    it('throws an error on partial vectors', () => {
+      expect(() => index.search(new Uint8Array(3))).toThrow('Invalid the given array length.');
+      expect(() => index.search(new Float32Array(2))).toThrow('Invalid the first argument type, must be a Uint8Array.');
+    });
+  });
+
+  describe('#reconstruct', () => {
+    it('returns the packed vector', () => {
+      const index = new IndexBinaryFlat(16);
+      index.add(x);
+      expect(index.reconstruct(2)).toEqual(x.subarray(4, 6));
+    });
+  });
+
+  describe('#toBuffer', () => {
+    it('round trips through a buffer and a file', () => {
+      const index = new IndexBinaryFlat(16);
+      index.add(x);
+
+      const fromBuffer = IndexBinaryFlat.fromBuffer(index.toBuffer());
+      expect(fromBuffer.ntotal).toBe(4);
+      expect(fromBuffer.search(x.subarray(6, 8), 1).labels).toEqual(new BigInt64Array([3n]));
+
+      const fname = '_tmp.binary.index';
+      index.write(fname);
+      const read = IndexBinary.read(fname);
+      expect(read.indexType).toBe(IndexType.IndexBinaryFlat);
+      expect(read.ntotal).toBe(4);
+    });
+  });
+
+  describe('#fromFactory', () => {
+    it('builds binary indexes', () => {
+      expect(IndexBinary.fromFactory(16, 'BFlat').indexType).toBe(IndexType.IndexBinaryFlat);
+      expect(IndexBinary.fromFactory(16, 'BHNSW16').indexType).toBe(IndexType.IndexBinaryHNSW);
+    });
+  });
+
+  describe('#dispose', () => {
+    it('waits for in-flight searches', async () => {
+      const index = new IndexBinaryFlat(16);
+      index.add(x);
+      const pending = index.searchAsync(x, 1).then((result) => result.labels, (err) => err.message);
+      index.dispose();
+      const result = await pending;
+      if (typeof result === 'string') {
+        expect(result).toBe('Index has been disposed.');
+      } else {
+        expect(result).toEqual(new BigInt64Array([0n, 1n, 2n, 3n]));
+      }
+    });
+
+    it('throws an error on calls made afterwards', () => {
+      const index = new IndexBinaryFlat(16);
+      index.dispose();
+      expect(() => index.searchAsync(x, 1)).toThrow('Index has been disposed.');
+      expect(() => index.add(x)).toThrow('Index has been disposed.');
+    });
+  });
+});
@@ -0,0 +1,28 @@
+const { IndexBinaryHNSW, IndexType } = require('..');
+
+describe('IndexBinaryHNSW', () => {
+  const x = Uint8Array.from({ length: 8 * 500 }, () => Math.floor(Math.random() * 256));
+
+  describe('#constructor', () => {
+    it('1 arg will result in a 32 neighbor graph', () => {
+      const index = new IndexBinaryHNSW(64);
+      expect(index.dims).toBe(64);
+      expect(index.codeSize).toBe(8);
+      expect(index.indexType).toBe(IndexType.IndexBinaryHNSW);
+    });
+  });
+
+  describe('#search', () => {
+    it('finds the query vector', () => {
+      const index = new IndexBinaryHNSW(64, 16);
+      index.efConstruction = 80;
+      index.add(x);
+      index.efSearch = 64;
+
+      expect(index.efSearch).toBe(64);
+      const { distances, labels } = index.search(x.subarray(0, 8), 1);
+      expect(labels).toEqual(new BigInt64Array([0n]));
+      expect(distances).toEqual(new Int32Array([0]));
+    });
+  });
+});
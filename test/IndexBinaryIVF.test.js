@@ -0,0 +1,42 @@
+const { IndexBinaryFlat, IndexBinaryIVF, IndexType } = require('..');
+
+describe('IndexBinaryIVF', () => {
+  const x = Uint8Array.from({ length: 8 * 1000 }, () => Math.floor(Math.random() * 256));
+
+  describe('#constructor', () => {
+    it('needs training', () => {
+      const index = new IndexBinaryIVF(new IndexBinaryFlat(64), 64, 4);
+      expect(index.isTrained).toBe(false);
+      expect(index.nprobe).toBe(1);
+      expect(index.indexType).toBe(IndexType.IndexBinaryIVF);
+    });
+
+    it('keeps the quantizer attached', async () => {
+      const quantizer = new IndexBinaryFlat(64);
+      const index = new IndexBinaryIVF(quantizer, 64, 4);
+      index.train(x);
+      index.add(x);
+      expect(() => quantizer.dispose()).toThrow('Index is used by another index (as a quantizer) and cannot be disposed.');
+
+      await Promise.all([index.searchAsync(x.subarray(0, 8), 1), quantizer.searchAsync(x.subarray(0, 8), 1)]);
+      index.dispose();
+      quantizer.dispose();
+      expect(() => quantizer.search(x.subarray(0, 8), 1)).toThrow('Index has been disposed.');
+    });
+  });
+
+  describe('#search', () => {
+    it('finds the query vector with its label', () => {
+      const index = new IndexBinaryIVF(new IndexBinaryFlat(64), 64, 4);
+      index.train(x);
+      index.addWithIds(x, BigInt64Array.from({ length: 1000 }, (_, i) => BigInt(i + 100)));
+      index.nprobe = 4;
+
+      const { distances, labels } = index.search(x.subarray(0, 8), 1);
+      expect(labels).toEqual(new BigInt64Array([100n]));
+      expect(distances).toEqual(new Int32Array([0]));
+      expect(index.removeIds([100n])).toBe(1);
+      expect(index.ntotal).toBe(999);
+    });
+  });
+});
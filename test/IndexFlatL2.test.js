@@ -1,4 +1,4 @@
-const { IndexFlatL2 } = require('..');
+const { IndexFlatL2, IndexType } = require('..');
 
 describe('IndexFlatL2', () => {
     describe('#read', () => {
@@ -18,6 +18,7 @@ describe('IndexFlatL2', () => {
             const index_loaded = IndexFlatL2.read(fname);
             expect(index_loaded.dims).toBe(2);
             expect(index_loaded.ntotal).toBe(1);
+            expect(index_loaded.indexType).toBe(IndexType.IndexFlatL2);
         })
     });
 
@@ -114,6 +115,305 @@ describe('IndexFlatL2', () => {
         });
     });
 
+    describe('#typed array input', () => {
+        const vectors = [1, 0, 1, 2, 1, 3, 1, 1];
+
+        it('adds and searches Float32Array vectors', () => {
+            const index = new IndexFlatL2(2);
+            index.add(Float32Array.from(vectors));
+            expect(index.ntotal).toBe(4);
+            expect(index.search(Float32Array.from([1, 0]), 4)).toMatchObject({ distances: [0, 1, 4, 9], labels: [0n, 3n, 1n, 2n] });
+        });
+
+        it('adds Buffer and ArrayBuffer vectors', () => {
+            const index = new IndexFlatL2(2);
+            index.add(Buffer.from(Float32Array.from(vectors.slice(0, 4)).buffer));
+            index.add(Float32Array.from(vectors.slice(4)).buffer);
+            expect(index.codes).toStrictEqual(Buffer.from(Float32Array.from(vectors).buffer));
+        });
+
+        it('adds BigInt64Array ids', () => {
+            const index = new IndexFlatL2(2).toIDMap2();
+            index.addWithIds(Float32Array.from(vectors.slice(0, 4)), BigInt64Array.from([10n, 20n]));
+            expect(index.ids).toEqual([10n, 20n]);
+            expect(index.removeIds(BigInt64Array.from([10n]))).toBe(1);
+        });
+
+        it('throws an error if the length of given array is not adhere to the dimension of the index', () => {
+            const index = new IndexFlatL2(2);
+            expect(() => { index.add(new Float32Array(3)) }).toThrow('Invalid the given array length.');
+            expect(() => { index.add(Buffer.alloc(6)) }).toThrow('Invalid the given array length.');
+        });
+
+        it('throws an error if a byte array does not start at a multiple of 4 bytes', () => {
+            const index = new IndexFlatL2(2);
+            expect(() => { index.add(Buffer.alloc(9).subarray(1)) }).toThrow('Invalid the first argument, byte arrays must start at a multiple of 4 bytes.');
+        });
+
+        it('throws an error if given an unsupported typed array', () => {
+            const index = new IndexFlatL2(2);
+            expect(() => { index.add(new Float64Array(2)) }).toThrow('Invalid the first argument type, must be an Array.');
+        });
+
+        it('searches asynchronously', async () => {
+            const index = new IndexFlatL2(2);
+            await index.addAsync(Float32Array.from(vectors));
+            await expect(index.searchAsync(Float32Array.from([1, 1]), 1)).resolves.toMatchObject({ distances: [0], labels: [3n] });
+        });
+    });
+
+    describe('#searchTyped', () => {
+        const index = new IndexFlatL2(2);
+
+        beforeAll(() => {
+            index.add([1, 0, 1, 2, 1, 3, 1, 1]);
+        });
+
+        it('returns typed array results', () => {
+            const results = index.searchTyped([1, 0], 4);
+            expect(results.distances).toBeInstanceOf(Float32Array);
+            expect(results.labels).toBeInstanceOf(BigInt64Array);
+            expect(Array.from(results.distances)).toEqual([0, 1, 4, 9]);
+            expect(Array.from(results.labels)).toEqual([0n, 3n, 1n, 2n]);
+        });
+
+        it('returns ntotal results if 2nd argument not provided', () => {
+            expect(index.searchTyped([1, 1]).labels.length).toBe(4);
+        });
+    });
+
+    describe('#searchInto', () => {
+        const index = new IndexFlatL2(2);
+
+        beforeAll(() => {
+            index.add([1, 0, 1, 2, 1, 3, 1, 1]);
+        });
+
+        it('writes results into the given arrays', () => {
+            const distances = new Float32Array(4);
+            const labels = new BigInt64Array(4);
+            expect(index.searchInto([1, 0, 1, 1], 2, distances, labels)).toBe(4);
+            expect(Array.from(distances)).toEqual([0, 1, 0, 1]);
+            expect(Array.from(labels)).toEqual([0n, 3n, 3n, 0n]);
+        });
+
+        it('throws an error if the output arrays are too small', () => {
+            expect(() => { index.searchInto([1, 0], 2, new Float32Array(1), new BigInt64Array(2)) }).toThrow('Output arrays must hold at least 2 results.');
+        });
+
+        it('throws an error if the output arrays are of the wrong type', () => {
+            expect(() => { index.searchInto([1, 0], 2, [], new BigInt64Array(2)) }).toThrow('Invalid the third argument type, must be a Float32Array.');
+            expect(() => { index.searchInto([1, 0], 2, new Float32Array(2), []) }).toThrow('Invalid the fourth argument type, must be a BigInt64Array.');
+        });
+    });
+
+    describe('#search with filter', () => {
+        const index = new IndexFlatL2(2);
+
+        beforeAll(() => {
+            index.add([1, 0, 1, 2, 1, 3, 1, 1]);
+        });
+
+        it('only returns ids from an allow-list', () => {
+            expect(index.search([1, 0], 2, { filter: [1, 2] })).toMatchObject({ distances: [4, 9], labels: [1n, 2n] });
+            expect(index.search([1, 0], 2, { filter: new BigInt64Array([1n, 2n]) })).toMatchObject({ distances: [4, 9], labels: [1n, 2n] });
+        });
+
+        it('only returns ids within a range', () => {
+            expect(index.search([1, 0], 2, { filter: { min: 2, max: 4 } })).toMatchObject({ distances: [1, 9], labels: [3n, 2n] });
+        });
+
+        it('only returns ids set in a bitmap', () => {
+            expect(index.search([1, 0], 2, { filter: new Uint8Array([0b0101]) })).toMatchObject({ distances: [0, 9], labels: [0n, 2n] });
+        });
+
+        it('pads results with -1 when fewer ids pass the filter than k', () => {
+            expect(index.searchTyped([1, 0], 2, { filter: [2] }).labels).toEqual(new BigInt64Array([2n, -1n]));
+        });
+
+        it('applies to the other search variants', async () => {
+            const filter = new Uint8Array([0b0110]);
+            await expect(index.searchAsync([1, 0], 2, { filter })).resolves.toMatchObject({ labels: [1n, 2n] });
+            const labels = new BigInt64Array(2);
+            index.searchInto([1, 0], 2, new Float32Array(2), labels, { filter });
+            expect(labels).toEqual(new BigInt64Array([1n, 2n]));
+            expect(Array.from(index.rangeSearch([1, 0], 5, { filter }).labels)).toEqual([1n]);
+        });
+
+        it('throws an error on an invalid filter', () => {
+            expect(() => { index.search([1, 0], 2, []) }).toThrow('Invalid the third argument type, must be an Object.');
+            expect(() => { index.search([1, 0], 2, { filter: 'all' }) }).toThrow('Invalid filter option');
+        });
+    });
+
+    describe('#rangeSearch', () => {
+        const index = new IndexFlatL2(2);
+
+        beforeAll(() => {
+            index.add([1, 0, 1, 2, 1, 3, 1, 1]);
+        });
+
+        it('returns the neighbors within the radius of each query', () => {
+            const results = index.rangeSearch([1, 0, 1, 3, 9, 9], 1.5);
+            expect(results.lims).toBeInstanceOf(BigUint64Array);
+            expect(Array.from(results.lims)).toEqual([0n, 2n, 4n, 4n]);
+            expect(Array.from(results.labels.subarray(0, 2)).sort()).toEqual([0n, 3n]);
+            expect(Array.from(results.labels.subarray(2, 4)).sort()).toEqual([1n, 2n]);
+            expect(Array.from(results.distances).every((d) => d < 1.5)).toBe(true);
+        });
+
+        it('returns empty arrays when nothing is within the radius', () => {
+            const results = index.rangeSearch([9, 9], 1);
+            expect(Array.from(results.lims)).toEqual([0n, 0n]);
+            expect(results.labels.length).toBe(0);
+            expect(results.distances.length).toBe(0);
+        });
+
+        it('throws an error if the radius is not a number', () => {
+            expect(() => { index.rangeSearch([1, 0], '1') }).toThrow('Invalid the second argument type, must be a Number.');
+        });
+    });
+
+    describe('#searchAsync', () => {
+        const index = new IndexFlatL2(2);
+
+        beforeAll(() => {
+            index.add([1, 0, 1, 2, 1, 3, 1, 1]);
+        });
+
+        it('throws an error if given a non-Array object to first argument', () => {
+            expect(() => { index.searchAsync('[1, 2, 3]', 2) }).toThrow('Invalid the first argument type, must be an Array.');
+        });
+
+        it('throws an error if the length of given array is not adhere to the dimension of the index', () => {
+            expect(() => { index.searchAsync([1, 2, 3], 2) }).toThrow('Invalid the given array length.');
+        });
+
+        it('resolves with the same results as search', async () => {
+            await expect(index.searchAsync([1, 0], 4)).resolves.toMatchObject({ distances: [0, 1, 4, 9], labels: [0n, 3n, 1n, 2n] });
+            await expect(index.searchAsync([1, 1, 1, 0], 1)).resolves.toMatchObject({ distances: [0, 0], labels: [3n, 0n] });
+        });
+
+        it('runs concurrent searches', async () => {
+            const results = await Promise.all([index.searchAsync([1, 0], 1), index.searchAsync([1, 3], 1)]);
+            expect(results.map(r => r.labels)).toEqual([[0n], [2n]]);
+        });
+    });
+
+    describe('#setBatching', () => {
+        it('throws an error if given a non-Object', () => {
+            const index = new IndexFlatL2(2);
+            expect(() => { index.setBatching(1) }).toThrow('Invalid the first argument type, must be an Object.');
+        });
+
+        it('is disabled by default', () => {
+            const index = new IndexFlatL2(2);
+            expect(index.getBatchingStats()).toEqual({ enabled: false });
+        });
+
+        it('coalesces concurrent searches', async () => {
+            const index = new IndexFlatL2(2);
+            index.add([1, 0, 1, 2, 1, 3, 1, 1]);
+            index.setBatching({ maxBatch: 16, maxWaitMicros: 50000 });
+            const queries = [[1, 0], [1, 2], [1, 3], [1, 1]];
+            const results = await Promise.all(queries.map(q => index.searchAsync(q, 1)));
+            expect(results.map(r => r.labels)).toEqual([[0n], [1n], [2n], [3n]]);
+
+            const stats = index.getBatchingStats();
+            expect(stats.enabled).toBe(true);
+            expect(stats.queries).toBe(4);
+            expect(stats.vectors).toBe(4);
+            expect(stats.batches).toBeLessThan(4);
+            expect(stats.maxBatchSize).toBeGreaterThan(1);
+
+            index.setBatching({ maxBatch: 0 });
+            expect(index.getBatchingStats()).toEqual({ enabled: false });
+        });
+
+        it('only batches queries with the same k', async () => {
+            const index = new IndexFlatL2(2);
+            index.add([1, 0, 1, 2, 1, 3, 1, 1]);
+            index.setBatching({ maxBatch: 16, maxWaitMicros: 1000 });
+            const [a, b] = await Promise.all([index.searchAsync([1, 0], 1), index.searchAsync([1, 0], 2)]);
+            expect(a.labels).toEqual([0n]);
+            expect(b.labels).toEqual([0n, 3n]);
+            index.dispose();
+        });
+    });
+
+    describe('#getMetrics', () => {
+        it('starts empty', () => {
+            const metrics = new IndexFlatL2(2).getMetrics();
+            expect(metrics.search).toMatchObject({ calls: 0, vectors: 0, errors: 0 });
+            expect(metrics.search.native.count).toBe(0);
+            expect(metrics.search.native.buckets.length).toBe(metrics.bucketBoundsMs.length);
+        });
+
+        it('counts calls and vectors of sync and async operations', async () => {
+            const index = new IndexFlatL2(2);
+            index.add([1, 0, 1, 2]);
+            await index.addAsync([1, 3]);
+            index.search([1, 0, 1, 2], 1);
+            index.searchTyped([1, 0], 1);
+            await index.searchAsync([1, 0], 1);
+
+            const metrics = index.getMetrics();
+            expect(metrics.add).toMatchObject({ calls: 2, vectors: 3, errors: 0 });
+            expect(metrics.search).toMatchObject({ calls: 3, vectors: 4, errors: 0 });
+            expect(metrics.search.native.count).toBe(3);
+            expect(metrics.search.marshalling.count).toBe(3);
+            expect(metrics.search.native.p99).toBeGreaterThan(0);
+            expect(metrics.train.calls).toBe(0);
+        });
+
+        it('counts batched searches', async () => {
+            const index = new IndexFlatL2(2);
+            index.add([1, 0, 1, 2]);
+            index.setBatching({ maxBatch: 16, maxWaitMicros: 1000 });
+            await Promise.all([index.searchAsync([1, 0], 1), index.searchAsync([1, 2], 1)]);
+            expect(index.getMetrics().search).toMatchObject({ calls: 2, vectors: 2 });
+            index.dispose();
+        });
+
+        it('has increasing bucket bounds', () => {
+            const bounds = new IndexFlatL2(2).getMetrics().bucketBoundsMs;
+            expect(bounds.every((bound, i) => i === 0 || bound > bounds[i - 1])).toBe(true);
+        });
+    });
+
+    describe('#addAsync', () => {
+        it('adds vectors', async () => {
+            const index = new IndexFlatL2(2);
+            await index.addAsync([1, 0, 1, 2]);
+            expect(index.ntotal).toBe(2);
+        });
+
+        it('throws an error if the length of given array is not adhere to the dimension of the index', () => {
+            const index = new IndexFlatL2(2);
+            expect(() => { index.addAsync([1, 2, 3]) }).toThrow('Invalid the given array length.');
+        });
+
+        it('adds vectors with ids', async () => {
+            const index = new IndexFlatL2(2).toIDMap2();
+            await index.addWithIdsAsync([1, 0, 1, 2], [10n, 20n]);
+            expect(index.ids).toEqual([10n, 20n]);
+        });
+
+        it('rejects when faiss throws', async () => {
+            const index = new IndexFlatL2(2);
+            await expect(index.addWithIdsAsync([1, 0], [10n])).rejects.toThrow();
+        });
+
+        it('copies typed inputs before returning', async () => {
+            const index = new IndexFlatL2(2);
+            const x = Float32Array.from([1, 0, 1, 2]);
+            const pending = index.addAsync(x);
+            x.fill(0);
+            await pending;
+            expect(index.reconstruct(1)).toEqual([1, 2]);
+        });
+    });
+
     describe("#merge", () => {
         const index1 = new IndexFlatL2(2);
         beforeAll(() => {
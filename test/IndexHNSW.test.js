@@ -1,10 +1,11 @@
-const { IndexHNSW, MetricType } = require('..');
+const { IndexHNSW, MetricType, IndexType } = require('..');
 
 describe('IndexHNSW', () => {
   describe('#constructor', () => {
     it('1 arg will result in index with default neighbors & metric', () => {
       const index = new IndexHNSW(2);
       expect(index.dims).toBe(2);
+      expect(index.indexType).toBe(IndexType.IndexHNSW);
     });
 
     it('2 args will result in index with default metric', () => {
@@ -17,4 +18,37 @@ describe('IndexHNSW', () => {
       expect(index.dims).toBe(2);
     });
   });
+
+  describe('#search', () => {
+    it('skips ids excluded by a filter', () => {
+      const index = new IndexHNSW(2);
+      const x = Array.from({ length: 400 }, () => Math.random());
+      index.add(x);
+
+      const allowed = Array.from({ length: 20 }, (_, i) => BigInt(i * 10));
+      const { labels } = index.search(x.slice(0, 4), 5, { filter: allowed });
+      expect(labels.every((label) => label === -1n || allowed.includes(label))).toBe(true);
+    });
+
+    it('uses per-call efSearch without changing the index', () => {
+      const index = new IndexHNSW(2);
+      const x = Array.from({ length: 400 }, () => Math.random());
+      index.add(x);
+
+      const { labels } = index.search(x.slice(0, 2), 1, { efSearch: 64, checkRelativeDistance: false });
+      expect(labels).toEqual([0n]);
+      expect(index.efSearch).toBe(16);
+      expect(() => { index.search(x.slice(0, 2), 1, { checkRelativeDistance: 1 }) }).toThrow('Invalid checkRelativeDistance option, must be a Boolean.');
+    });
+
+    it('returns the graph walk counters with stats', () => {
+      const index = new IndexHNSW(2);
+      const x = Array.from({ length: 400 }, () => Math.random());
+      index.add(x);
+
+      const { stats } = index.search(x.slice(0, 4), 5, { withStats: true });
+      expect(stats.hnsw.ndis).toBeGreaterThan(0);
+      expect(stats.ivf).toBeUndefined();
+    });
+  });
 });
@@ -0,0 +1,32 @@
+const { IndexHNSWPQ, IndexType } = require('..');
+
+describe('IndexHNSWPQ', () => {
+  const x = Array.from({ length: 8 * 500 }, () => Math.random());
+
+  describe('#constructor', () => {
+    it('2 args will result in an 8 bit index', () => {
+      const index = new IndexHNSWPQ(8, 4);
+      expect(index.M).toBe(4);
+      expect(index.nbits).toBe(8);
+      expect(index.codeSize).toBe(4);
+      expect(index.efConstruction).toBe(40);
+      expect(index.indexType).toBe(IndexType.IndexHNSWPQ);
+    });
+
+    it('throws an error if pqM does not divide d', () => {
+      expect(() => new IndexHNSWPQ(8, 3)).toThrow();
+    });
+  });
+
+  describe('#search', () => {
+    it('finds neighbors after training', () => {
+      const index = new IndexHNSWPQ(8, 4, 16, 4);
+      index.train(x);
+      index.add(x);
+
+      const { labels } = index.search(x.slice(0, 8), 5);
+      expect(labels.every((label) => label >= 0n)).toBe(true);
+      expect(index.search(x.slice(0, 8), 5, { efSearch: 64 }).labels.length).toBe(5);
+    });
+  });
+});
@@ -0,0 +1,37 @@
+const { IndexHNSWSQ, QuantizerType, IndexType } = require('..');
+
+describe('IndexHNSWSQ', () => {
+  const x = Array.from({ length: 8 * 500 }, () => Math.random());
+
+  describe('#constructor', () => {
+    it('1 arg will result in an 8 bit index', () => {
+      const index = new IndexHNSWSQ(8);
+      expect(index.qtype).toBe(QuantizerType.QT_8bit);
+      expect(index.codeSize).toBe(8);
+      expect(index.isTrained).toBe(false);
+      expect(index.indexType).toBe(IndexType.IndexHNSWSQ);
+    });
+
+    it('stores fp16 codes', () => {
+      const index = new IndexHNSWSQ(8, QuantizerType.QT_fp16, 16);
+      expect(index.qtype).toBe(QuantizerType.QT_fp16);
+      expect(index.codeSize).toBe(16);
+    });
+  });
+
+  describe('#search', () => {
+    it('finds the query vector after training', () => {
+      const index = new IndexHNSWSQ(8);
+      index.train(x);
+      index.add(x);
+      index.efSearch = 64;
+
+      expect(index.search(x.slice(0, 8), 1).labels).toEqual([0n]);
+    });
+
+    it('throws an error when adding before training', () => {
+      const index = new IndexHNSWSQ(8);
+      expect(() => index.add(x)).toThrow();
+    });
+  });
+});
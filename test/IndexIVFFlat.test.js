@@ -1,5 +1,7 @@
-const { Index, IndexFlatL2, IndexIVFFlat } = require('..');
-const { readdirSync, unlinkSync } = require('fs');
+const {
+  Index, IndexFlatL2, IndexIVFFlat, IndexType, getSearchStats, resetSearchStats,
+} = require('..');
+const { readdirSync, statSync, unlinkSync } = require('fs');
 const os = require('os');
 
 afterEach(() => {
@@ -12,6 +14,25 @@ describe('IndexIVFFlat', () => {
       const quantizer = new IndexFlatL2(2);
       const index = new IndexIVFFlat(quantizer, 2, 2);
       expect(index.nprobe).toBe(1);
+      expect(index.indexType).toBe(IndexType.IndexIVFFlat);
+    });
+
+    it('keeps the quantizer attached', async () => {
+      const quantizer = new IndexFlatL2(2);
+      const index = new IndexIVFFlat(quantizer, 2, 2);
+      const x = Array.from({ length: 200 }, () => Math.random());
+      index.train(x);
+      index.add(x);
+      expect(() => quantizer.dispose()).toThrow('Index is used by another index (as a shard, replica, refine source or quantizer) and cannot be disposed.');
+
+      const searches = [];
+      for (let i = 0; i < 8; i++) {
+        searches.push(index.searchAsync(x.slice(0, 2), 1));
+        searches.push(quantizer.searchAsync(x.slice(0, 2), 1));
+      }
+      await Promise.all(searches);
+      index.dispose();
+      quantizer.dispose();
     });
   });
 
@@ -31,6 +52,237 @@ describe('IndexIVFFlat', () => {
     });
   });
 
+  describe('#trainAsync', () => {
+    it('trains the index', async () => {
+      const quantizer = new IndexFlatL2(2);
+      const index = new IndexIVFFlat(quantizer, 2, 2);
+      const x = Array.from({ length: 200 }, () => Math.random());
+      expect(index.isTrained).toBe(false);
+      await index.trainAsync(x);
+      expect(index.isTrained).toBe(true);
+      await index.addAsync(x);
+      expect(index.ntotal).toBe(100);
+    });
+  });
+
+  describe('#read', () => {
+    it('throws an error if options is not an object', () => {
+      expect(() => IndexIVFFlat.read('_tmp.missing.ivf', 1)).toThrow('Invalid the second argument type, must be an Object.');
+    });
+
+    it('reads a memory-mapped index', () => {
+      if (os.platform() === 'win32') return; // windows doesn't support memory-mapped inverted lists
+
+      const index = Index.fromFactory(2, 'IVF2,Flat');
+      const x = Array.from({ length: 400 }, () => Math.random());
+      index.train(x);
+      index.add(x);
+      index.write('_tmp.mmap.ivf');
+
+      const mapped = IndexIVFFlat.read('_tmp.mmap.ivf', { mmap: true, readOnly: true });
+      expect(mapped.ntotal).toBe(200);
+      expect(mapped.search(x.slice(0, 2), 5)).toEqual(index.search(x.slice(0, 2), 5));
+    });
+  });
+
+  describe('#search with parameters', () => {
+    const x = Array.from({ length: 400 }, () => Math.random());
+    const flat = Index.fromFactory(2, 'Flat');
+    let ivf;
+
+    beforeAll(() => {
+      const index = Index.fromFactory(2, 'IVF2,Flat');
+      index.train(x);
+      index.add(x);
+      ivf = IndexIVFFlat.fromBuffer(index.toBuffer());
+      flat.add(x);
+    });
+
+    it('probes the given number of lists without changing nprobe', () => {
+      expect(ivf.search(x.slice(0, 4), 5, { nprobe: 2 })).toEqual(flat.search(x.slice(0, 4), 5));
+      expect(ivf.nprobe).toBe(1);
+    });
+
+    it('limits the number of codes visited', () => {
+      const { labels } = ivf.search(x.slice(0, 2), 5, { nprobe: 2, maxCodes: 3 });
+      expect(labels.slice(0, 5).filter((label) => label !== -1n).length).toBeLessThanOrEqual(3);
+    });
+
+    it('throws an error on an invalid parameter', () => {
+      expect(() => { ivf.search(x.slice(0, 2), 5, { nprobe: '2' }) }).toThrow('Invalid nprobe option, must be a non-negative Number.');
+    });
+  });
+
+  describe('#search with stats', () => {
+    const x = Array.from({ length: 400 }, () => Math.random());
+    const index = Index.fromFactory(2, 'IVF2,Flat');
+
+    beforeAll(() => {
+      index.train(x);
+      index.add(x);
+    });
+
+    it('returns the work done by the call', () => {
+      const { labels, stats } = index.search(x.slice(0, 4), 5, { nprobe: 2, withStats: true });
+      expect(labels).toEqual(index.search(x.slice(0, 4), 5, { nprobe: 2 }).labels);
+      expect(stats.timeMs).toBeGreaterThanOrEqual(0);
+      expect(stats.ivf.nq).toBe(2);
+      expect(stats.ivf.nlist).toBe(4);
+      expect(stats.ivf.ndis).toBe(400);
+      expect(stats.hnsw).toBeUndefined();
+    });
+
+    it('returns stats with typed and async results', async () => {
+      expect(index.searchTyped(x.slice(0, 2), 5, { withStats: true }).stats.ivf.nq).toBe(1);
+      expect((await index.searchAsync(x.slice(0, 2), 5, { withStats: true })).stats.ivf.nq).toBe(1);
+    });
+
+    it('omits stats by default', () => {
+      expect(index.search(x.slice(0, 2), 5).stats).toBeUndefined();
+    });
+
+    it('accumulates global stats until reset', () => {
+      resetSearchStats();
+      index.search(x.slice(0, 4), 5);
+      index.search(x.slice(0, 4), 5, { withStats: true });
+      expect(getSearchStats().ivf.nq).toBe(4);
+      resetSearchStats();
+      expect(getSearchStats().ivf).toEqual({
+        nq: 0, nlist: 0, ndis: 0, nheapUpdates: 0, quantizationTime: 0, searchTime: 0,
+      });
+    });
+
+    it('throws an error on an invalid flag', () => {
+      expect(() => { index.search(x.slice(0, 2), 5, { withStats: 1 }) }).toThrow('Invalid withStats option, must be a Boolean.');
+    });
+  });
+
+  describe('#search with filter', () => {
+    it('skips ids excluded by a filter', () => {
+      const index = Index.fromFactory(2, 'IVF2,Flat');
+      const x = Array.from({ length: 400 }, () => Math.random());
+      index.train(x);
+      index.add(x);
+
+      const { labels } = index.search(x.slice(0, 4), 5, { filter: { min: 100, max: 150 } });
+      expect(labels.every((label) => label === -1n || (label >= 100n && label < 150n))).toBe(true);
+    });
+  });
+
+  describe('#rangeSearch', () => {
+    it('matches a flat range search when probing every list', () => {
+      const index = Index.fromFactory(2, 'IVF2,Flat');
+      const x = Array.from({ length: 400 }, () => Math.random());
+      index.train(x);
+      index.add(x);
+      const ivf = IndexIVFFlat.fromBuffer(index.toBuffer());
+      ivf.nprobe = 2;
+      const flat = Index.fromFactory(2, 'Flat');
+      flat.add(x);
+
+      const results = ivf.rangeSearch(x.slice(0, 2), 0.01);
+      const expected = flat.rangeSearch(x.slice(0, 2), 0.01);
+      expect(Array.from(results.lims)).toEqual(Array.from(expected.lims));
+      expect(Array.from(results.labels).sort()).toEqual(Array.from(expected.labels).sort());
+    });
+  });
+
+  describe('#warmup', () => {
+    if (os.platform() === 'win32') return; // windows doesn't support memory-mapped inverted lists
+
+    const x = Array.from({ length: 400 }, () => Math.random());
+    beforeAll(() => {
+      const index = Index.fromFactory(2, 'IVF2,Flat');
+      index.train(x);
+      index.add(x);
+      index.write('_tmp.warmup.ivf');
+    });
+
+    it('pages in the inverted lists of a memory-mapped index', async () => {
+      const mapped = IndexIVFFlat.read('_tmp.warmup.ivf', { mmap: true, readOnly: true });
+      const progress = [];
+      const result = await mapped.warmup({ onProgress: (p) => progress.push(p) });
+      expect(result.lists).toBe(2);
+      expect(result.bytes).toBe(200 * (2 * 4 + 8));
+      expect(progress.length).toBeGreaterThan(0);
+    });
+
+    it('respects the maxLists budget', async () => {
+      const mapped = IndexIVFFlat.read('_tmp.warmup.ivf', { mmap: true, readOnly: true });
+      expect((await mapped.warmup({ maxLists: 1 })).lists).toBe(1);
+    });
+
+    it('throws an error on invalid budgets', () => {
+      const mapped = IndexIVFFlat.read('_tmp.warmup.ivf', { mmap: true, readOnly: true });
+      expect(() => mapped.warmup({ maxLists: -1 })).toThrow('Invalid the first argument type, maxLists must be a non-negative Number.');
+      expect(() => mapped.warmup({ maxBytes: NaN })).toThrow('Invalid the first argument type, maxBytes must be a non-negative Number.');
+      expect(() => mapped.warmup({ maxBytes: '1024' })).toThrow('Invalid the first argument type, maxBytes must be a non-negative Number.');
+    });
+
+    it('throws an error if the index is not memory-mapped', () => {
+      const index = IndexIVFFlat.read('_tmp.warmup.ivf');
+      expect(() => index.warmup()).toThrow('Index does not have memory-mapped inverted lists.');
+    });
+
+    it('sets the madvise hint', () => {
+      const mapped = IndexIVFFlat.read('_tmp.warmup.ivf', { mmap: true, readOnly: true });
+      expect(() => mapped.setMadvise('random')).not.toThrow();
+      expect(() => mapped.setMadvise('bogus')).toThrow();
+    });
+  });
+
+  describe('#setOnDiskInvertedLists', () => {
+    it('adds vectors to an on-disk data file', () => {
+      if (os.platform() === 'win32') return; // windows doesn't support on disk inverted lists
+      if (process.env.MKL_SKIP) return;
+
+      const x = Array.from({ length: 2 * 400 }, () => Math.random());
+      const memory = Index.fromFactory(2, 'IVF4,Flat');
+      memory.train(x);
+      memory.write('_tmp.trained.ivf');
+      memory.add(x);
+      const onDisk = IndexIVFFlat.read('_tmp.trained.ivf');
+      onDisk.setOnDiskInvertedLists('_tmp.ondisk.ivfdata');
+      onDisk.add(x.slice(0, 400));
+      onDisk.add(x.slice(400));
+      expect(onDisk.ntotal).toBe(400);
+      expect(statSync('_tmp.ondisk.ivfdata').size).toBeGreaterThanOrEqual(400 * (8 + 8));
+
+      onDisk.nprobe = 2;
+      memory.nprobe = 2;
+      const query = x.slice(0, 20);
+      expect(onDisk.search(query, 5)).toEqual(memory.search(query, 5));
+      onDisk.write('_tmp.ondisk.ivf');
+      const mapped = IndexIVFFlat.read('_tmp.ondisk.ivf', { mmap: true, readOnly: true });
+      mapped.nprobe = 2;
+      expect(mapped.ntotal).toBe(400);
+      expect(mapped.search(query, 5)).toEqual(memory.search(query, 5));
+    });
+
+    it('copies vectors already in the index', () => {
+      if (os.platform() === 'win32') return;
+      if (process.env.MKL_SKIP) return;
+
+      const x = Array.from({ length: 8 * 300 }, () => Math.random());
+      const index = Index.fromFactory(8, 'IVF4,PQ4x4');
+      index.train(x);
+      index.add(x.slice(0, 8 * 100));
+      const before = index.search(x.slice(0, 8), 3);
+      index.setOnDiskInvertedLists('_tmp.ondisk.ivfdata');
+      expect(index.search(x.slice(0, 8), 3)).toEqual(before);
+      index.add(x.slice(8 * 100));
+      expect(index.ntotal).toBe(300);
+    });
+
+    it('throws on indexes without inverted lists', () => {
+      if (os.platform() === 'win32') return;
+
+      const index = new IndexFlatL2(2);
+      expect(() => index.setOnDiskInvertedLists('_tmp.ondisk.ivfdata')).toThrow();
+      expect(() => index.setOnDiskInvertedLists()).toThrow('Expected 1 argument, but got 0.');
+    });
+  });
+
   describe('#mergeOnDisk', () => {
     it('Can merge indexes on disk', () => {
       if (os.platform() === 'win32') return; // windows doesn't support merging on disk
@@ -88,6 +340,89 @@ describe('IndexIVFFlat', () => {
       expect(untrained.ntotal).toBe(200);
       IndexIVFFlat.mergeOnDisk([trained, untrained], '_tmp.merged.ivf', '_tmp.merged.ivfdata');
       expect(trained.ntotal).toBe(200);
+      // the lists of the merged JS indexes are left to them
+      untrained.nprobe = 2;
+      expect(untrained.search(x.slice(0, 2), 1).labels).toEqual([0n]);
+      untrained.addWithIds(x.slice(0, 2), [200]);
+      expect(untrained.ntotal).toBe(201);
+    });
+  });
+
+  describe('#mergeOnDiskAsync', () => {
+    it('Can merge and append indexes on disk with progress', async () => {
+      if (os.platform() === 'win32') return; // windows doesn't support merging on disk
+      if (process.env.MKL_SKIP) return;
+
+      const trained = Index.fromFactory(2, 'IVF2,Flat');
+      const x = Array.from({ length: 600 }, () => Math.random());
+      const y = Array.from({ length: 300 }, (_, i) => i);
+      trained.train(x.slice(0, 200));
+      trained.write('_tmp.trained.ivf');
+      const block = IndexIVFFlat.read('_tmp.trained.ivf');
+      block.addWithIds(x.slice(0, 400), y.slice(0, 200));
+      block.write('_tmp.block.ivf');
+
+      const progress = [];
+      const result = await IndexIVFFlat.mergeOnDiskAsync(['_tmp.trained.ivf', block], '_tmp.merged.ivf', '_tmp.merged.ivfdata', {
+        onProgress: (p) => progress.push(p),
+      });
+      expect(result).toEqual({ lists: 2, totalLists: 2, entries: 200, ntotal: 200 });
+      expect(block.ntotal).toBe(200); // inputs are left as is
+      expect(IndexIVFFlat.read('_tmp.merged.ivf').ntotal).toBe(200);
+      await new Promise((resolve) => setImmediate(resolve));
+      expect(progress.length).toBeGreaterThan(0);
+
+      const block2 = IndexIVFFlat.read('_tmp.trained.ivf');
+      block2.addWithIds(x.slice(400), y.slice(200));
+      block2.write('_tmp.block2.ivf');
+      const appended = await IndexIVFFlat.mergeOnDiskAsync(['_tmp.block2.ivf'], '_tmp.merged.ivf', '_tmp.merged.ivfdata', { append: true, threads: 2 });
+      expect(appended.entries).toBe(100);
+      expect(appended.ntotal).toBe(300);
+
+      const merged = IndexIVFFlat.read('_tmp.merged.ivf');
+      expect(merged.ntotal).toBe(300);
+      merged.nprobe = 2;
+      const { labels } = merged.search(x.slice(500, 502), 1);
+      expect(labels).toEqual([250n]);
+    });
+
+    it('runs concurrent merges of the same indexes in any order', async () => {
+      if (os.platform() === 'win32') return;
+      if (process.env.MKL_SKIP) return;
+
+      const x = Array.from({ length: 400 }, () => Math.random());
+      const a = Index.fromFactory(2, 'IVF2,Flat');
+      a.train(x);
+      a.write('_tmp.trained.ivf');
+      const b = IndexIVFFlat.read('_tmp.trained.ivf');
+      a.add(x.slice(0, 200));
+      b.add(x.slice(200));
+
+      const merges = [];
+      for (let i = 0; i < 4; i++) {
+        merges.push(IndexIVFFlat.mergeOnDiskAsync([a, b], `_tmp.ab${i}.ivf`, `_tmp.ab${i}.ivfdata`));
+        merges.push(IndexIVFFlat.mergeOnDiskAsync([b, a], `_tmp.ba${i}.ivf`, `_tmp.ba${i}.ivfdata`));
+      }
+      const results = await Promise.all(merges);
+      results.forEach((result) => expect(result.ntotal).toBe(200));
+    });
+
+    it('rejects appending to an index without the given data file', async () => {
+      if (os.platform() === 'win32') return;
+      if (process.env.MKL_SKIP) return;
+
+      const trained = Index.fromFactory(2, 'IVF2,Flat');
+      trained.train(Array.from({ length: 200 }, () => Math.random()));
+      trained.write('_tmp.trained.ivf');
+      await expect(IndexIVFFlat.mergeOnDiskAsync(['_tmp.trained.ivf'], '_tmp.trained.ivf', '_tmp.merged.ivfdata', { append: true }))
+        .rejects.toThrow('The output index does not use the given data file.');
+    });
+
+    it('throws on invalid arguments', () => {
+      expect(() => IndexIVFFlat.mergeOnDiskAsync(['_tmp.trained.ivf'], '_tmp.merged.ivf', '_tmp.merged.ivfdata'))
+        .toThrow('Invalid first argument, array must contain at least 2 entries to merge.');
+      expect(() => IndexIVFFlat.mergeOnDiskAsync(['_tmp.trained.ivf', 1], '_tmp.merged.ivf', '_tmp.merged.ivfdata'))
+        .toThrow('Invalid first argument, entries must be IVF indexes or paths.');
     });
   });
 });
@@ -0,0 +1,67 @@
+const { IndexFlatL2, IndexIVFPQ, IndexType } = require('..');
+
+describe('IndexIVFPQ', () => {
+  const x = Array.from({ length: 4 * 1000 }, () => Math.random());
+
+  describe('#constructor', () => {
+    it('4 args will result in index with default nbits & metric', () => {
+      const index = new IndexIVFPQ(new IndexFlatL2(4), 4, 2, 2);
+      expect(index.dims).toBe(4);
+      expect(index.M).toBe(2);
+      expect(index.nbits).toBe(8);
+      expect(index.codeSize).toBe(2);
+      expect(index.byResidual).toBe(true);
+      expect(index.indexType).toBe(IndexType.IndexIVFPQ);
+    });
+
+    it('throws an error if M does not divide d', () => {
+      expect(() => new IndexIVFPQ(new IndexFlatL2(4), 4, 2, 3)).toThrow();
+    });
+  });
+
+  describe('#search', () => {
+    it('finds vectors after training', () => {
+      const index = new IndexIVFPQ(new IndexFlatL2(4), 4, 2, 4, 8);
+      index.train(x);
+      index.add(x);
+      index.nprobe = 2;
+
+      const { labels } = index.search(x.slice(0, 4), 10);
+      expect(labels).toContain(0n);
+    });
+  });
+
+  describe('#byResidual', () => {
+    it('can only be changed before training', () => {
+      const index = new IndexIVFPQ(new IndexFlatL2(4), 4, 2, 2, 4);
+      index.byResidual = false;
+      expect(index.byResidual).toBe(false);
+      index.train(x);
+      expect(() => { index.byResidual = true; }).toThrow('byResidual can only be changed before training.');
+    });
+  });
+
+  describe('#usePrecomputedTable', () => {
+    it('rebuilds the tables of a trained index', () => {
+      const index = new IndexIVFPQ(new IndexFlatL2(4), 4, 2, 2, 4);
+      index.train(x);
+      index.add(x);
+      index.usePrecomputedTable = -1;
+      expect(index.usePrecomputedTable).toBe(-1);
+      expect(index.search(x.slice(0, 4), 5).labels.every((label) => label >= 0n)).toBe(true);
+      expect(() => { index.usePrecomputedTable = 3; }).toThrow('Invalid the first argument type, must be a Number between -1 and 2.');
+    });
+  });
+
+  describe('#toBuffer', () => {
+    it('round trips', () => {
+      const index = new IndexIVFPQ(new IndexFlatL2(4), 4, 2, 2, 4);
+      index.train(x);
+      index.add(x);
+      const copy = IndexIVFPQ.fromBuffer(index.toBuffer());
+      expect(copy.ntotal).toBe(1000);
+      expect(copy.M).toBe(2);
+      expect(copy.nbits).toBe(4);
+    });
+  });
+});
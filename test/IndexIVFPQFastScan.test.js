@@ -0,0 +1,47 @@
+const { IndexFlatL2, IndexIVFPQFastScan, IndexType } = require('..');
+
+describe('IndexIVFPQFastScan', () => {
+  const x = Array.from({ length: 8 * 1000 }, () => Math.random());
+
+  describe('#constructor', () => {
+    it('4 args will result in a 4 bit index', () => {
+      const index = new IndexIVFPQFastScan(new IndexFlatL2(8), 8, 4, 4);
+      expect(index.M).toBe(4);
+      expect(index.nbits).toBe(4);
+      expect(index.bbs).toBe(32);
+      expect(index.nprobe).toBe(1);
+      expect(index.indexType).toBe(IndexType.IndexIVFPQFastScan);
+    });
+
+    it('sets the block size', () => {
+      const index = new IndexIVFPQFastScan(new IndexFlatL2(8), 8, 4, 4, 4, undefined, 64);
+      expect(index.bbs).toBe(64);
+    });
+  });
+
+  describe('#search', () => {
+    it('finds neighbors in the probed lists', () => {
+      const index = new IndexIVFPQFastScan(new IndexFlatL2(8), 8, 4, 4);
+      index.train(x);
+      index.add(x);
+      index.nprobe = 4;
+
+      const { labels } = index.search(x.slice(0, 16), 5);
+      expect(labels.length).toBe(10);
+      expect(labels.every((label) => label >= 0n)).toBe(true);
+    });
+  });
+
+  describe('#toRefineFlat', () => {
+    it('re-ranks candidates by exact distance', () => {
+      const index = new IndexIVFPQFastScan(new IndexFlatL2(8), 8, 4, 4);
+      const refined = index.toRefineFlat(50);
+      refined.train(x);
+      refined.add(x);
+      refined.nprobe = 4;
+
+      expect(refined.search(x.slice(0, 8), 1).labels).toEqual([0n]);
+      expect(index.nprobe).toBe(4);
+    });
+  });
+});
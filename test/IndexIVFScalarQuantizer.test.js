@@ -0,0 +1,41 @@
+const {
+  IndexFlatL2, IndexIVFScalarQuantizer, QuantizerType, MetricType, IndexType,
+} = require('..');
+
+describe('IndexIVFScalarQuantizer', () => {
+  const x = Array.from({ length: 4 * 400 }, () => Math.random());
+
+  describe('#constructor', () => {
+    it('3 args will result in an 8 bit residual index', () => {
+      const index = new IndexIVFScalarQuantizer(new IndexFlatL2(4), 4, 2);
+      expect(index.qtype).toBe(QuantizerType.QT_8bit);
+      expect(index.codeSize).toBe(4);
+      expect(index.byResidual).toBe(true);
+      expect(index.indexType).toBe(IndexType.IndexIVFScalarQuantizer);
+    });
+
+    it('sets the quantizer type and residual encoding', () => {
+      const index = new IndexIVFScalarQuantizer(new IndexFlatL2(4), 4, 2, QuantizerType.QT_fp16, MetricType.METRIC_L2, false);
+      expect(index.qtype).toBe(QuantizerType.QT_fp16);
+      expect(index.codeSize).toBe(8);
+      expect(index.byResidual).toBe(false);
+    });
+
+    it('packs 4 bit codes', () => {
+      const index = new IndexIVFScalarQuantizer(new IndexFlatL2(4), 4, 2, QuantizerType.QT_4bit);
+      expect(index.codeSize).toBe(2);
+    });
+  });
+
+  describe('#search', () => {
+    it('finds the query vector', () => {
+      const index = new IndexIVFScalarQuantizer(new IndexFlatL2(4), 4, 2);
+      index.train(x);
+      index.add(x);
+      index.nprobe = 2;
+
+      const { labels } = index.search(x.slice(0, 4), 1);
+      expect(labels).toEqual([0n]);
+    });
+  });
+});
@@ -0,0 +1,60 @@
+const { IndexPQFastScan, IndexType } = require('..');
+
+describe('IndexPQFastScan', () => {
+  const x = Array.from({ length: 8 * 1000 }, () => Math.random());
+
+  describe('#constructor', () => {
+    it('2 args will result in a 4 bit index', () => {
+      const index = new IndexPQFastScan(8, 4);
+      expect(index.dims).toBe(8);
+      expect(index.M).toBe(4);
+      expect(index.nbits).toBe(4);
+      expect(index.bbs).toBe(32);
+      expect(index.isTrained).toBe(false);
+      expect(index.indexType).toBe(IndexType.IndexPQFastScan);
+    });
+
+    it('throws an error if M does not divide d', () => {
+      expect(() => new IndexPQFastScan(8, 3)).toThrow();
+    });
+  });
+
+  describe('#search', () => {
+    it('finds neighbors with a chosen implementation', () => {
+      const index = new IndexPQFastScan(8, 4);
+      index.train(x);
+      index.add(x);
+
+      expect(index.search(x.slice(0, 8), 10).labels.every((label) => label >= 0n)).toBe(true);
+      index.implem = 2;
+      expect(index.implem).toBe(2);
+      expect(index.search(x.slice(0, 8), 10).labels.every((label) => label >= 0n)).toBe(true);
+    });
+  });
+
+  describe('#toRefineFlat', () => {
+    it('re-ranks candidates by exact distance', () => {
+      const index = new IndexPQFastScan(8, 4);
+      const refined = index.toRefineFlat(50);
+      refined.train(x);
+      refined.add(x);
+
+      expect(refined.ntotal).toBe(1000);
+      const { labels, distances } = refined.search(x.slice(0, 8), 1);
+      expect(labels).toEqual([0n]);
+      expect(distances).toEqual([0]);
+      expect(refined.M).toBe(4);
+    });
+
+    it('throws an error once the index has vectors', () => {
+      const index = new IndexPQFastScan(8, 4);
+      index.train(x);
+      index.add(x);
+      expect(() => index.toRefineFlat()).toThrow();
+    });
+
+    it('throws an error on an invalid kFactor', () => {
+      expect(() => new IndexPQFastScan(8, 4).toRefineFlat(0.5)).toThrow('Invalid the first argument type, must be a Number of at least 1.');
+    });
+  });
+});
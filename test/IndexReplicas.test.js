@@ -0,0 +1,92 @@
+const { IndexReplicas, IndexFlatL2, IndexType } = require('..');
+
+describe('IndexReplicas', () => {
+  const x = Array.from({ length: 4 * 100 }, () => Math.random());
+
+  describe('#constructor', () => {
+    it('starts without replicas', () => {
+      const index = new IndexReplicas(4);
+      expect(index.dims).toBe(4);
+      expect(index.nreplicas).toBe(0);
+      expect(index.indexType).toBe(IndexType.IndexReplicas);
+    });
+  });
+
+  describe('#addReplica', () => {
+    it('splits queries across replicas', async () => {
+      const index = new IndexReplicas(4);
+      for (let i = 0; i < 3; i++) {
+        const replica = new IndexFlatL2(4);
+        replica.add(x);
+        index.addReplica(replica);
+      }
+      expect(index.nreplicas).toBe(3);
+      expect(index.ntotal).toBe(100);
+
+      const { labels } = await index.searchAsync(x.slice(0, 4 * 10), 1);
+      expect(labels).toEqual(Array.from({ length: 10 }, (_, i) => BigInt(i)));
+    });
+
+    it('adds vectors to every replica', () => {
+      const a = new IndexFlatL2(4);
+      const b = new IndexFlatL2(4);
+      const index = new IndexReplicas(4, false);
+      index.addReplica(a);
+      index.addReplica(b);
+      index.add(x);
+
+      expect(a.ntotal).toBe(100);
+      expect(b.ntotal).toBe(100);
+    });
+
+    it('reads replicas from files', () => {
+      const source = new IndexFlatL2(4);
+      source.add(x);
+      const fname = '_tmp.replica.index';
+      source.write(fname);
+
+      const index = new IndexReplicas(4);
+      index.addReplica(fname);
+      index.addReplica(fname);
+      expect(index.search(x.slice(4, 8), 1).labels).toEqual([1n]);
+    });
+
+    it('throws an error if the replicas hold different vectors', () => {
+      const a = new IndexFlatL2(4);
+      a.add(x);
+      const index = new IndexReplicas(4);
+      index.addReplica(a);
+      expect(() => index.addReplica(new IndexFlatL2(4))).toThrow();
+    });
+
+    it('locks the replicas while adding to them', async () => {
+      const a = new IndexFlatL2(4);
+      const b = new IndexFlatL2(4);
+      const index = new IndexReplicas(4);
+      index.addReplica(a);
+      index.addReplica(b);
+
+      const adds = [];
+      const searches = [];
+      for (let i = 0; i < 10; i++) {
+        adds.push(index.addAsync(x.slice(4 * 10 * i, 4 * 10 * (i + 1))));
+        searches.push(a.searchAsync(x.slice(0, 4), 1), b.searchAsync(x.slice(0, 4), 1));
+      }
+      await Promise.all([...adds, ...searches]);
+      expect(a.ntotal).toBe(100);
+      expect(b.ntotal).toBe(100);
+      expect(index.search(x.slice(4, 8), 1).labels).toEqual([1n]);
+    });
+  });
+
+  describe('#dispose', () => {
+    it('throws an error on disposing a replica', () => {
+      const a = new IndexFlatL2(4);
+      const index = new IndexReplicas(4);
+      index.addReplica(a);
+      expect(() => a.dispose()).toThrow('Index is used by another index (as a shard, replica, refine source or quantizer) and cannot be disposed.');
+      index.dispose();
+      a.dispose();
+    });
+  });
+});
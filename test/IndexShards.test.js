@@ -0,0 +1,168 @@
+const { PassThrough } = require('stream');
+const {
+  IndexShards, IndexFlatL2, IndexFlatIP, IndexIVFFlat, IndexBinaryFlat, IndexType,
+} = require('..');
+
+describe('IndexShards', () => {
+  describe('#constructor', () => {
+    it('starts without shards', () => {
+      const index = new IndexShards(2);
+      expect(index.dims).toBe(2);
+      expect(index.nshards).toBe(0);
+      expect(index.ntotal).toBe(0);
+      expect(index.indexType).toBe(IndexType.IndexShards);
+    });
+  });
+
+  describe('#addShard', () => {
+    it('merges the results of the shards with successive ids', () => {
+      const a = new IndexFlatL2(2);
+      a.add([0, 0, 1, 1]);
+      const b = new IndexFlatL2(2);
+      b.add([2, 2, 3, 3]);
+
+      const index = new IndexShards(2);
+      index.addShard(a);
+      index.addShard(b);
+      expect(index.nshards).toBe(2);
+      expect(index.ntotal).toBe(4);
+
+      const { distances, labels } = index.search([2.9, 2.9], 3);
+      expect(labels).toEqual([3n, 2n, 1n]);
+      expect(distances[0]).toBeCloseTo(0.02);
+    });
+
+    it('keeps shard ids as-is without successive ids', () => {
+      const a = new IndexFlatL2(2).toIDMap2();
+      a.addWithIds([0, 0], [100n]);
+      const b = new IndexFlatL2(2).toIDMap2();
+      b.addWithIds([1, 1], [200n]);
+
+      const index = new IndexShards(2, true, false);
+      index.addShard(a);
+      index.addShard(b);
+      expect(index.search([1, 1], 2).labels).toEqual([200n, 100n]);
+    });
+
+    it('merges by the metric of the shards', () => {
+      const a = new IndexFlatIP(2);
+      a.add([1, 0]);
+      const b = new IndexFlatIP(2);
+      b.add([5, 0]);
+
+      const index = new IndexShards(2);
+      index.addShard(a);
+      index.addShard(b);
+      expect(index.search([1, 0], 1).labels).toEqual([1n]);
+    });
+
+    it('reads shards from files', async () => {
+      const quantizer = new IndexFlatL2(2);
+      const ivf = new IndexIVFFlat(quantizer, 2, 1);
+      ivf.train([0, 0, 1, 1]);
+      ivf.add([0, 0, 1, 1]);
+      const fname = '_tmp.shard.index';
+      ivf.write(fname);
+
+      const index = new IndexShards(2, false);
+      index.addShard(fname);
+      index.addShard(fname, { readOnly: true });
+      expect(index.ntotal).toBe(4);
+      expect((await index.searchAsync([1, 1], 1)).labels).toEqual([1n]);
+    });
+
+    it('ignores search options that do not apply and rejects filters', () => {
+      const a = new IndexFlatL2(2);
+      a.add([1, 0]);
+      const index = new IndexShards(2);
+      index.addShard(a);
+      expect(index.search([1, 0], 1, { nprobe: 4 }).labels).toEqual([0n]);
+      expect(() => index.search([1, 0], 1, { filter: [0] })).toThrow('The filter option is not supported by this index type.');
+    });
+
+    it('throws an error on a dimension mismatch', () => {
+      const index = new IndexShards(2);
+      expect(() => index.addShard(new IndexFlatL2(3))).toThrow();
+      expect(() => index.addShard(index)).toThrow('Invalid the first argument, must be another Index that is not disposed.');
+    });
+
+    it('throws an error on objects that are not float indexes', () => {
+      const index = new IndexShards(8);
+      const message = 'Invalid the first argument, must be another Index that is not disposed.';
+      expect(() => index.addShard({})).toThrow(message);
+      expect(() => index.addShard(new IndexBinaryFlat(8))).toThrow(message);
+      expect(index.nshards).toBe(0);
+    });
+
+    it('throws an error on a shard added twice or to an index used as a shard', () => {
+      const a = new IndexFlatL2(2);
+      const index = new IndexShards(2);
+      index.addShard(a);
+      expect(() => index.addShard(a)).toThrow('Invalid the first argument, must not be used by this index already.');
+
+      const parent = new IndexShards(2);
+      parent.addShard(index);
+      expect(() => index.addShard(new IndexFlatL2(2))).toThrow('Indexes cannot be added to an index used by another index.');
+      expect(index.nshards).toBe(1);
+    });
+
+    it('searches concurrently with adds to the shards', async () => {
+      const a = new IndexFlatL2(2);
+      const b = new IndexFlatL2(2);
+      a.add([0, 0]);
+      b.add([0, 0]);
+      const index = new IndexShards(2, false);
+      index.addShard(a);
+      index.addShard(b);
+
+      const adds = [];
+      const searches = [];
+      for (let i = 1; i <= 20; i++) {
+        adds.push(a.addAsync([i, i]), b.addAsync([-i, -i]));
+        searches.push(index.searchAsync([0, 0], 1));
+      }
+      await Promise.all(adds);
+      const results = await Promise.all(searches);
+      results.forEach((result) => expect(result.distances).toEqual([0]));
+      expect(a.ntotal + b.ntotal).toBe(42);
+    });
+  });
+
+  describe('#writeStream', () => {
+    it('rejects locking the shards on the JS thread while streaming', async () => {
+      const a = new IndexFlatL2(2);
+      a.add([1, 0]);
+      const index = new IndexShards(2);
+      index.addShard(a);
+
+      const stream = new PassThrough();
+      stream.resume();
+      const promise = index.writeStream(stream, { chunkSize: 64 }).catch(() => {});
+      expect(() => a.add([0, 1])).toThrow('Index cannot be modified while writeStream is in progress.');
+      await promise;
+      a.add([0, 1]);
+      expect(a.ntotal).toBe(2);
+    });
+  });
+
+  describe('#dispose', () => {
+    it('throws an error on disposing a shard', () => {
+      const a = new IndexFlatL2(2);
+      a.add([1, 0]);
+      const index = new IndexShards(2);
+      index.addShard(a);
+      expect(() => a.dispose()).toThrow('Index is used by another index (as a shard, replica, refine source or quantizer) and cannot be disposed.');
+      expect(index.search([1, 0], 1).labels).toEqual([0n]);
+    });
+
+    it('releases the shards when disposed', () => {
+      const a = new IndexFlatL2(2);
+      const index = new IndexShards(2);
+      index.addShard(a);
+      index.dispose();
+      a.add([1, 0]);
+      expect(a.ntotal).toBe(1);
+      a.dispose();
+    });
+  });
+});